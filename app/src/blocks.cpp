@@ -0,0 +1,22 @@
+// Project headers
+#include "blocks.hpp"
+
+//
+// @brief Register the block factories to a manager
+//
+void blocks::factory_register(struct manager &mgr)
+{
+    mgr.block_factory_register("hello", &hello_);
+    mgr.block_factory_register("trans_pb", &trans_pb_);
+    mgr.block_factory_register("hook_zmq", &hook_zmq_);
+    mgr.block_factory_register("router", &router_);
+    mgr.block_factory_register("balancer", &balancer_);
+    mgr.block_factory_register("aggregator", &aggregator_);
+    mgr.block_factory_register("deaggregator", &deaggregator_);
+    mgr.block_factory_register("shaper", &shaper_);
+    mgr.block_factory_register("codec", &codec_);
+    mgr.block_factory_register("cache", &cache_);
+    mgr.block_factory_register("cache_return", &cache_return_);
+    mgr.block_factory_register("dedup", &dedup_);
+    mgr.block_factory_register("capture", &capture_);
+}
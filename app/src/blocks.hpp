@@ -0,0 +1,43 @@
+#ifndef BLOCKS_HPP
+#define BLOCKS_HPP
+
+// Project headers
+#include "block/aggregator.hpp"
+#include "block/balancer.hpp"
+#include "block/cache.hpp"
+#include "block/capture.hpp"
+#include "block/codec.hpp"
+#include "block/dedup.hpp"
+#include "block/hello.hpp"
+#include "block/hook_zmq.hpp"
+#include "block/router.hpp"
+#include "block/shaper.hpp"
+#include "block/trans_pb.hpp"
+#include "engine/manager.hpp"
+
+//
+// @struct blocks
+//
+// @brief Factories of the blocks a graph can be made of, shared by the
+//        executables running one. They must outlive the blocks
+//
+struct blocks
+{
+    struct hello_factory hello_;
+    struct trans_pb_factory trans_pb_;
+    struct hook_zmq_factory hook_zmq_;
+    struct router_factory router_;
+    struct balancer_factory balancer_;
+    struct aggregator_factory aggregator_;
+    struct deaggregator_factory deaggregator_;
+    struct shaper_factory shaper_;
+    struct codec_factory codec_;
+    struct cache_factory cache_;
+    struct cache_return_factory cache_return_;
+    struct dedup_factory dedup_;
+    struct capture_factory capture_;
+
+    void factory_register(struct manager &mgr);
+};
+
+#endif // BLOCKS_HPP
@@ -1,37 +1,44 @@
 
 
 // Project headers
-#include "block/hello.hpp"
-#include "block/trans_pb.hpp"
-#include "block/hook_zmq.hpp"
-#include "engine/manager.hpp"
-
-// C headers
-extern "C"
-{
-#include <signal.h>
-}
+#include "blocks.hpp"
+#include "utils/sched.hpp"
 
 extern char *optarg; // Comes with getopt
 
-bool end_signal_received = false;
-
-static void signal_handler(int, siginfo_t *, void *)
-{
-    end_signal_received = true;
-}
-
 int main(int argc, char **argv)
 {
     const char *options;
     const char *identity;
+    const char *snapshot;
+    long spin_us;
+    long worker_count;
+    struct sched_conf sched;
 
-    options = "hi:";
+    options = "a:b:c:hi:mp:w:z:";
     identity = "default_identity";
+    snapshot = nullptr;
+    spin_us = 0;
+    worker_count = 0;
     for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
     {
         switch (opt)
         {
+        case 'a':
+            if (sched_cpu_parse(optarg, sched.cpu_) == false)
+            {
+                return 1;
+            }
+            break;
+
+        case 'b':
+            spin_us = atol(optarg);
+            break;
+
+        case 'c':
+            snapshot = optarg;
+            break;
+
         case 'h':
             printf("lol, help is for the weaks");
             return 1;
@@ -40,6 +47,25 @@ int main(int argc, char **argv)
             identity = optarg;
             break;
 
+        case 'm':
+            sched.mlock_ = true;
+            break;
+
+        case 'p':
+            sched.priority_ = atoi(optarg);
+            break;
+
+        case 'w':
+            worker_count = atol(optarg);
+            break;
+
+        case 'z':
+            if (sched_cpu_parse(optarg, sched.io_cpu_) == false)
+            {
+                return 1;
+            }
+            break;
+
         default:
             return 1;
         }
@@ -47,15 +73,17 @@ int main(int argc, char **argv)
 
     LOGGER_OPEN(identity);
 
+    // Pin the main loop and name it after the identity, or keep running with the default scheduling
+    if (sched.apply(identity) == false)
+    {
+        LOGGER_ERR("Failed to apply the scheduling, running unpinned [identity=%s]", identity);
+    }
+
     // Register block factories
     struct manager mgr;
-    struct hello_factory hello;
-    struct trans_pb_factory trans_pb;
-    struct hook_zmq_factory hook_zmq;
+    struct blocks factories;
 
-    mgr.block_factory_register("hello", &hello);
-    mgr.block_factory_register("trans_pb", &trans_pb);
-    mgr.block_factory_register("hook_zmq", &hook_zmq);
+    factories.factory_register(mgr);
 
     // Add the ZMQ monitoring client
     struct hook_zmq *block;
@@ -67,6 +95,8 @@ int main(int argc, char **argv)
     block->name_ = std::string(identity);
     block->addr_ = std::string("tcp://127.0.0.1:1664");
     block->client_ = true;
+    block->io_cpu_ = sched.io_cpu_;
+    block->io_priority_ = sched.priority_;
 
     mgr.block_start(-1);
 
@@ -78,23 +108,31 @@ int main(int argc, char **argv)
     mgr.block_bind(-1, 0, -2);
     mgr.block_bind(-2, 0, -1);
 
-    // Register a signal handler
-    struct sigaction sa;
-    sa.sa_flags = SA_SIGINFO;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_sigaction = signal_handler;
+    // Workers for CPU-heavy processing
+    if (worker_count > 0)
+    {
+        ASSERT(mgr.work_start(static_cast<size_t>(worker_count)) == true);
+    }
+
+    // Rebuild the graph saved by a previous instance, once the workers run for the blocks started
+    if ((snapshot != nullptr) &&
+        (static_cast<struct trans_pb *>(mgr.block_get(-2))->snapshot_load(snapshot) == false))
+    {
+        LOGGER_ERR("Failed to restore the graph: some blocks are missing [snapshot=%s]", snapshot);
+    }
 
-    int rc;
-    rc = sigaction(SIGINT, &sa, NULL);
-    ASSERT(rc != -1);
-    rc = sigaction(SIGTERM, &sa, NULL);
-    ASSERT(rc != -1);
+    // Signals are handled by the transcoder from the main loop
+    ASSERT(mgr.signal_add(SIGINT, mgr.block_get(-2)) == true);
+    ASSERT(mgr.signal_add(SIGTERM, mgr.block_get(-2)) == true);
+    ASSERT(mgr.signal_add(SIGUSR1, mgr.block_get(-2)) == true);
+    ASSERT(mgr.signal_add(SIGUSR2, mgr.block_get(-2)) == true);
 
-    LOGGER_INFO("Registered signal handler for SIGINT and SIGTERM");
+    // Busy polling on dedicated cores
+    mgr.fd_spin(spin_us);
 
     // Main loop
     mgr.start_();
-    while ((end_signal_received == false) && (mgr.is_term_ == false))
+    while (mgr.is_term_ == false)
     {
         mgr.fd_poll();
         mgr.timer_check_exp();
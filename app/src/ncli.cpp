@@ -3,6 +3,7 @@
 // C headers
 extern "C"
 {
+#include <inttypes.h>
 #include <wordexp.h>
 }
 
@@ -11,6 +12,7 @@ extern "C"
 #include "engine/manager.hpp"
 #include "utils/logger.hpp"
 #include "utils/buffer.hpp"
+#include "utils/sched.hpp"
 
 // Generated protobuf command
 #include "conf.pb-c.h"
@@ -28,18 +30,72 @@ ncli::ncli(struct manager *mgr) : block(mgr),
                                   ncli_cmd_ret_(nullptr),
                                   add_id_(0),
                                   add_type_(nullptr),
+                                  replace_id_(0),
+                                  replace_type_(nullptr),
                                   start_id_(0),
                                   stop_id_(0),
                                   del_id_(0),
                                   bind_id_(0),
                                   bind_port_(0),
                                   bind_dest_(0),
+                                  bind_queue_(0u),
                                   hook_zmq_id_(0),
                                   hook_zmq_client_(false),
                                   hook_zmq_type_(0),
                                   hook_zmq_name_(nullptr),
-                                  hook_zmq_addr_(nullptr)
+                                  hook_zmq_addr_(nullptr),
+                                  hook_zmq_io_priority_(0),
+                                  hook_zmq_deadline_us_(0),
+                                  hook_zmq_credit_(0),
+                                  sched_priority_(0),
+                                  sched_mlock_(false),
+                                  router_id_(0),
+                                  router_default_port_(-1),
+                                  router_topic_part_(0u),
+                                  balancer_id_(0),
+                                  balancer_policy_(CONF_BALANCER__POLICY__ROUND_ROBIN),
+                                  balancer_hash_part_(0u),
+                                  aggregator_id_(0),
+                                  aggregator_max_bytes_(64u * 1024u),
+                                  aggregator_max_count_(256u),
+                                  aggregator_latency_us_(1000),
+                                  shaper_id_(0),
+                                  shaper_policy_(CONF_SHAPER__POLICY__DROP),
+                                  shaper_key_part_(0u),
+                                  shaper_rate_(1000u),
+                                  shaper_burst_(100u),
+                                  shaper_queue_max_(1024u),
+                                  shaper_tick_us_(1000),
+                                  codec_id_(0),
+                                  codec_mode_(CONF_CODEC__MODE__COMPRESS),
+                                  codec_level_(1),
+                                  codec_min_size_(128u),
+                                  codec_part_mask_(0xfffffffeu),
+                                  codec_dict_path_(const_cast<char *>("")),
+                                  cache_id_(0),
+                                  cache_key_mask_(0x1u),
+                                  cache_ttl_ms_(1000),
+                                  cache_max_bytes_(64u * 1024u * 1024u),
+                                  dedup_id_(0),
+                                  dedup_part_mask_(0xffffffffu),
+                                  dedup_window_ms_(1000),
+                                  dedup_fp_rate_(0.001),
+                                  dedup_max_bytes_(1u << 20),
+                                  capture_id_(0),
+                                  capture_path_(const_cast<char *>("/tmp/c3qo.cap")),
+                                  capture_file_size_(64u << 20),
+                                  get_id_(0),
+                                  snapshot_path_(nullptr),
+                                  received_answer_(false),
+                                  timeout_expired_(false),
+                                  session_file_(nullptr),
+                                  session_window_(64u),
+                                  session_seq_(0u),
+                                  session_line_(0u),
+                                  session_ok_(0u),
+                                  session_ko_(0u)
 {
+    memset(&wordexp_, 0, sizeof(wordexp_));
 }
 ncli::~ncli() {}
 
@@ -76,6 +132,39 @@ bool ncli::parse_add(int argc, char **argv)
     return true;
 }
 
+bool ncli::parse_replace(int argc, char **argv)
+{
+    const char *options = "i:t:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set block identifier [value=%s]", optarg);
+            replace_id_ = atoi(optarg);
+            break;
+
+        case 't':
+            LOGGER_DEBUG("Set block type [value=%s]", optarg);
+            replace_type_ = optarg;
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_REPLACE;
+    block_replace__init(&bk_replace_);
+    cmd_.replace = &bk_replace_;
+    cmd_.replace->id = replace_id_;
+    cmd_.replace->type = replace_type_;
+
+    return true;
+}
+
 bool ncli::parse_start(int argc, char **argv)
 {
     const char *options = "i:";
@@ -149,34 +238,639 @@ bool ncli::parse_del(int argc, char **argv)
     }
 
     command__init(&cmd_);
-    cmd_.type_case = COMMAND__TYPE_DEL;
-    block_del__init(&bk_del_);
-    cmd_.del = &bk_del_;
-    cmd_.del->id = del_id_;
+    cmd_.type_case = COMMAND__TYPE_DEL;
+    block_del__init(&bk_del_);
+    cmd_.del = &bk_del_;
+    cmd_.del->id = del_id_;
+
+    return true;
+}
+
+bool ncli::parse_bind(int argc, char **argv)
+{
+    const char *options = "i:p:d:q:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set bind source [value=%s]", optarg);
+            bind_id_ = atoi(optarg);
+            break;
+
+        case 'p':
+            LOGGER_DEBUG("Set bind port [value=%s]", optarg);
+            bind_port_ = atoi(optarg);
+            break;
+
+        case 'd':
+            LOGGER_DEBUG("Set bind destination [value=%s]", optarg);
+            bind_dest_ = atoi(optarg);
+            break;
+
+        case 'q':
+            LOGGER_DEBUG("Set bind queue [value=%s]", optarg);
+            bind_queue_ = strtoull(optarg, nullptr, 10);
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_BIND;
+    block_bind__init(&bk_bind_);
+    cmd_.bind = &bk_bind_;
+    cmd_.bind->id = bind_id_;
+    cmd_.bind->port = bind_port_;
+    cmd_.bind->dest = bind_dest_;
+    cmd_.bind->queue = bind_queue_;
+
+    return true;
+}
+
+bool ncli::parse_hook_zmq(int argc, char **argv)
+{
+    const char *options = "i:ct:n:a:z:p:d:k:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set hook identifier [value=%s]", optarg);
+            hook_zmq_id_ = atoi(optarg);
+            break;
+
+        case 'c':
+            LOGGER_DEBUG("Set hook client");
+            hook_zmq_client_ = true;
+            break;
+
+        case 't':
+            LOGGER_DEBUG("Set hook type [value=%s]", optarg);
+            hook_zmq_type_ = atoi(optarg);
+            break;
+
+        case 'n':
+            LOGGER_DEBUG("Set hook name [value=%s]", optarg);
+            hook_zmq_name_ = optarg;
+            break;
+
+        case 'a':
+            LOGGER_DEBUG("Set hook address [value=%s]", optarg);
+            hook_zmq_addr_ = optarg;
+            break;
+
+        case 'z':
+        {
+            std::vector<int> cpu;
+
+            LOGGER_DEBUG("Set hook I/O thread CPUs [value=%s]", optarg);
+            if (sched_cpu_parse(optarg, cpu) == false)
+            {
+                return false;
+            }
+            hook_zmq_io_cpu_.assign(cpu.cbegin(), cpu.cend());
+        }
+        break;
+
+        case 'p':
+            LOGGER_DEBUG("Set hook I/O thread priority [value=%s]", optarg);
+            hook_zmq_io_priority_ = atoi(optarg);
+            break;
+
+        case 'd':
+            LOGGER_DEBUG("Set hook deadline [value=%s]", optarg);
+            hook_zmq_deadline_us_ = strtoll(optarg, nullptr, 10);
+            break;
+
+        case 'k':
+            LOGGER_DEBUG("Set hook credits [value=%s]", optarg);
+            hook_zmq_credit_ = strtoll(optarg, nullptr, 10);
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_HOOK_ZMQ;
+    conf_hook_zmq__init(&conf_hook_zmq_);
+    cmd_.hook_zmq = &conf_hook_zmq_;
+    cmd_.hook_zmq->id = hook_zmq_id_;
+    cmd_.hook_zmq->client = hook_zmq_client_;
+    cmd_.hook_zmq->type = hook_zmq_type_;
+    cmd_.hook_zmq->name = hook_zmq_name_;
+    cmd_.hook_zmq->addr = hook_zmq_addr_;
+    cmd_.hook_zmq->n_io_cpu = hook_zmq_io_cpu_.size();
+    cmd_.hook_zmq->io_cpu = hook_zmq_io_cpu_.data();
+    cmd_.hook_zmq->io_priority = hook_zmq_io_priority_;
+    cmd_.hook_zmq->deadline_us = hook_zmq_deadline_us_;
+    cmd_.hook_zmq->credit = hook_zmq_credit_;
+
+    return true;
+}
+
+bool ncli::parse_sched(int argc, char **argv)
+{
+    const char *options = "a:p:m";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'a':
+        {
+            std::vector<int> cpu;
+
+            LOGGER_DEBUG("Set main loop CPUs [value=%s]", optarg);
+            if (sched_cpu_parse(optarg, cpu) == false)
+            {
+                return false;
+            }
+            sched_cpu_.assign(cpu.cbegin(), cpu.cend());
+        }
+        break;
+
+        case 'p':
+            LOGGER_DEBUG("Set main loop priority [value=%s]", optarg);
+            sched_priority_ = atoi(optarg);
+            break;
+
+        case 'm':
+            LOGGER_DEBUG("Set memory lock");
+            sched_mlock_ = true;
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_SCHED;
+    conf_sched__init(&conf_sched_);
+    cmd_.sched = &conf_sched_;
+    cmd_.sched->n_cpu = sched_cpu_.size();
+    cmd_.sched->cpu = sched_cpu_.data();
+    cmd_.sched->priority = sched_priority_;
+    cmd_.sched->mlock = sched_mlock_;
+
+    return true;
+}
+
+//
+// @brief Parse a routing rule "topic:port", the topic may contain ':'
+//
+static bool ncli_router_rule(char *arg, bool prefix, RouterRule &rule)
+{
+    char *sep;
+
+    sep = strrchr(arg, ':');
+    if (sep == nullptr)
+    {
+        LOGGER_ERR("Failed to parse option: wrong routing rule [value=%s]", arg);
+        return false;
+    }
+
+    router_rule__init(&rule);
+    rule.topic.data = reinterpret_cast<uint8_t *>(arg);
+    rule.topic.len = static_cast<size_t>(sep - arg);
+    rule.prefix = prefix;
+    rule.port = atoi(sep + 1);
+
+    return true;
+}
+
+bool ncli::parse_router(int argc, char **argv)
+{
+    const char *options = "i:e:p:d:f:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set router block [value=%s]", optarg);
+            router_id_ = atoi(optarg);
+            break;
+
+        case 'e':
+        case 'p':
+        {
+            RouterRule rule;
+
+            LOGGER_DEBUG("Add routing rule [value=%s ; prefix=%s]", optarg, (opt == 'p') ? "true" : "false");
+            if (ncli_router_rule(optarg, opt == 'p', rule) == false)
+            {
+                return false;
+            }
+            router_rule_.push_back(rule);
+        }
+        break;
+
+        case 'd':
+            LOGGER_DEBUG("Set router default port [value=%s]", optarg);
+            router_default_port_ = atoi(optarg);
+            break;
+
+        case 'f':
+            LOGGER_DEBUG("Set router topic part [value=%s]", optarg);
+            router_topic_part_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    // Rules are stored first: their addresses are stable once parsing is done
+    for (auto &rule : router_rule_)
+    {
+        router_rule_ptr_.push_back(&rule);
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_ROUTER;
+    conf_router__init(&conf_router_);
+    cmd_.router = &conf_router_;
+    cmd_.router->id = router_id_;
+    cmd_.router->n_rule = router_rule_ptr_.size();
+    cmd_.router->rule = router_rule_ptr_.data();
+    cmd_.router->default_port = router_default_port_;
+    cmd_.router->topic_part = router_topic_part_;
+
+    return true;
+}
+
+bool ncli::parse_balancer(int argc, char **argv)
+{
+    const char *options = "i:p:f:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set balancer block [value=%s]", optarg);
+            balancer_id_ = atoi(optarg);
+            break;
+
+        case 'p':
+            LOGGER_DEBUG("Set balancer policy [value=%s]", optarg);
+            if (strcmp(optarg, "round_robin") == 0)
+            {
+                balancer_policy_ = CONF_BALANCER__POLICY__ROUND_ROBIN;
+            }
+            else if (strcmp(optarg, "hash") == 0)
+            {
+                balancer_policy_ = CONF_BALANCER__POLICY__HASH;
+            }
+            else if (strcmp(optarg, "least_outstanding") == 0)
+            {
+                balancer_policy_ = CONF_BALANCER__POLICY__LEAST_OUTSTANDING;
+            }
+            else
+            {
+                LOGGER_ERR("Failed to parse option: unknown balancer policy [value=%s]", optarg);
+                return false;
+            }
+            break;
+
+        case 'f':
+            LOGGER_DEBUG("Set balancer hashed part [value=%s]", optarg);
+            balancer_hash_part_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_BALANCER;
+    conf_balancer__init(&conf_balancer_);
+    cmd_.balancer = &conf_balancer_;
+    cmd_.balancer->id = balancer_id_;
+    cmd_.balancer->policy = balancer_policy_;
+    cmd_.balancer->hash_part = balancer_hash_part_;
+
+    return true;
+}
+
+bool ncli::parse_aggregator(int argc, char **argv)
+{
+    const char *options = "i:b:n:l:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set aggregator block [value=%s]", optarg);
+            aggregator_id_ = atoi(optarg);
+            break;
+
+        case 'b':
+            LOGGER_DEBUG("Set aggregator batch size [value=%s]", optarg);
+            aggregator_max_bytes_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        case 'n':
+            LOGGER_DEBUG("Set aggregator batch count [value=%s]", optarg);
+            aggregator_max_count_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        case 'l':
+            LOGGER_DEBUG("Set aggregator latency [value=%s]", optarg);
+            aggregator_latency_us_ = strtoll(optarg, nullptr, 10);
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_AGGREGATOR;
+    conf_aggregator__init(&conf_aggregator_);
+    cmd_.aggregator = &conf_aggregator_;
+    cmd_.aggregator->id = aggregator_id_;
+    cmd_.aggregator->max_bytes = aggregator_max_bytes_;
+    cmd_.aggregator->max_count = aggregator_max_count_;
+    cmd_.aggregator->latency_us = aggregator_latency_us_;
+
+    return true;
+}
+
+bool ncli::parse_shaper(int argc, char **argv)
+{
+    const char *options = "i:p:k:r:b:q:t:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set shaper block [value=%s]", optarg);
+            shaper_id_ = atoi(optarg);
+            break;
+
+        case 'p':
+            LOGGER_DEBUG("Set shaper policy [value=%s]", optarg);
+            if (strcmp(optarg, "drop") == 0)
+            {
+                shaper_policy_ = CONF_SHAPER__POLICY__DROP;
+            }
+            else if (strcmp(optarg, "queue") == 0)
+            {
+                shaper_policy_ = CONF_SHAPER__POLICY__QUEUE;
+            }
+            else if (strcmp(optarg, "mark") == 0)
+            {
+                shaper_policy_ = CONF_SHAPER__POLICY__MARK;
+            }
+            else
+            {
+                LOGGER_ERR("Failed to parse option: unknown shaper policy [value=%s]", optarg);
+                return false;
+            }
+            break;
+
+        case 'k':
+            LOGGER_DEBUG("Set shaper key part [value=%s]", optarg);
+            shaper_key_part_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        case 'r':
+            LOGGER_DEBUG("Set shaper rate [value=%s]", optarg);
+            shaper_rate_ = strtoull(optarg, nullptr, 10);
+            break;
+
+        case 'b':
+            LOGGER_DEBUG("Set shaper burst [value=%s]", optarg);
+            shaper_burst_ = strtoull(optarg, nullptr, 10);
+            break;
+
+        case 'q':
+            LOGGER_DEBUG("Set shaper queue size [value=%s]", optarg);
+            shaper_queue_max_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        case 't':
+            LOGGER_DEBUG("Set shaper tick [value=%s]", optarg);
+            shaper_tick_us_ = strtoll(optarg, nullptr, 10);
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_SHAPER;
+    conf_shaper__init(&conf_shaper_);
+    cmd_.shaper = &conf_shaper_;
+    cmd_.shaper->id = shaper_id_;
+    cmd_.shaper->policy = shaper_policy_;
+    cmd_.shaper->key_part = shaper_key_part_;
+    cmd_.shaper->rate = shaper_rate_;
+    cmd_.shaper->burst = shaper_burst_;
+    cmd_.shaper->queue_max = shaper_queue_max_;
+    cmd_.shaper->tick_us = shaper_tick_us_;
+
+    return true;
+}
+
+bool ncli::parse_codec(int argc, char **argv)
+{
+    const char *options = "i:m:l:s:k:d:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set codec block [value=%s]", optarg);
+            codec_id_ = atoi(optarg);
+            break;
+
+        case 'm':
+            LOGGER_DEBUG("Set codec mode [value=%s]", optarg);
+            if (strcmp(optarg, "compress") == 0)
+            {
+                codec_mode_ = CONF_CODEC__MODE__COMPRESS;
+            }
+            else if (strcmp(optarg, "decompress") == 0)
+            {
+                codec_mode_ = CONF_CODEC__MODE__DECOMPRESS;
+            }
+            else
+            {
+                LOGGER_ERR("Failed to parse option: unknown codec mode [value=%s]", optarg);
+                return false;
+            }
+            break;
+
+        case 'l':
+            LOGGER_DEBUG("Set codec level [value=%s]", optarg);
+            codec_level_ = atoi(optarg);
+            break;
+
+        case 's':
+            LOGGER_DEBUG("Set codec minimum size [value=%s]", optarg);
+            codec_min_size_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+            break;
+
+        case 'k':
+            LOGGER_DEBUG("Set codec part mask [value=%s]", optarg);
+            codec_part_mask_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 0));
+            break;
+
+        case 'd':
+            LOGGER_DEBUG("Set codec dictionary [value=%s]", optarg);
+            codec_dict_path_ = optarg;
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_CODEC;
+    conf_codec__init(&conf_codec_);
+    cmd_.codec = &conf_codec_;
+    cmd_.codec->id = codec_id_;
+    cmd_.codec->mode = codec_mode_;
+    cmd_.codec->level = codec_level_;
+    cmd_.codec->min_size = codec_min_size_;
+    cmd_.codec->part_mask = codec_part_mask_;
+    cmd_.codec->dict_path = codec_dict_path_;
+
+    return true;
+}
+
+bool ncli::parse_cache(int argc, char **argv)
+{
+    const char *options = "i:k:t:m:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set cache block [value=%s]", optarg);
+            cache_id_ = atoi(optarg);
+            break;
+
+        case 'k':
+            LOGGER_DEBUG("Set cache key mask [value=%s]", optarg);
+            cache_key_mask_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 0));
+            break;
+
+        case 't':
+            LOGGER_DEBUG("Set cache lifetime [value=%s]", optarg);
+            cache_ttl_ms_ = strtoll(optarg, nullptr, 10);
+            break;
+
+        case 'm':
+            LOGGER_DEBUG("Set cache memory budget [value=%s]", optarg);
+            cache_max_bytes_ = strtoull(optarg, nullptr, 10);
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_CACHE;
+    conf_cache__init(&conf_cache_);
+    cmd_.cache = &conf_cache_;
+    cmd_.cache->id = cache_id_;
+    cmd_.cache->key_mask = cache_key_mask_;
+    cmd_.cache->ttl_ms = cache_ttl_ms_;
+    cmd_.cache->max_bytes = cache_max_bytes_;
+
+    return true;
+}
+
+bool ncli::parse_dedup(int argc, char **argv)
+{
+    const char *options = "i:k:w:f:m:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'i':
+            LOGGER_DEBUG("Set dedup block [value=%s]", optarg);
+            dedup_id_ = atoi(optarg);
+            break;
+
+        case 'k':
+            LOGGER_DEBUG("Set dedup part mask [value=%s]", optarg);
+            dedup_part_mask_ = static_cast<uint32_t>(strtoul(optarg, nullptr, 0));
+            break;
+
+        case 'w':
+            LOGGER_DEBUG("Set dedup window [value=%s]", optarg);
+            dedup_window_ms_ = strtoll(optarg, nullptr, 10);
+            break;
+
+        case 'f':
+            LOGGER_DEBUG("Set dedup false positive rate [value=%s]", optarg);
+            dedup_fp_rate_ = strtod(optarg, nullptr);
+            break;
+
+        case 'm':
+            LOGGER_DEBUG("Set dedup memory [value=%s]", optarg);
+            dedup_max_bytes_ = strtoull(optarg, nullptr, 10);
+            break;
+
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
+
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_DEDUP;
+    conf_dedup__init(&conf_dedup_);
+    cmd_.dedup = &conf_dedup_;
+    cmd_.dedup->id = dedup_id_;
+    cmd_.dedup->part_mask = dedup_part_mask_;
+    cmd_.dedup->window_ms = dedup_window_ms_;
+    cmd_.dedup->fp_rate = dedup_fp_rate_;
+    cmd_.dedup->max_bytes = dedup_max_bytes_;
 
     return true;
 }
 
-bool ncli::parse_bind(int argc, char **argv)
+bool ncli::parse_capture(int argc, char **argv)
 {
-    const char *options = "i:p:d:";
+    const char *options = "i:p:s:";
     for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
     {
         switch (opt)
         {
         case 'i':
-            LOGGER_DEBUG("Set bind source [value=%s]", optarg);
-            bind_id_ = atoi(optarg);
+            LOGGER_DEBUG("Set capture block [value=%s]", optarg);
+            capture_id_ = atoi(optarg);
             break;
 
         case 'p':
-            LOGGER_DEBUG("Set bind port [value=%s]", optarg);
-            bind_port_ = atoi(optarg);
+            LOGGER_DEBUG("Set capture path [value=%s]", optarg);
+            capture_path_ = optarg;
             break;
 
-        case 'd':
-            LOGGER_DEBUG("Set bind destination [value=%s]", optarg);
-            bind_dest_ = atoi(optarg);
+        case 's':
+            LOGGER_DEBUG("Set capture file size [value=%s]", optarg);
+            capture_file_size_ = strtoull(optarg, nullptr, 10);
             break;
 
         default:
@@ -186,46 +880,71 @@ bool ncli::parse_bind(int argc, char **argv)
     }
 
     command__init(&cmd_);
-    cmd_.type_case = COMMAND__TYPE_BIND;
-    block_bind__init(&bk_bind_);
-    cmd_.bind = &bk_bind_;
-    cmd_.bind->id = bind_id_;
-    cmd_.bind->port = bind_port_;
-    cmd_.bind->dest = bind_dest_;
+    cmd_.type_case = COMMAND__TYPE_CAPTURE;
+    conf_capture__init(&conf_capture_);
+    cmd_.capture = &conf_capture_;
+    cmd_.capture->id = capture_id_;
+    cmd_.capture->path = capture_path_;
+    cmd_.capture->file_size = capture_file_size_;
 
     return true;
 }
 
-bool ncli::parse_hook_zmq(int argc, char **argv)
+bool ncli::parse_list(int, char **)
+{
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_LIST_BLOCKS;
+    cmd_.list_blocks = true;
+
+    return true;
+}
+
+bool ncli::parse_get(int argc, char **argv)
 {
-    const char *options = "i:ct:n:a:";
+    const char *options = "i:";
     for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
     {
         switch (opt)
         {
         case 'i':
-            LOGGER_DEBUG("Set hook identifier [value=%s]", optarg);
-            hook_zmq_id_ = atoi(optarg);
+            LOGGER_DEBUG("Set queried block [value=%s]", optarg);
+            get_id_ = atoi(optarg);
             break;
 
-        case 'c':
-            LOGGER_DEBUG("Set hook client");
-            hook_zmq_client_ = true;
-            break;
+        default:
+            LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
+            return false;
+        }
+    }
 
-        case 't':
-            LOGGER_DEBUG("Set hook type [value=%s]", optarg);
-            hook_zmq_type_ = atoi(optarg);
-            break;
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_GET_BLOCK;
+    block_get__init(&bk_get_);
+    cmd_.get_block = &bk_get_;
+    cmd_.get_block->id = get_id_;
 
-        case 'n':
-            LOGGER_DEBUG("Set hook name [value=%s]", optarg);
-            hook_zmq_name_ = optarg;
-            break;
+    return true;
+}
 
-        case 'a':
-            LOGGER_DEBUG("Set hook address [value=%s]", optarg);
-            hook_zmq_addr_ = optarg;
+bool ncli::parse_graph(int, char **)
+{
+    command__init(&cmd_);
+    cmd_.type_case = COMMAND__TYPE_GET_GRAPH;
+    cmd_.get_graph = true;
+
+    return true;
+}
+
+bool ncli::parse_snapshot(int argc, char **argv)
+{
+    const char *options = "p:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'p':
+            LOGGER_DEBUG("Set snapshot path [value=%s]", optarg);
+            snapshot_path_ = optarg;
             break;
 
         default:
@@ -233,16 +952,17 @@ bool ncli::parse_hook_zmq(int argc, char **argv)
             return false;
         }
     }
+    if (snapshot_path_ == nullptr)
+    {
+        LOGGER_ERR("Failed to parse option: snapshot path is required");
+        return false;
+    }
 
     command__init(&cmd_);
-    cmd_.type_case = COMMAND__TYPE_HOOK_ZMQ;
-    conf_hook_zmq__init(&conf_hook_zmq_);
-    cmd_.hook_zmq = &conf_hook_zmq_;
-    cmd_.hook_zmq->id = hook_zmq_id_;
-    cmd_.hook_zmq->client = hook_zmq_client_;
-    cmd_.hook_zmq->type = hook_zmq_type_;
-    cmd_.hook_zmq->name = hook_zmq_name_;
-    cmd_.hook_zmq->addr = hook_zmq_addr_;
+    cmd_.type_case = COMMAND__TYPE_SNAPSHOT_SAVE;
+    snapshot_save__init(&snapshot_save_);
+    cmd_.snapshot_save = &snapshot_save_;
+    cmd_.snapshot_save->path = snapshot_path_;
 
     return true;
 }
@@ -258,7 +978,7 @@ bool ncli::parse_term(int, char **)
 
 bool ncli::options_parse(int argc, char **argv)
 {
-    const char *options = "i:o:t:r:";
+    const char *options = "i:o:t:r:s:w:";
     for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
     {
         switch (opt)
@@ -283,51 +1003,203 @@ bool ncli::options_parse(int argc, char **argv)
             ncli_cmd_ret_ = optarg;
             break;
 
+        case 's':
+            LOGGER_DEBUG("Set session input [value=%s]", optarg);
+            session_file_ = optarg;
+            break;
+
+        case 'w':
+            LOGGER_DEBUG("Set session window [value=%s]", optarg);
+            session_window_ = strtoul(optarg, nullptr, 10);
+            break;
+
         default:
             LOGGER_ERR("Failed to parse option: unknown option [opt=%c]", static_cast<char>(opt));
             return false;
         }
     }
     ASSERT(ncli_peer_ != nullptr);
+
+    // Commands of a session are read later
+    if (session_file_ != nullptr)
+    {
+        ASSERT(session_window_ != 0u);
+        return true;
+    }
+
     ASSERT(ncli_cmd_type_ != nullptr);
     ASSERT(ncli_cmd_args_ != nullptr);
     ASSERT(ncli_cmd_ret_ != nullptr);
 
-    ASSERT(wordexp(ncli_cmd_args_, &wordexp_, 0) == 0);
+    return command_parse(ncli_cmd_type_, ncli_cmd_args_);
+}
+
+//
+// @brief Prepare the protobuf command from its type and its options
+//
+bool ncli::command_parse(const char *type, const char *args)
+{
+    // Forget the options of a previous command
+    add_id_ = 0;
+    add_type_ = nullptr;
+    replace_id_ = 0;
+    replace_type_ = nullptr;
+    start_id_ = 0;
+    stop_id_ = 0;
+    del_id_ = 0;
+    bind_id_ = 0;
+    bind_port_ = 0;
+    bind_dest_ = 0;
+    bind_queue_ = 0u;
+    hook_zmq_id_ = 0;
+    hook_zmq_client_ = false;
+    hook_zmq_type_ = 0;
+    hook_zmq_name_ = nullptr;
+    hook_zmq_addr_ = nullptr;
+    hook_zmq_io_cpu_.clear();
+    hook_zmq_io_priority_ = 0;
+    hook_zmq_deadline_us_ = 0;
+    hook_zmq_credit_ = 0;
+    sched_cpu_.clear();
+    sched_priority_ = 0;
+    sched_mlock_ = false;
+    router_id_ = 0;
+    router_rule_.clear();
+    router_rule_ptr_.clear();
+    router_default_port_ = -1;
+    router_topic_part_ = 0u;
+    balancer_id_ = 0;
+    balancer_policy_ = CONF_BALANCER__POLICY__ROUND_ROBIN;
+    balancer_hash_part_ = 0u;
+    aggregator_id_ = 0;
+    aggregator_max_bytes_ = 64u * 1024u; // Defaults of the block
+    aggregator_max_count_ = 256u;
+    aggregator_latency_us_ = 1000;
+    shaper_id_ = 0;
+    shaper_policy_ = CONF_SHAPER__POLICY__DROP;
+    shaper_key_part_ = 0u;
+    shaper_rate_ = 1000u; // Defaults of the block
+    shaper_burst_ = 100u;
+    shaper_queue_max_ = 1024u;
+    shaper_tick_us_ = 1000;
+    codec_id_ = 0;
+    codec_mode_ = CONF_CODEC__MODE__COMPRESS;
+    codec_level_ = 1;
+    codec_min_size_ = 128u;
+    codec_part_mask_ = 0xfffffffeu;
+    codec_dict_path_ = const_cast<char *>("");
+    cache_id_ = 0;
+    cache_key_mask_ = 0x1u;
+    cache_ttl_ms_ = 1000;
+    cache_max_bytes_ = 64u * 1024u * 1024u;
+    dedup_id_ = 0;
+    dedup_part_mask_ = 0xffffffffu;
+    dedup_window_ms_ = 1000;
+    dedup_fp_rate_ = 0.001;
+    dedup_max_bytes_ = 1u << 20;
+    capture_id_ = 0;
+    capture_path_ = const_cast<char *>("/tmp/c3qo.cap");
+    capture_file_size_ = 64u << 20;
+    get_id_ = 0;
+    snapshot_path_ = nullptr;
+
+    options_clear();
+    if (wordexp(args, &wordexp_, 0) != 0)
+    {
+        LOGGER_ERR("Failed to parse option: wrong command options [args=%s]", args);
+        memset(&wordexp_, 0, sizeof(wordexp_));
+        return false;
+    }
     optind = 1; // reset getopt
 
     bool ret;
-    if (strcmp(ncli_cmd_type_, "add") == 0)
+    if (strcmp(type, "add") == 0)
     {
         ret = parse_add(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
     }
-    else if (strcmp(ncli_cmd_type_, "start") == 0)
+    else if (strcmp(type, "replace") == 0)
+    {
+        ret = parse_replace(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "start") == 0)
     {
         ret = parse_start(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
     }
-    else if (strcmp(ncli_cmd_type_, "stop") == 0)
+    else if (strcmp(type, "stop") == 0)
     {
         ret = parse_stop(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
     }
-    else if (strcmp(ncli_cmd_type_, "del") == 0)
+    else if (strcmp(type, "del") == 0)
     {
         ret = parse_del(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
     }
-    else if (strcmp(ncli_cmd_type_, "bind") == 0)
+    else if (strcmp(type, "bind") == 0)
     {
         ret = parse_bind(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
     }
-    else if (strcmp(ncli_cmd_type_, "hook_zmq") == 0)
+    else if (strcmp(type, "hook_zmq") == 0)
     {
         ret = parse_hook_zmq(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
     }
-    else if (strcmp(ncli_cmd_type_, "term") == 0)
+    else if (strcmp(type, "sched") == 0)
+    {
+        ret = parse_sched(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "router") == 0)
+    {
+        ret = parse_router(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "balancer") == 0)
+    {
+        ret = parse_balancer(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "aggregator") == 0)
+    {
+        ret = parse_aggregator(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "shaper") == 0)
+    {
+        ret = parse_shaper(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "codec") == 0)
+    {
+        ret = parse_codec(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "cache") == 0)
+    {
+        ret = parse_cache(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "dedup") == 0)
+    {
+        ret = parse_dedup(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "capture") == 0)
+    {
+        ret = parse_capture(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "list") == 0)
+    {
+        ret = parse_list(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "get") == 0)
+    {
+        ret = parse_get(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "graph") == 0)
+    {
+        ret = parse_graph(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "snapshot") == 0)
+    {
+        ret = parse_snapshot(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
+    }
+    else if (strcmp(type, "term") == 0)
     {
         ret = parse_term(static_cast<int>(wordexp_.we_wordc), wordexp_.we_wordv);
     }
     else
     {
-        LOGGER_ERR("Failed to parse option: unknown command type [type=%s]", ncli_cmd_type_);
+        LOGGER_ERR("Failed to parse option: unknown command type [type=%s]", type);
         ret = false;
     }
 
@@ -336,16 +1208,24 @@ bool ncli::options_parse(int argc, char **argv)
 
 void ncli::options_clear()
 {
-    wordfree(&wordexp_);
+    if (wordexp_.we_wordv != nullptr)
+    {
+        wordfree(&wordexp_);
+        memset(&wordexp_, 0, sizeof(wordexp_));
+    }
 }
 
-void ncli::start_()
+//
+// @brief Send the prepared command to the peer
+//
+// @param id : Identifier echoed by the peer in the reply
+//
+void ncli::command_send(uint64_t id)
 {
-    //
-    // Prepare and send the network command
-    //
     struct buffer buf;
 
+    cmd_.id = id;
+
     buf.push_back(ncli_peer_, strlen(ncli_peer_) + 1);
 
     size_t size = command__get_packed_size(&cmd_);
@@ -361,10 +1241,14 @@ void ncli::start_()
     process_data_(&buf);
 
     buf.clear();
+    delete[] proto;
+}
 
-    //
-    // Set a timeout upon answer reception
-    //
+//
+// @brief Set a timeout upon answer reception, or postpone it
+//
+void ncli::timeout_arm()
+{
     struct timer tm;
     tm.arg = nullptr;
     tm.bk = this;
@@ -374,6 +1258,281 @@ void ncli::start_()
     mgr_->timer_add(tm);
 }
 
+void ncli::start_()
+{
+    // Commands of a session are sent as they are read
+    if (session_file_ != nullptr)
+    {
+        return;
+    }
+
+    command_send(1u);
+    timeout_arm();
+}
+
+//
+// @brief Read a command of the session and send it
+//
+// A line is: <type> <expected return> [options], empty lines and
+// lines starting with '#' are skipped
+//
+// @return false at the end of the input
+//
+bool ncli::session_read(FILE *input)
+{
+    char line[1024];
+    char type[64];
+    char expected[64];
+    int offset;
+
+    while (fgets(line, sizeof(line), input) != nullptr)
+    {
+        struct ncli_request req;
+        std::string args;
+
+        ++session_line_;
+        line[strcspn(line, "\r\n")] = '\0';
+
+        offset = 0;
+        if ((line[strspn(line, " \t")] == '\0') || (line[strspn(line, " \t")] == '#'))
+        {
+            continue;
+        }
+        if (sscanf(line, "%63s %63s %n", type, expected, &offset) != 2)
+        {
+            printf("line=%lu ; status=invalid ; error=expected <type> <return> [options]\n", session_line_);
+            ++session_ko_;
+            continue;
+        }
+
+        // Options are parsed as a command line: they need a program name
+        args = std::string("ncli ") + std::string(line + offset);
+        if (command_parse(type, args.c_str()) == false)
+        {
+            printf("line=%lu ; status=invalid ; error=wrong command\n", session_line_);
+            ++session_ko_;
+            options_clear();
+            continue;
+        }
+        req.id = ++session_seq_;
+        req.line = session_line_;
+        req.expected = std::string(expected);
+
+        command_send(req.id);
+        options_clear();
+
+        session_pending_[req.id] = req;
+
+        return true;
+    }
+
+    return false;
+}
+
+//
+// @brief Print the blocks and the bindings answered to a query
+//
+static void ncli_payload_print(const uint8_t *data, size_t size)
+{
+    BlockList *list;
+
+    if (size == 0u)
+    {
+        return;
+    }
+
+    list = block_list__unpack(nullptr, size, data);
+    if (list == nullptr)
+    {
+        LOGGER_ERR("Failed to unpack protobuf block list: unknown reason [size=%zu]", size);
+        return;
+    }
+
+    for (size_t i = 0u; i < list->n_block; ++i)
+    {
+        const BlockInfo *info = list->block[i];
+
+        printf("block id=%d ; type=%s ; started=%s ; sink=%d ; data_rx=%" PRIu64 " ; data_tx=%" PRIu64 " ; ctrl_rx=%" PRIu64
+               " ; data_expired=%" PRIu64 " ; credit=%" PRId64 "/%" PRId64 " ; credit_out=%" PRIu64 " ; flow_paused=%" PRIu64 "\n",
+               info->id, info->type, info->started ? "true" : "false", info->sink,
+               info->data_rx, info->data_tx, info->ctrl_rx, info->data_expired,
+               info->credit, info->credit_max, info->credit_out, info->flow_paused);
+
+        if (info->shaper != nullptr)
+        {
+            const ShaperInfo *sh = info->shaper;
+
+            printf("shaper id=%d ; policy=%d ; key_part=%u ; rate=%" PRIu64 " ; burst=%" PRIu64 " ; queue_max=%u ; tick_us=%" PRId64
+                   " ; pass=%" PRIu64 " ; delay=%" PRIu64 " ; marked=%" PRIu64 " ; drop=%" PRIu64 " ; keys=%" PRIu64 " ; queued=%" PRIu64 "\n",
+                   info->id, sh->policy, sh->key_part, sh->rate, sh->burst, sh->queue_max, sh->tick_us,
+                   sh->pass, sh->delay, sh->marked, sh->drop, sh->keys, sh->queued);
+        }
+        if (info->codec != nullptr)
+        {
+            const CodecInfo *cd = info->codec;
+
+            printf("codec id=%d ; msg=%" PRIu64 " ; bytes_in=%" PRIu64 " ; bytes_out=%" PRIu64 " ; ratio=%.3f ; skip=%" PRIu64
+                   " ; error=%" PRIu64 " ; cpu_ns_per_msg=%" PRIu64 "\n",
+                   info->id, cd->msg, cd->bytes_in, cd->bytes_out,
+                   (cd->bytes_in != 0u) ? static_cast<double>(cd->bytes_out) / static_cast<double>(cd->bytes_in) : 1.0,
+                   cd->skip, cd->error, (cd->msg != 0u) ? cd->cpu_ns / cd->msg : 0u);
+        }
+        if (info->cache != nullptr)
+        {
+            const CacheInfo *ca = info->cache;
+
+            printf("cache id=%d ; hit=%" PRIu64 " ; miss=%" PRIu64 " ; fill=%" PRIu64 " ; evict=%" PRIu64 " ; expire=%" PRIu64
+                   " ; entries=%" PRIu64 " ; bytes=%" PRIu64 " ; max_bytes=%" PRIu64 "\n",
+                   info->id, ca->hit, ca->miss, ca->fill, ca->evict, ca->expire, ca->entries, ca->bytes, ca->max_bytes);
+        }
+        if (info->dedup != nullptr)
+        {
+            const DedupInfo *dd = info->dedup;
+
+            printf("dedup id=%d ; msg=%" PRIu64 " ; pass=%" PRIu64 " ; dup=%" PRIu64 " ; dup_rate=%.4f ; rotate=%" PRIu64
+                   " ; rotate_full=%" PRIu64 " ; bits=%" PRIu64 " ; hashes=%" PRIu64 " ; capacity=%" PRIu64 "\n",
+                   info->id, dd->msg, dd->pass, dd->dup,
+                   (dd->msg != 0u) ? static_cast<double>(dd->dup) / static_cast<double>(dd->msg) : 0.0,
+                   dd->rotate, dd->rotate_full, dd->bits, dd->hashes, dd->capacity);
+        }
+        if (info->capture != nullptr)
+        {
+            const CaptureInfo *cap = info->capture;
+
+            printf("capture id=%d ; record=%" PRIu64 " ; bytes=%" PRIu64 " ; drop=%" PRIu64 " ; rotate=%" PRIu64
+                   " ; error=%" PRIu64 " ; file=%" PRIu64 " ; path=%s\n",
+                   info->id, cap->record, cap->bytes, cap->drop, cap->rotate, cap->error, cap->file, cap->path);
+        }
+    }
+    for (size_t i = 0u; i < list->n_bind; ++i)
+    {
+        const BlockBind *bind = list->bind[i];
+
+        printf("bind id=%d ; port=%d ; dest=%d ; queue=%" PRIu64 " ; queued=%" PRIu64 " ; drop=%" PRIu64 "\n",
+               bind->id, bind->port, bind->dest, bind->queue, bind->queued, bind->drop);
+    }
+
+    block_list__free_unpacked(list, nullptr);
+}
+
+//
+// @brief Match an answer to its command in flight
+//
+// The answer is matched by the identifier of its Reply, answers can come in
+// any order. A peer without Reply answers in order: the oldest command is
+// matched
+//
+void ncli::session_answer(struct buffer &buf)
+{
+    std::map<uint64_t, struct ncli_request>::iterator it;
+    std::vector<uint8_t> payload;
+    std::string status;
+    std::string error;
+
+    if ((buf.parts_.size() < 3u) ||
+        (buf.parts_[1].len != strlen("PROTO.CMD.REP")) ||
+        (memcmp(buf.parts_[1].data, "PROTO.CMD.REP", buf.parts_[1].len) != 0))
+    {
+        LOGGER_DEBUG("Discard message: not an answer [parts_count=%zu]", buf.parts_.size());
+        return;
+    }
+
+    it = session_pending_.begin();
+    if (buf.parts_.size() > 3u)
+    {
+        Reply *reply;
+
+        reply = reply__unpack(nullptr, buf.parts_[3].len, static_cast<uint8_t *>(buf.parts_[3].data));
+        if (reply == nullptr)
+        {
+            LOGGER_ERR("Failed to unpack protobuf reply: unknown reason [size=%zu]", buf.parts_[3].len);
+            return;
+        }
+        it = session_pending_.find(reply->id);
+        error = std::string(reply->error);
+        payload.assign(reply->payload.data, reply->payload.data + reply->payload.len);
+        reply__free_unpacked(reply, nullptr);
+    }
+    if (it == session_pending_.end())
+    {
+        LOGGER_DEBUG("Discard answer: no such command in flight");
+        return;
+    }
+
+    status = std::string(static_cast<char *>(buf.parts_[2].data), buf.parts_[2].len);
+    if (status == it->second.expected)
+    {
+        ++session_ok_;
+    }
+    else
+    {
+        ++session_ko_;
+    }
+
+    printf("id=%" PRIu64 " ; line=%lu ; status=%s ; expected=%s%s%s\n",
+           it->second.id, it->second.line, status.c_str(), it->second.expected.c_str(),
+           error.empty() ? "" : " ; error=", error.c_str());
+    ncli_payload_print(payload.data(), payload.size());
+
+    session_pending_.erase(it);
+
+    // Only wait for the peer while commands are in flight
+    if (session_pending_.empty() == true)
+    {
+        struct timer tm;
+        tm.bk = this;
+        tm.tid = 1;
+        mgr_->timer_del(tm);
+    }
+    else
+    {
+        timeout_arm();
+    }
+}
+
+//
+// @brief Pipeline the commands of the input, up to a window in flight
+//
+// @return true if every command got its expected answer
+//
+bool ncli::session_run(FILE *input)
+{
+    bool is_eof;
+    unsigned long window;
+
+    // Interactive input: wait for each answer before reading further
+    window = (isatty(fileno(input)) == 1) ? 1u : session_window_;
+
+    is_eof = false;
+    timeout_expired_ = false;
+    while ((timeout_expired_ == false) && ((is_eof == false) || (session_pending_.empty() == false)))
+    {
+        while ((is_eof == false) && (session_pending_.size() < window))
+        {
+            is_eof = (session_read(input) == false);
+            if (session_pending_.size() == 1u)
+            {
+                timeout_arm();
+            }
+        }
+
+        mgr_->fd_poll();
+        mgr_->timer_check_exp();
+    }
+
+    for (const auto &it : session_pending_)
+    {
+        printf("id=%" PRIu64 " ; line=%lu ; status=timeout ; expected=%s\n",
+               it.second.id, it.second.line, it.second.expected.c_str());
+        ++session_ko_;
+    }
+    session_pending_.clear();
+
+    printf("commands=%lu ; ok=%lu ; ko=%lu\n", session_seq_, session_ok_, session_ko_);
+
+    return session_ko_ == 0u;
+}
+
 void ncli::stop_()
 {
     // Remove timer
@@ -390,7 +1549,13 @@ bool ncli::data_(void *vdata)
 {
     struct buffer &buf = *(static_cast<struct buffer *>(vdata));
 
-    if (buf.parts_.size() != 3u)
+    if (session_file_ != nullptr)
+    {
+        session_answer(buf);
+        return false;
+    }
+
+    if (buf.parts_.size() < 3u)
     {
         LOGGER_DEBUG("Discard message: wrong parts count [expected=3 ; actual=%zu]", buf.parts_.size());
         return false;
@@ -409,6 +1574,21 @@ bool ncli::data_(void *vdata)
     LOGGER_INFO("Received expected answer");
     received_answer_ = true;
 
+    // Print the answer to a query
+    if (buf.parts_.size() > 3u)
+    {
+        Reply *reply;
+
+        reply = reply__unpack(nullptr, buf.parts_[3].len, static_cast<uint8_t *>(buf.parts_[3].data));
+        if (reply == nullptr)
+        {
+            LOGGER_ERR("Failed to unpack protobuf reply: unknown reason [size=%zu]", buf.parts_[3].len);
+            return false;
+        }
+        ncli_payload_print(reply->payload.data, reply->payload.len);
+        reply__free_unpacked(reply, nullptr);
+    }
+
     return false;
 }
 
@@ -469,18 +1649,45 @@ int main(int argc, char **argv)
     mgr.block_start(1);
     mgr.block_start(2);
 
-    //
-    // Wait for answer or timeout
-    //
-    cli->received_answer_ = false;
-    cli->timeout_expired_ = false;
-    while ((cli->received_answer_ == false) && (cli->timeout_expired_ == false))
+    int return_status;
+
+    if (cli->session_file_ != nullptr)
     {
-        mgr.fd_poll();
-        mgr.timer_check_exp();
+        FILE *input;
+
+        //
+        // Pipeline the commands of the session
+        //
+        input = (strcmp(cli->session_file_, "-") == 0) ? stdin : fopen(cli->session_file_, "r");
+        if (input == nullptr)
+        {
+            LOGGER_ERR("Failed to open session input: %s [errno=%d ; file=%s]", strerror(errno), errno, cli->session_file_);
+            return_status = 1;
+        }
+        else
+        {
+            return_status = (cli->session_run(input) == true) ? 0 : 1;
+            if (input != stdin)
+            {
+                fclose(input);
+            }
+        }
     }
+    else
+    {
+        //
+        // Wait for answer or timeout
+        //
+        cli->received_answer_ = false;
+        cli->timeout_expired_ = false;
+        while ((cli->received_answer_ == false) && (cli->timeout_expired_ == false))
+        {
+            mgr.fd_poll();
+            mgr.timer_check_exp();
+        }
 
-    int return_status = (cli->received_answer_ == true) ? 0 : 1;
+        return_status = (cli->received_answer_ == true) ? 0 : 1;
+    }
 
     //
     // Destroy
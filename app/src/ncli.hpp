@@ -3,6 +3,21 @@
 
 #include "engine/block.hpp"
 
+// C++ headers
+#include <map>
+
+//
+// @struct ncli_request
+//
+// @brief Command of a session waiting for its answer
+//
+struct ncli_request
+{
+    uint64_t id;          // Correlation identifier, local to the session
+    unsigned long line;   // Line of the command in the session input
+    std::string expected; // Expected return
+};
+
 struct ncli : public block
 {
     // ZeroMQ contexts
@@ -21,6 +36,9 @@ struct ncli : public block
     bool options_parse(int argc, char **argv);
     void options_clear();
 
+    bool command_parse(const char *type, const char *args);
+    void command_send(uint64_t id);
+
     //
     // Protobuf command configuration
     //
@@ -31,6 +49,11 @@ struct ncli : public block
     char *add_type_;
     bool parse_add(int argc, char **argv);
 
+    BlockReplace bk_replace_;
+    int32_t replace_id_;
+    char *replace_type_;
+    bool parse_replace(int argc, char **argv);
+
     BlockStart bk_start_;
     int32_t start_id_;
     bool parse_start(int argc, char **argv);
@@ -47,6 +70,7 @@ struct ncli : public block
     int32_t bind_id_;
     int32_t bind_port_;
     int32_t bind_dest_;
+    uint64_t bind_queue_;
     bool parse_bind(int argc, char **argv);
 
     ConfHookZmq conf_hook_zmq_;
@@ -55,8 +79,89 @@ struct ncli : public block
     int32_t hook_zmq_type_;
     char *hook_zmq_name_;
     char *hook_zmq_addr_;
+    std::vector<int32_t> hook_zmq_io_cpu_;
+    int32_t hook_zmq_io_priority_;
+    int64_t hook_zmq_deadline_us_;
+    int64_t hook_zmq_credit_;
     bool parse_hook_zmq(int argc, char **argv);
 
+    ConfSched conf_sched_;
+    std::vector<int32_t> sched_cpu_;
+    int32_t sched_priority_;
+    bool sched_mlock_;
+    bool parse_sched(int argc, char **argv);
+
+    ConfRouter conf_router_;
+    int32_t router_id_;
+    std::vector<RouterRule> router_rule_;
+    std::vector<RouterRule *> router_rule_ptr_;
+    int32_t router_default_port_;
+    uint32_t router_topic_part_;
+    bool parse_router(int argc, char **argv);
+
+    ConfBalancer conf_balancer_;
+    int32_t balancer_id_;
+    ConfBalancer__Policy balancer_policy_;
+    uint32_t balancer_hash_part_;
+    bool parse_balancer(int argc, char **argv);
+
+    ConfAggregator conf_aggregator_;
+    int32_t aggregator_id_;
+    uint32_t aggregator_max_bytes_;
+    uint32_t aggregator_max_count_;
+    int64_t aggregator_latency_us_;
+    bool parse_aggregator(int argc, char **argv);
+
+    ConfShaper conf_shaper_;
+    int32_t shaper_id_;
+    ConfShaper__Policy shaper_policy_;
+    uint32_t shaper_key_part_;
+    uint64_t shaper_rate_;
+    uint64_t shaper_burst_;
+    uint32_t shaper_queue_max_;
+    int64_t shaper_tick_us_;
+    bool parse_shaper(int argc, char **argv);
+
+    ConfCodec conf_codec_;
+    int32_t codec_id_;
+    ConfCodec__Mode codec_mode_;
+    int32_t codec_level_;
+    uint32_t codec_min_size_;
+    uint32_t codec_part_mask_;
+    char *codec_dict_path_;
+    bool parse_codec(int argc, char **argv);
+
+    ConfCache conf_cache_;
+    int32_t cache_id_;
+    uint32_t cache_key_mask_;
+    int64_t cache_ttl_ms_;
+    uint64_t cache_max_bytes_;
+    bool parse_cache(int argc, char **argv);
+
+    ConfDedup conf_dedup_;
+    int32_t dedup_id_;
+    uint32_t dedup_part_mask_;
+    int64_t dedup_window_ms_;
+    double dedup_fp_rate_;
+    uint64_t dedup_max_bytes_;
+    bool parse_dedup(int argc, char **argv);
+
+    ConfCapture conf_capture_;
+    int32_t capture_id_;
+    char *capture_path_;
+    uint64_t capture_file_size_;
+    bool parse_capture(int argc, char **argv);
+
+    BlockGet bk_get_;
+    int32_t get_id_;
+    bool parse_list(int argc, char **argv);
+    bool parse_get(int argc, char **argv);
+    bool parse_graph(int argc, char **argv);
+
+    SnapshotSave snapshot_save_;
+    char *snapshot_path_;
+    bool parse_snapshot(int argc, char **argv);
+
     bool parse_term(int argc, char **argv);
 
     //
@@ -65,6 +170,22 @@ struct ncli : public block
     bool received_answer_;
     bool timeout_expired_;
 
+    //
+    // Session mode: commands are read from a file and pipelined
+    //
+    const char *session_file_;                                // Input, "-" for standard input, nullptr for a single command
+    unsigned long session_window_;                            // Maximum number of commands in flight
+    uint64_t session_seq_;                                    // Identifier of the last command
+    unsigned long session_line_;                              // Line being read
+    unsigned long session_ok_;                                // Answers as expected
+    unsigned long session_ko_;                                // Unexpected answers or invalid commands
+    std::map<uint64_t, struct ncli_request> session_pending_; // Commands sent, by identifier
+
+    bool session_read(FILE *input);
+    void session_answer(struct buffer &buf);
+    bool session_run(FILE *input);
+    void timeout_arm();
+
     //
     // Implementation of the block interface
     //
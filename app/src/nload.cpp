@@ -0,0 +1,419 @@
+//
+// @brief Load generator for the control plane:
+//          nload -> proxy -> c3qo -> trans_pb and back
+//
+// The session to the proxy is kept for the whole run and requests are
+// pipelined. Answers are matched to requests by the identifier echoed in
+// their Reply.
+//
+
+// Project headers
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+#include "utils/logger.hpp"
+
+// Generated protobuf command
+#include "conf.pb-c.h"
+
+// Local headers
+#include "nload.hpp"
+
+extern char *optarg; // Comes with getopt
+
+#define NLOAD_HIGHEST_NS (60l * 1000l * 1000l * 1000l) // Highest round-trip time tracked
+
+//
+// @brief Current monotonic date in nanoseconds
+//
+unsigned long nload_now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<unsigned long>(now.tv_sec) * 1000ul * 1000ul * 1000ul + static_cast<unsigned long>(now.tv_nsec);
+}
+
+nload::nload(struct manager *mgr) : block(mgr),
+                                    peer_(nullptr),
+                                    count_(10000u),
+                                    outstanding_(1u),
+                                    rate_(0.0),
+                                    expected_interval_ns_(0),
+                                    timeout_ns_(1000l * 1000l * 1000l),
+                                    hook_(nullptr),
+                                    start_ns_(0u),
+                                    progress_ns_(0u),
+                                    sent_(0u),
+                                    received_(0u),
+                                    ok_(0u),
+                                    send_failed_(0u),
+                                    next_id_(1u)
+{
+    command__init(&cmd_);
+    block_bind__init(&bind_);
+
+    ASSERT(service_.init(1, NLOAD_HIGHEST_NS, 3) == true);
+    ASSERT(response_.init(1, NLOAD_HIGHEST_NS, 3) == true);
+}
+nload::~nload() {}
+
+//
+// @brief Prepare the command to send: an idempotent bind
+//
+bool nload::command_set(int id, int port, int dest)
+{
+    cmd_.type_case = COMMAND__TYPE_BIND;
+    cmd_.bind = &bind_;
+    cmd_.bind->id = id;
+    cmd_.bind->port = port;
+    cmd_.bind->dest = dest;
+
+    return true;
+}
+
+//
+// @brief Send a request
+//
+// @param intended : Date at which the request should have been sent
+//
+void nload::send_one(unsigned long intended)
+{
+    struct buffer buf;
+    const char *topic;
+    unsigned long tx_pkt;
+
+    buf.push_back(peer_, strlen(peer_) + 1);
+
+    topic = "PROTO.CMD";
+    buf.push_back(topic, strlen(topic));
+
+    cmd_.id = next_id_;
+    ++next_id_;
+    proto_.resize(command__get_packed_size(&cmd_));
+    command__pack(&cmd_, proto_.data());
+    buf.push_back(proto_.data(), proto_.size());
+
+    tx_pkt = hook_->tx_pkt_;
+    process_data_(&buf);
+    buf.clear();
+
+    // The hook does not wait when its queue is full
+    if (hook_->tx_pkt_ == tx_pkt)
+    {
+        ++send_failed_;
+        return;
+    }
+
+    progress_ns_ = nload_now();
+    pending_[cmd_.id] = {intended, progress_ns_};
+    ++sent_;
+}
+
+//
+// @brief Open loop: send the requests whose date has come
+//
+void nload::pace(unsigned long now)
+{
+    if (rate_ <= 0.0)
+    {
+        return;
+    }
+
+    while (sent_ + send_failed_ < count_)
+    {
+        unsigned long intended;
+
+        intended = start_ns_ + static_cast<unsigned long>(static_cast<double>(sent_ + send_failed_) * 1e9 / rate_);
+        if (intended > now)
+        {
+            break;
+        }
+
+        send_one(intended);
+    }
+}
+
+//
+// @brief Verify if every request is answered or if the last answers are lost
+//
+bool nload::is_done(unsigned long now) const
+{
+    if (sent_ + send_failed_ < count_)
+    {
+        return false;
+    }
+
+    return (received_ == sent_) || (now - progress_ns_ > static_cast<unsigned long>(timeout_ns_));
+}
+
+//
+// @brief Print a line of round-trip times in microseconds
+//
+static void nload_report_hdr(FILE *out, const char *name, const struct hdr_histogram &hdr)
+{
+    fprintf(out, "%-9s count=%lu ; mean=%.1f ; p50=%.1f ; p90=%.1f ; p99=%.1f ; p999=%.1f ; max=%.1f ; overflow=%lu\n",
+            name,
+            hdr.total_,
+            hdr.mean() / 1e3,
+            static_cast<double>(hdr.value_at_percentile(50.0)) / 1e3,
+            static_cast<double>(hdr.value_at_percentile(90.0)) / 1e3,
+            static_cast<double>(hdr.value_at_percentile(99.0)) / 1e3,
+            static_cast<double>(hdr.value_at_percentile(99.9)) / 1e3,
+            static_cast<double>(hdr.max_) / 1e3,
+            hdr.overflow_);
+}
+
+//
+// @brief Print throughput and round-trip times
+//
+void nload::report(FILE *out, unsigned long now) const
+{
+    double duration;
+
+    duration = static_cast<double>(now - start_ns_) / 1e9;
+
+    if (rate_ > 0.0)
+    {
+        fprintf(out, "mode=open ; rate=%.1f/s\n", rate_);
+    }
+    else
+    {
+        fprintf(out, "mode=closed ; outstanding=%lu ; expected_interval_us=%.1f\n",
+                outstanding_, static_cast<double>(expected_interval_ns_) / 1e3);
+    }
+    fprintf(out, "sent=%lu ; send_failed=%lu ; received=%lu ; ok=%lu ; ko=%lu ; lost=%lu\n",
+            sent_, send_failed_, received_, ok_, received_ - ok_, sent_ - received_);
+    fprintf(out, "duration_s=%.3f ; throughput=%.1f/s\n",
+            duration, (duration > 0.0) ? static_cast<double>(received_) / duration : 0.0);
+
+    // Round-trip times from the actual send, then from the intended send
+    fprintf(out, "round-trip times in microseconds:\n");
+    nload_report_hdr(out, "service", service_);
+    nload_report_hdr(out, "response", response_);
+}
+
+//
+// @brief Start the load: closed loop fills the window of outstanding requests
+//
+void nload::start_()
+{
+    start_ns_ = nload_now();
+    progress_ns_ = start_ns_;
+
+    if (rate_ > 0.0)
+    {
+        pace(start_ns_);
+        return;
+    }
+
+    for (unsigned long i = 0u; (i < outstanding_) && (sent_ + send_failed_ < count_); ++i)
+    {
+        send_one(nload_now());
+    }
+}
+
+//
+// @brief Match an answer to its request, by the identifier of the Reply
+//
+bool nload::data_(void *vdata)
+{
+    struct buffer &buf = *(static_cast<struct buffer *>(vdata));
+    unsigned long now;
+    unsigned long intended;
+    unsigned long actual;
+    Reply *reply;
+
+    now = nload_now();
+
+    if ((buf.parts_.size() < 4u) ||
+        (buf.parts_[1].len != strlen("PROTO.CMD.REP")) ||
+        (memcmp(buf.parts_[1].data, "PROTO.CMD.REP", buf.parts_[1].len) != 0))
+    {
+        LOGGER_DEBUG("Discard unexpected message [parts_count=%zu]", buf.parts_.size());
+        return false;
+    }
+
+    reply = reply__unpack(nullptr, buf.parts_[3].len, static_cast<uint8_t *>(buf.parts_[3].data));
+    if (reply == nullptr)
+    {
+        LOGGER_ERR("Failed to unpack protobuf reply: unknown reason [size=%zu]", buf.parts_[3].len);
+        return false;
+    }
+    const auto &it = pending_.find(reply->id);
+    reply__free_unpacked(reply, nullptr);
+    if (it == pending_.end())
+    {
+        LOGGER_DEBUG("Discard answer without request");
+        return false;
+    }
+
+    intended = it->second.intended;
+    actual = it->second.actual;
+    pending_.erase(it);
+
+    ++received_;
+    if ((buf.parts_[2].len == 2u) && (memcmp(buf.parts_[2].data, "OK", 2u) == 0))
+    {
+        ++ok_;
+    }
+    progress_ns_ = now;
+
+    service_.record(static_cast<long>(now - actual));
+    if (rate_ > 0.0)
+    {
+        // Open loop: the intended date already accounts for the waiting
+        response_.record(static_cast<long>(now - intended));
+    }
+    else
+    {
+        // Closed loop: fill in the requests a slow answer prevented
+        response_.record_corrected(static_cast<long>(now - actual), expected_interval_ns_);
+
+        if (sent_ + send_failed_ < count_)
+        {
+            send_one(now);
+        }
+    }
+
+    return false;
+}
+
+struct block *nload_factory::constructor(struct manager *mgr)
+{
+    return new struct nload(mgr);
+}
+
+void nload_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct nload *>(bk);
+}
+
+int main(int argc, char **argv)
+{
+    struct manager mgr;
+    struct hook_zmq_factory hook_zmq_f;
+    struct nload_factory nload_f;
+    struct hook_zmq *hook;
+    struct nload *load;
+    const char *options;
+    int bind_id;
+    int bind_port;
+    int bind_dest;
+
+    LOGGER_OPEN("nload");
+
+    mgr.block_factory_register("hook_zmq", &hook_zmq_f);
+    mgr.block_factory_register("nload", &nload_f);
+
+    mgr.block_add(1, "hook_zmq");
+    hook = static_cast<struct hook_zmq *>(mgr.block_get(1));
+    ASSERT(hook != nullptr);
+
+    mgr.block_add(2, "nload");
+    load = static_cast<struct nload *>(mgr.block_get(2));
+    ASSERT(load != nullptr);
+
+    //
+    // Configure
+    //
+    bind_id = -2;
+    bind_port = 0;
+    bind_dest = -1;
+    options = "b:c:e:hi:n:r:t:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'b':
+            if (sscanf(optarg, "%d,%d,%d", &bind_id, &bind_port, &bind_dest) != 3)
+            {
+                LOGGER_ERR("Failed to parse option: wrong bind [value=%s]", optarg);
+                return 1;
+            }
+            break;
+
+        case 'c':
+            load->outstanding_ = strtoul(optarg, nullptr, 10);
+            break;
+
+        case 'e':
+            load->expected_interval_ns_ = atol(optarg) * 1000l;
+            break;
+
+        case 'i':
+            load->peer_ = optarg;
+            break;
+
+        case 'n':
+            load->count_ = strtoul(optarg, nullptr, 10);
+            break;
+
+        case 'r':
+            load->rate_ = atof(optarg);
+            break;
+
+        case 't':
+            load->timeout_ns_ = atol(optarg) * 1000l * 1000l;
+            break;
+
+        case 'h':
+        default:
+            printf("Usage: %s -i identity [-n count] [-c outstanding] [-r rate] [-e expected_us] [-t timeout_ms] [-b id,port,dest]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if ((load->peer_ == nullptr) || (load->count_ == 0u) || (load->outstanding_ == 0u))
+    {
+        LOGGER_ERR("Failed to parse options: identity, count and outstanding are required");
+        return 1;
+    }
+
+    hook->client_ = true;
+    hook->type_ = ZMQ_PAIR;
+    hook->addr_ = std::string("tcp://127.0.0.1:1665");
+
+    load->hook_ = hook;
+    ASSERT(load->command_set(bind_id, bind_port, bind_dest) == true);
+
+    mgr.block_bind(1, 0, 2);
+    mgr.block_bind(2, 0, 1);
+
+    // Never sleep in the poll: requests have to be sent on time
+    mgr.fd_spin(1000l * 1000l);
+
+    mgr.block_start(1);
+    mgr.block_start(2);
+
+    //
+    // Run until every answer is received or the last ones are lost
+    //
+    while (true)
+    {
+        unsigned long now;
+
+        now = nload_now();
+        load->pace(now);
+        if (load->is_done(now) == true)
+        {
+            break;
+        }
+
+        mgr.fd_poll();
+    }
+
+    load->report(stdout, nload_now());
+
+    int return_status = ((load->received_ == load->sent_) && (load->send_failed_ == 0u)) ? 0 : 1;
+
+    //
+    // Destroy
+    //
+    mgr.block_clear();
+    mgr.block_factory_clear();
+
+    LOGGER_CLOSE();
+
+    return return_status;
+}
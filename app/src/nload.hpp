@@ -0,0 +1,90 @@
+#ifndef NLOAD_HPP
+#define NLOAD_HPP
+
+// Project headers
+#include "block/hook_zmq.hpp"
+#include "engine/block.hpp"
+#include "utils/hdr.hpp"
+
+// C++ headers
+#include <unordered_map>
+
+//
+// @struct nload_request
+//
+// @brief Request waiting for its answer
+//
+struct nload_request
+{
+    unsigned long intended; // Intended send date
+    unsigned long actual;   // Actual send date
+};
+
+//
+// @struct nload
+//
+// @brief Load generator: pipelined configuration commands through the proxy
+//          - closed loop: a fixed number of requests are outstanding
+//          - open loop: requests are sent at a fixed rate, whatever the answers
+//
+struct nload : block
+{
+    //
+    // Configuration
+    //
+    const char *peer_;           // Identity of the peer to load
+    unsigned long count_;        // Number of requests to send
+    unsigned long outstanding_;  // Closed loop: requests in flight
+    double rate_;                // Open loop: requests per second, 0 for closed loop
+    long expected_interval_ns_;  // Closed loop: expected interval for coordinated omission correction
+    long timeout_ns_;            // Time to wait for the last answers
+    struct hook_zmq *hook_;      // Hook to the proxy, to detect send failures
+    Command cmd_;                // Command to send, with the identifier of each request
+    BlockBind bind_;             // Binding of the command
+    std::vector<uint8_t> proto_; // Packed command
+
+    //
+    // Progress
+    //
+    unsigned long start_ns_;                                     // Date of the first request
+    unsigned long progress_ns_;                                  // Date of the last sent request or received answer
+    unsigned long sent_;                                         // Requests sent
+    unsigned long received_;                                     // Answers received
+    unsigned long ok_;                                           // Answers with success status
+    unsigned long send_failed_;                                  // Requests that could not be sent
+    uint64_t next_id_;                                           // Identifier of the next request
+    std::unordered_map<uint64_t, struct nload_request> pending_; // Requests sent, by identifier
+
+    //
+    // Round-trip times in nanoseconds
+    //
+    struct hdr_histogram service_;  // From the actual send date
+    struct hdr_histogram response_; // Corrected for coordinated omission
+
+    bool command_set(int id, int port, int dest);
+    void send_one(unsigned long intended);
+    void pace(unsigned long now);
+    bool is_done(unsigned long now) const;
+    void report(FILE *out, unsigned long now) const;
+
+    //
+    // Implementation of the block interface
+    //
+    explicit nload(struct manager *mgr);
+    virtual ~nload() override final;
+
+    virtual void start_() override final;
+
+    virtual bool data_(void *vdata) override final;
+};
+
+struct nload_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+// Current monotonic date in nanoseconds
+unsigned long nload_now();
+
+#endif // NLOAD_HPP
@@ -3,59 +3,126 @@
 // Project headers
 #include "block/hook_zmq.hpp"
 #include "engine/manager.hpp"
+#include "utils/sched.hpp"
 
-// C headers
-extern "C"
+extern char *optarg; // Comes with getopt
+
+//
+// @struct proxy_signal
+//
+// @brief Terminate the proxy upon signal reception
+//
+struct proxy_signal : block
 {
-#include <signal.h>
-}
+    explicit proxy_signal(struct manager *mgr) : block(mgr) {}
 
-static void signal_handler(int, siginfo_t *, void *) {}
+    virtual void on_signal_(int signo) override final
+    {
+        LOGGER_INFO("Terminating on signal [signo=%d]", signo);
+        mgr_->stop_();
+    }
+};
 
 //
 // Starts a proxy
 // - frontend is to connect several DEALER
 // - backend is to pilot these apps
 //
-int main(int, char **)
+int main(int argc, char **argv)
 {
     struct manager mgr;
+    struct hook_zmq_factory hook_zmq;
+    struct hook_zmq *hook;
+    struct sched_conf sched;
+    const char *options;
+
+    options = "a:mp:z:";
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'a':
+            if (sched_cpu_parse(optarg, sched.cpu_) == false)
+            {
+                return 1;
+            }
+            break;
+
+        case 'm':
+            sched.mlock_ = true;
+            break;
+
+        case 'p':
+            sched.priority_ = atoi(optarg);
+            break;
+
+        case 'z':
+            if (sched_cpu_parse(optarg, sched.io_cpu_) == false)
+            {
+                return 1;
+            }
+            break;
+
+        default:
+            return 1;
+        }
+    }
 
     LOGGER_OPEN("proxy");
 
-    // Register a signal handler
-    struct sigaction sa;
-    sa.sa_flags = SA_SIGINFO;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_sigaction = signal_handler;
-
-    int rc;
-    rc = sigaction(SIGINT, &sa, NULL);
-    ASSERT(rc != -1);
-    rc = sigaction(SIGTERM, &sa, NULL);
-    ASSERT(rc != -1);
-
-    LOGGER_INFO("Registered signal handler for SIGINT and SIGTERM");
-
-    struct hook_zmq frontend(&mgr);
-    frontend.type_ = ZMQ_ROUTER;
-    frontend.client_ = false;
-    frontend.addr_ = std::string("tcp://127.0.0.1:1664");
-    frontend.start_();
-
-    struct hook_zmq backend(&mgr);
-    backend.type_ = ZMQ_PAIR;
-    backend.client_ = false;
-    backend.addr_ = std::string("tcp://127.0.0.1:1665");
-    backend.start_();
-
-    rc = zmq_proxy(frontend.zmq_sock_.socket, backend.zmq_sock_.socket, nullptr);
-    ASSERT(rc == -1);
-
-    LOGGER_INFO("Proxy has stopped: %s [errno=%d]", strerror(errno), errno);
-
-    backend.stop_();
-    frontend.stop_();
+    // Pin the main loop, or keep running with the default scheduling
+    if (sched.apply("proxy") == false)
+    {
+        LOGGER_ERR("Failed to apply the scheduling, running unpinned");
+    }
+
+    // Register signals
+    struct proxy_signal sig(&mgr);
+    ASSERT(mgr.signal_add(SIGINT, &sig) == true);
+    ASSERT(mgr.signal_add(SIGTERM, &sig) == true);
+
+    mgr.block_factory_register("hook_zmq", &hook_zmq);
+
+    // Frontend
+    mgr.block_add(1, "hook_zmq");
+    hook = static_cast<struct hook_zmq *>(mgr.block_get(1));
+    hook->type_ = ZMQ_ROUTER;
+    hook->client_ = false;
+    hook->addr_ = std::string("tcp://127.0.0.1:1664");
+    hook->io_cpu_ = sched.io_cpu_;
+    hook->io_priority_ = sched.priority_;
+
+    // Backend
+    mgr.block_add(2, "hook_zmq");
+    hook = static_cast<struct hook_zmq *>(mgr.block_get(2));
+    hook->type_ = ZMQ_PAIR;
+    hook->client_ = false;
+    hook->addr_ = std::string("tcp://127.0.0.1:1665");
+    hook->io_cpu_ = sched.io_cpu_;
+    hook->io_priority_ = sched.priority_;
+
+    // Forward messages in both directions
+    mgr.block_bind(1, 0, 2);
+    mgr.block_bind(2, 0, 1);
+
+    mgr.block_start(1);
+    mgr.block_start(2);
+
+    // Main loop
+    mgr.start_();
+    while (mgr.is_term_ == false)
+    {
+        mgr.fd_poll();
+        mgr.timer_check_exp();
+    }
+
+    LOGGER_INFO("Proxy has stopped");
+
+    mgr.block_stop(2);
+    mgr.block_stop(1);
+
+    mgr.block_del(2);
+    mgr.block_del(1);
 
     LOGGER_CLOSE();
 
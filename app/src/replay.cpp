@@ -0,0 +1,251 @@
+//
+// @brief Replay of capture files into a graph of blocks, with their timing
+//
+
+// Project headers
+#include "blocks.hpp"
+
+// C++ headers
+#include <map>
+
+extern char *optarg; // Comes with getopt
+extern int optind;   // Comes with getopt
+
+#define REPLAY_POLL_NS (10l * 1000l * 1000l) // Waits longer than the poll timeout are spent polling
+#define REPLAY_SPIN_NS (50l * 1000l)         // Waits shorter than this are spent spinning
+#define REPLAY_DEPTH 1024u                   // Work in flight before waiting for completions
+
+//
+// @brief Wait for the date of the next record, serving the loop meanwhile
+//
+static void replay_wait(struct manager &mgr, const struct timespec &until)
+{
+    while (true)
+    {
+        struct timespec now;
+        long wait;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        wait = elapsed_ns(now, until);
+        if (wait <= 0)
+        {
+            return;
+        }
+
+        if ((mgr.fd_.empty() == false) && (wait > REPLAY_POLL_NS))
+        {
+            mgr.fd_poll();
+        }
+        else if (wait > REPLAY_SPIN_NS)
+        {
+            struct timespec delay;
+
+            wait -= REPLAY_SPIN_NS;
+            delay.tv_sec = wait / 1000000000l;
+            delay.tv_nsec = wait % 1000000000l;
+            nanosleep(&delay, nullptr);
+        }
+        mgr.timer_check_exp();
+    }
+}
+
+//
+// @brief Print the options
+//
+static void replay_usage(const char *name)
+{
+    printf("Usage: %s [-c snapshot] [-i entry_id] [-x speed, 0 for maximum] [-n loops] [-w workers] file...\n", name);
+}
+
+//
+// Feeds captures into a graph of blocks
+// - at the original speed, N times faster or as fast as possible
+// - the graph is restored from a snapshot, or is a hello block
+//
+int main(int argc, char **argv)
+{
+    const char *options;
+    const char *snapshot;
+    int entry_id;
+    long loops;
+    long worker_count;
+    double speed;
+
+    options = "c:hi:n:w:x:";
+    snapshot = nullptr;
+    entry_id = 1;
+    loops = 1;
+    worker_count = 0;
+    speed = 1.0;
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'c':
+            snapshot = optarg;
+            break;
+
+        case 'i':
+            entry_id = atoi(optarg);
+            break;
+
+        case 'n':
+            loops = atol(optarg);
+            break;
+
+        case 'w':
+            worker_count = atol(optarg);
+            break;
+
+        case 'x':
+            speed = atof(optarg);
+            break;
+
+        default:
+            replay_usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((optind >= argc) || (speed < 0.0))
+    {
+        replay_usage(argv[0]);
+        return 1;
+    }
+
+    LOGGER_OPEN("replay");
+
+    // Register block factories
+    struct manager mgr;
+    struct blocks factories;
+
+    factories.factory_register(mgr);
+
+    // Rebuild the graph, bindings of the management blocks of c3qo are lost
+    if (snapshot != nullptr)
+    {
+        mgr.block_add(-2, "trans_pb");
+        mgr.block_start(-2);
+
+        if (static_cast<struct trans_pb *>(mgr.block_get(-2))->snapshot_load(snapshot) == false)
+        {
+            LOGGER_ERR("Failed to restore the graph: some blocks are missing [snapshot=%s]", snapshot);
+        }
+    }
+    else
+    {
+        mgr.block_add(entry_id, "hello");
+        mgr.block_start(entry_id);
+    }
+
+    struct block *entry = mgr.block_get(entry_id);
+    if (entry == nullptr)
+    {
+        printf("Unknown entry block [id=%d]\n", entry_id);
+        return 1;
+    }
+
+    // Workers for CPU-heavy processing
+    if (worker_count > 0)
+    {
+        ASSERT(mgr.work_start(static_cast<size_t>(worker_count)) == true);
+    }
+
+    unsigned long records = 0u;
+    unsigned long bytes = 0u;
+    struct timespec begin;
+    struct timespec end;
+
+    mgr.start_();
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (long loop = 0; (loop < loops) && (mgr.is_term_ == false); ++loop)
+    {
+        struct timespec origin;
+        uint64_t first_ns;
+        bool is_first;
+
+        // Each loop follows the timeline of the captures from the start
+        clock_gettime(CLOCK_MONOTONIC, &origin);
+        first_ns = 0u;
+        is_first = true;
+
+        for (int i = optind; i < argc; ++i)
+        {
+            struct capture_reader reader;
+            struct buffer buf;
+            uint64_t date_ns;
+
+            if (reader.open(argv[i]) == false)
+            {
+                printf("Failed to open capture [path=%s]\n", argv[i]);
+                continue;
+            }
+
+            while ((reader.next(buf, date_ns) == true) && (mgr.is_term_ == false))
+            {
+                if (is_first == true)
+                {
+                    first_ns = date_ns;
+                    is_first = false;
+                }
+
+                if (speed > 0.0)
+                {
+                    struct timespec until;
+                    long offset;
+
+                    offset = static_cast<long>(static_cast<double>((date_ns > first_ns) ? date_ns - first_ns : 0u) / speed);
+                    until.tv_sec = origin.tv_sec + offset / 1000000000l;
+                    until.tv_nsec = origin.tv_nsec + offset % 1000000000l;
+                    if (until.tv_nsec >= 1000000000l)
+                    {
+                        until.tv_sec += 1;
+                        until.tv_nsec -= 1000000000l;
+                    }
+                    replay_wait(mgr, until);
+                }
+
+                // Queued bindings hold data, or workers are behind: the poll returns at once
+                if ((mgr.qu_ready_.pending_.load() != 0u) || (mgr.wk_submit_ - mgr.wk_complete_ >= REPLAY_DEPTH))
+                {
+                    mgr.fd_poll();
+                }
+
+                for (const auto &part : buf.parts_)
+                {
+                    bytes += part.len;
+                }
+                ++records;
+
+                entry->process_data_(entry, &buf);
+                buf.clear();
+                mgr.timer_check_exp();
+            }
+        }
+    }
+
+    // Data still queued, and completions of the work still in flight
+    for (int i = 0; (i < 1000) && ((mgr.qu_ready_.pending_.load() != 0u) || (mgr.wk_submit_ != mgr.wk_complete_)); ++i)
+    {
+        mgr.fd_poll();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double duration = static_cast<double>(elapsed_ns(begin, end)) / 1e9;
+
+    printf("records=%lu ; bytes=%lu ; duration_s=%.3f ; throughput=%.1f/s\n",
+           records, bytes, duration, (duration > 0.0) ? static_cast<double>(records) / duration : 0.0);
+
+    std::map<int, const struct block *> blocks(mgr.bk_map_.cbegin(), mgr.bk_map_.cend());
+    for (const auto &it : blocks)
+    {
+        printf("block id=%d ; type=%s ; rx=%lu ; tx=%lu\n", it.first, it.second->type_.c_str(), it.second->data_rx_, it.second->data_tx_);
+    }
+
+    // Files of the captures are closed by the loop
+    mgr.work_stop();
+    mgr.block_clear();
+
+    LOGGER_CLOSE();
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+
+#
+# Compare benchmark runs against a baseline of the machine class
+#
+# Every run is a JSON report of bench_c3qo. Runs are aggregated per case
+# with the median and a distribution-free confidence interval of the median.
+# A case regresses when it is worse than the baseline by more than a
+# threshold AND the confidence intervals do not overlap, so that noise
+# alone does not fail the gate.
+#
+
+import argparse
+import json
+import math
+import os
+import platform
+import re
+import sys
+
+DIR_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "baseline")
+
+# Metrics to compare: name in the report, True if higher is better
+METRICS = [
+    ("ops_per_sec", True),
+    ("p99_ns", False),
+]
+
+
+def machine_class():
+    """Name of the machine class: architecture, CPU model and CPU count"""
+    model = platform.processor() or "unknown"
+
+    try:
+        with open("/proc/cpuinfo") as cpuinfo:
+            for line in cpuinfo:
+                if line.startswith("model name"):
+                    model = line.split(":", 1)[1]
+                    break
+    except OSError:
+        pass
+
+    name = "%s-%s-%dcpu" % (platform.machine(), model.strip(), os.cpu_count() or 1)
+
+    return re.sub(r"[^A-Za-z0-9.]+", "_", name).strip("_").lower()
+
+
+def median_ci(values, confidence=0.95):
+    """Median and confidence interval of the median from order statistics"""
+    values = sorted(values)
+    n = len(values)
+
+    if n % 2 == 1:
+        median = values[n // 2]
+    else:
+        median = (values[n // 2 - 1] + values[n // 2]) / 2.0
+
+    # Largest rank k such that P(Binomial(n, 0.5) < k) <= alpha / 2
+    alpha = 1.0 - confidence
+    k = 0
+    cumul = 0.0
+    for i in range(n):
+        cumul += math.comb(n, i) / 2.0 ** n
+        if cumul > alpha / 2.0:
+            break
+        k = i + 1
+
+    # Not enough runs for the confidence: fall back to the extremes
+    if k == 0:
+        return median, values[0], values[-1]
+
+    return median, values[k - 1], values[n - k]
+
+
+def load_runs(files):
+    """Samples of every metric per case, one sample per run"""
+    cases = {}
+
+    for path in files:
+        with open(path) as run:
+            report = json.load(run)
+
+        for result in report["benchmarks"]:
+            case = cases.setdefault(result["name"], {metric: [] for metric, _ in METRICS})
+            for metric, _ in METRICS:
+                case[metric].append(result[metric])
+
+    return cases
+
+
+def summarize(cases, confidence):
+    """Median and confidence interval of every metric per case"""
+    summary = {}
+
+    for name, samples in cases.items():
+        summary[name] = {}
+        for metric, _ in METRICS:
+            median, low, high = median_ci(samples[metric], confidence)
+            summary[name][metric] = {
+                "median": median,
+                "low": low,
+                "high": high,
+                "runs": len(samples[metric]),
+            }
+
+    return summary
+
+
+def compare(baseline, current, thresholds):
+    """Print the comparison and return the number of regressions"""
+    regressions = 0
+
+    print("%-36s %-12s %14s %14s %8s  %s" % ("case", "metric", "baseline", "current", "delta", "verdict"))
+
+    for name in sorted(current):
+        if name not in baseline:
+            print("%-36s %-12s %14s %14s %8s  %s" % (name, "", "", "", "", "NEW"))
+            continue
+
+        for metric, higher_is_better in METRICS:
+            base = baseline[name][metric]
+            cur = current[name][metric]
+            threshold = thresholds[metric]
+
+            if base["median"] == 0:
+                continue
+            delta = (cur["median"] - base["median"]) / base["median"]
+
+            if higher_is_better:
+                worse = delta < -threshold and cur["high"] < base["low"]
+                better = delta > threshold and cur["low"] > base["high"]
+            else:
+                worse = delta > threshold and cur["low"] > base["high"]
+                better = delta < -threshold and cur["high"] < base["low"]
+
+            if worse:
+                verdict = "REGRESSION"
+                regressions += 1
+            elif better:
+                verdict = "improvement"
+            else:
+                verdict = "ok"
+
+            print("%-36s %-12s %14.1f %14.1f %+7.1f%%  %s" %
+                  (name, metric, base["median"], cur["median"], delta * 100.0, verdict))
+
+    for name in sorted(set(baseline) - set(current)):
+        print("%-36s %-12s %14s %14s %8s  %s" % (name, "", "", "", "", "MISSING"))
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare benchmark runs against a baseline")
+    parser.add_argument("action", choices=["compare", "update", "class"],
+                        help="compare runs, update the baseline with runs, or print the machine class")
+    parser.add_argument("runs", nargs="*", help="JSON reports of bench_c3qo, one per run")
+    parser.add_argument("-m", "--machine", default=None, help="machine class (default: detected)")
+    parser.add_argument("-c", "--confidence", type=float, default=0.95, help="confidence of the intervals")
+    parser.add_argument("-t", "--throughput", type=float, default=0.05,
+                        help="tolerated throughput loss (default: 0.05)")
+    parser.add_argument("-l", "--latency", type=float, default=0.10,
+                        help="tolerated p99 latency increase (default: 0.10)")
+    args = parser.parse_args()
+
+    machine = args.machine or machine_class()
+    path = os.path.join(DIR_BASELINE, machine + ".json")
+
+    if args.action == "class":
+        print(machine)
+        return 0
+
+    if not args.runs:
+        print("FAILED: no run to process", file=sys.stderr)
+        return 1
+
+    current = summarize(load_runs(args.runs), args.confidence)
+
+    if args.action == "update":
+        os.makedirs(DIR_BASELINE, exist_ok=True)
+        with open(path, "w") as out:
+            json.dump({"machine": machine, "benchmarks": current}, out, indent=2, sort_keys=True)
+            out.write("\n")
+        print("Baseline updated [file=%s ; runs=%d ; cases=%d]" % (path, len(args.runs), len(current)))
+        return 0
+
+    if not os.path.isfile(path):
+        print("FAILED: no baseline for this machine class [file=%s]" % path, file=sys.stderr)
+        return 1
+
+    with open(path) as baseline_file:
+        baseline = json.load(baseline_file)["benchmarks"]
+
+    regressions = compare(baseline, current, {"ops_per_sec": args.throughput, "p99_ns": args.latency})
+    if regressions != 0:
+        print("FAILED: performance regression [count=%d ; machine=%s]" % (regressions, machine))
+        return 1
+
+    print("No performance regression [machine=%s]" % machine)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,68 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+// Project headers
+#include "bench/perf.hpp"
+#include "utils/include.hpp"
+
+// C++ headers
+#include <functional>
+#include <string>
+
+//
+// @struct bench_result
+//
+// @brief Statistics of a benchmark case, durations are in nanoseconds per operation
+//
+struct bench_result
+{
+    std::string name_;  // Name of the case
+    std::string unit_;  // What an operation is
+    unsigned long ops_; // Operations per repetition
+    size_t samples_;    // Number of samples
+    double mean_;
+    double min_;
+    double p50_;
+    double p90_;
+    double p99_;
+    double p999_;
+    double max_;
+    double ops_per_sec_; // Throughput from the median
+
+    struct perf_sample counters_; // Hardware counters per operation
+};
+
+//
+// @struct bench
+//
+// @brief Benchmark harness: warmup, repetitions, percentiles and JSON report
+//
+struct bench
+{
+    // Configuration
+    std::string filter_; // Only run cases containing this string
+    int warmup_;         // Repetitions to discard
+    int repeat_;         // Repetitions to measure
+
+    struct perf_counters perf_; // Hardware counters, if opened
+
+    std::vector<struct bench_result> results_;
+
+    bench();
+
+    bool selected(const char *name) const;
+
+    // Time a function doing some operations, once per repetition
+    void run(const char *name, const char *unit, unsigned long ops, const std::function<void(unsigned long)> &fn);
+
+    // Record samples measured by the case itself (latency of each operation)
+    void record(const char *name, const char *unit, std::vector<double> &samples,
+                const struct perf_sample &counters = perf_sample());
+
+    void report(FILE *out) const;
+};
+
+// Current monotonic date in nanoseconds
+unsigned long bench_now();
+
+#endif // BENCH_HPP
@@ -0,0 +1,62 @@
+#ifndef PERF_HPP
+#define PERF_HPP
+
+// Project headers
+#include "utils/include.hpp"
+
+//
+// @enum perf_counter
+//
+// @brief Hardware counters sampled around a benchmark case
+//
+enum perf_counter
+{
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_COUNT,
+};
+
+//
+// @struct perf_sample
+//
+// @brief Values of the counters, normalized per operation
+//
+struct perf_sample
+{
+    bool valid_[PERF_COUNT];
+    double value_[PERF_COUNT];
+
+    perf_sample();
+};
+
+//
+// @struct perf_counters
+//
+// @brief Counters of the calling thread, through perf_event_open
+//
+// Counters that the kernel or the hardware refuse (containers, virtual
+// machines, perf_event_paranoid) are not opened and their values stay invalid
+//
+struct perf_counters
+{
+    int fd_[PERF_COUNT]; // File descriptor per counter, -1 if unavailable
+    bool user_only_;     // Kernel is excluded when not allowed to count it
+
+    perf_counters();
+    ~perf_counters();
+
+    bool open();
+    void close();
+    bool is_open() const;
+
+    void start();
+    void stop(struct perf_sample &sample, unsigned long ops);
+};
+
+const char *perf_counter_name(int counter);
+
+#endif // PERF_HPP
@@ -0,0 +1,208 @@
+//
+// @brief Benchmark harness
+//
+
+// Project headers
+#include "bench/bench.hpp"
+#include "utils/logger.hpp"
+
+// C++ headers
+#include <algorithm>
+
+// C headers
+extern "C"
+{
+#include <time.h>
+#include <unistd.h>
+}
+
+bench::bench() : filter_(""), warmup_(1), repeat_(10) {}
+
+//
+// @brief Current monotonic date in nanoseconds
+//
+unsigned long bench_now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<unsigned long>(now.tv_sec) * 1000ul * 1000ul * 1000ul + static_cast<unsigned long>(now.tv_nsec);
+}
+
+//
+// @brief Value at a given rank of sorted samples
+//
+static double bench_percentile(const std::vector<double> &sorted, double rank)
+{
+    size_t index;
+
+    index = static_cast<size_t>(rank * static_cast<double>(sorted.size() - 1u) + 0.5);
+
+    return sorted[index];
+}
+
+//
+// @brief Instructions per cycle
+//
+static double bench_ipc(const struct perf_sample &counters)
+{
+    if (counters.value_[PERF_CYCLES] <= 0.0)
+    {
+        return 0.0;
+    }
+
+    return counters.value_[PERF_INSTRUCTIONS] / counters.value_[PERF_CYCLES];
+}
+
+//
+// @brief Verify if a case has to be run
+//
+bool bench::selected(const char *name) const
+{
+    return (filter_.empty() == true) || (strstr(name, filter_.c_str()) != nullptr);
+}
+
+//
+// @brief Time a function once per repetition
+//
+// @param name : Name of the case
+// @param unit : What an operation is
+// @param ops  : Number of operations done by one call to the function
+// @param fn   : Function to benchmark, given the number of operations
+//
+void bench::run(const char *name, const char *unit, unsigned long ops, const std::function<void(unsigned long)> &fn)
+{
+    std::vector<double> samples;
+    struct perf_sample counters;
+
+    if (selected(name) == false)
+    {
+        return;
+    }
+
+    for (int i = 0; i < warmup_; ++i)
+    {
+        fn(ops);
+    }
+
+    perf_.start();
+    for (int i = 0; i < repeat_; ++i)
+    {
+        unsigned long begin;
+        unsigned long end;
+
+        begin = bench_now();
+        fn(ops);
+        end = bench_now();
+
+        samples.push_back(static_cast<double>(end - begin) / static_cast<double>(ops));
+    }
+    perf_.stop(counters, ops * static_cast<unsigned long>(repeat_));
+
+    record(name, unit, samples, counters);
+    results_.back().ops_ = ops;
+}
+
+//
+// @brief Compute the statistics of some samples
+//
+// @param counters : Hardware counters per operation, if any
+//
+void bench::record(const char *name, const char *unit, std::vector<double> &samples,
+                   const struct perf_sample &counters)
+{
+    struct bench_result result;
+    double sum;
+
+    if (samples.empty() == true)
+    {
+        LOGGER_ERR("Failed to record benchmark: no sample [name=%s]", name);
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    sum = 0.0;
+    for (double it : samples)
+    {
+        sum += it;
+    }
+
+    result.name_ = name;
+    result.unit_ = unit;
+    result.ops_ = 1u;
+    result.samples_ = samples.size();
+    result.mean_ = sum / static_cast<double>(samples.size());
+    result.min_ = samples.front();
+    result.p50_ = bench_percentile(samples, 0.50);
+    result.p90_ = bench_percentile(samples, 0.90);
+    result.p99_ = bench_percentile(samples, 0.99);
+    result.p999_ = bench_percentile(samples, 0.999);
+    result.max_ = samples.back();
+    result.ops_per_sec_ = (result.p50_ > 0.0) ? 1e9 / result.p50_ : 0.0;
+    result.counters_ = counters;
+
+    results_.push_back(result);
+
+    // Human readable summary on standard error
+    fprintf(stderr, "%-40s p50=%12.1f ns/%s ; p99=%12.1f ; ops/s=%14.1f",
+            name, result.p50_, unit, result.p99_, result.ops_per_sec_);
+    if ((counters.valid_[PERF_CYCLES] == true) && (counters.valid_[PERF_INSTRUCTIONS] == true))
+    {
+        fprintf(stderr, " ; cycles=%.1f ; ipc=%.2f",
+                counters.value_[PERF_CYCLES],
+                bench_ipc(counters));
+    }
+    fprintf(stderr, "\n");
+}
+
+//
+// @brief Write the results in JSON
+//
+void bench::report(FILE *out) const
+{
+    char host[64];
+
+    if (gethostname(host, sizeof(host)) != 0)
+    {
+        snprintf(host, sizeof(host), "unknown");
+    }
+    host[sizeof(host) - 1u] = '\0';
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"context\": {\"host\": \"%s\", \"cpu_count\": %ld, \"warmup\": %d, \"repeat\": %d},\n",
+            host, sysconf(_SC_NPROCESSORS_ONLN), warmup_, repeat_);
+    fprintf(out, "  \"benchmarks\": [\n");
+    for (size_t i = 0u; i < results_.size(); ++i)
+    {
+        const struct bench_result &r = results_[i];
+        const char *sep;
+
+        fprintf(out,
+                "    {\"name\": \"%s\", \"unit\": \"%s\", \"ops\": %lu, \"samples\": %zu, "
+                "\"mean_ns\": %.3f, \"min_ns\": %.3f, \"p50_ns\": %.3f, \"p90_ns\": %.3f, "
+                "\"p99_ns\": %.3f, \"p999_ns\": %.3f, \"max_ns\": %.3f, \"ops_per_sec\": %.3f",
+                r.name_.c_str(), r.unit_.c_str(), r.ops_, r.samples_,
+                r.mean_, r.min_, r.p50_, r.p90_, r.p99_, r.p999_, r.max_, r.ops_per_sec_);
+
+        // Hardware counters per operation, only the available ones
+        fprintf(out, ", \"counters\": {");
+        sep = "";
+        for (int j = 0; j < PERF_COUNT; ++j)
+        {
+            if (r.counters_.valid_[j] == true)
+            {
+                fprintf(out, "%s\"%s\": %.3f", sep, perf_counter_name(j), r.counters_.value_[j]);
+                sep = ", ";
+            }
+        }
+        if ((r.counters_.valid_[PERF_CYCLES] == true) && (r.counters_.valid_[PERF_INSTRUCTIONS] == true))
+        {
+            fprintf(out, "%s\"ipc\": %.3f", sep, bench_ipc(r.counters_));
+        }
+        fprintf(out, "}}%s\n", (i + 1u < results_.size()) ? "," : "");
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
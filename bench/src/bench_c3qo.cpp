@@ -0,0 +1,640 @@
+//
+// @brief Benchmarks of the engine, the buffers and the blocks
+//
+
+// Project headers
+#include "bench/bench.hpp"
+#include "block/codec.hpp"
+#include "block/hello.hpp"
+#include "block/hook_zmq.hpp"
+#include "block/router.hpp"
+#include "block/trans_pb.hpp"
+#include "engine/manager.hpp"
+
+// Generated protobuf command
+#include "conf.pb-c.h"
+
+// C headers
+extern "C"
+{
+#include <sys/eventfd.h>
+#include <unistd.h>
+}
+
+extern char *optarg; // Comes with getopt
+
+#define BENCH_FD_COUNT 1000           // File descriptors registered at once
+#define BENCH_TIMER_COUNT 1000        // Timers armed at once
+#define BENCH_ZMQ_WINDOW 256          // Messages in flight, below the ZMQ high water mark
+#define BENCH_ZMQ_PAYLOAD 64          // Size of a message
+#define BENCH_ROUTER_TOPIC 512        // Routing rules of a router
+#define BENCH_CODEC_BYTES (16u << 20) // Bytes processed by a codec case
+
+//
+// @struct bench_block
+//
+// @brief Block counting the events of the engine
+//
+struct bench_block : block
+{
+    unsigned long count_;
+
+    explicit bench_block(struct manager *mgr) : block(mgr), count_(0u) {}
+
+    virtual void on_timer_(struct timer &) override final
+    {
+        ++count_;
+    }
+
+    virtual void on_fd_(struct file_desc &fd) override final
+    {
+        uint64_t value;
+
+        if (read(fd.fd, &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value)))
+        {
+            ++count_;
+        }
+    }
+};
+
+//
+// @brief Forward data along a chain of blocks
+//
+static void bench_commutation(struct bench &b)
+{
+    struct manager mgr;
+    struct hello_factory factory;
+    struct block *bk;
+    size_t nb_block = 100u;
+
+    mgr.block_factory_register("hello", &factory);
+
+    // Chain: bk_1 -> bk_2 -> ... -> bk_N
+    for (size_t i = 1u; i < nb_block + 1u; ++i)
+    {
+        ASSERT(mgr.block_add(static_cast<int>(i), "hello") == true);
+        ASSERT(mgr.block_start(static_cast<int>(i)) == true);
+    }
+    for (size_t i = 1u; i < nb_block; ++i)
+    {
+        ASSERT(mgr.block_bind(static_cast<int>(i), 0, static_cast<int>(i + 1u)) == true);
+    }
+    bk = mgr.block_get(1);
+
+    // One operation is a data hop from a block to the next one
+    b.run("engine.commutation", "hop", 10000u * (nb_block - 1u), [bk, nb_block](unsigned long ops) {
+        for (unsigned long i = 0u; i < ops / (nb_block - 1u); ++i)
+        {
+            bk->process_data_(nullptr);
+        }
+    });
+
+    mgr.block_clear();
+}
+
+//
+// @brief Build and release messages
+//
+static void bench_buffer(struct bench &b)
+{
+    char topic[16];
+    char payload[256];
+
+    memset(topic, 'T', sizeof(topic));
+    memset(payload, 'P', sizeof(payload));
+
+    b.run("buffer.push_back_clear", "buffer", 100000u, [&topic, &payload](unsigned long ops) {
+        struct buffer buf;
+
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            buf.push_back(topic, sizeof(topic));
+            buf.push_back(payload, sizeof(payload));
+            buf.clear();
+        }
+    });
+}
+
+//
+// @brief Arm many timers and expire them
+//
+static void bench_timer(struct bench &b)
+{
+    struct manager mgr;
+    struct bench_block bk(&mgr);
+
+    b.run("engine.timer_add", "timer", BENCH_TIMER_COUNT, [&mgr, &bk](unsigned long ops) {
+        struct timer tm;
+
+        tm.bk = &bk;
+        tm.arg = nullptr;
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            // Spread the expirations to exercise the ordering
+            tm.tid = static_cast<int>(i);
+            tm.time.tv_sec = 3600 + static_cast<time_t>(i % 7u);
+            tm.time.tv_nsec = static_cast<long>((i * 7919u) % 1000000u);
+            mgr.timer_add(tm);
+        }
+        mgr.timer_clear();
+    });
+
+    b.run("engine.timer_expire", "timer", BENCH_TIMER_COUNT, [&mgr, &bk](unsigned long ops) {
+        struct timer tm;
+
+        tm.bk = &bk;
+        tm.arg = nullptr;
+        tm.time.tv_sec = 0;
+        tm.time.tv_nsec = 0;
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            tm.tid = static_cast<int>(i);
+            mgr.timer_add(tm);
+        }
+        mgr.timer_check_exp();
+    });
+}
+
+//
+// @brief Register, poll and remove many file descriptors
+//
+static void bench_fd(struct bench &b)
+{
+    struct manager mgr;
+    struct bench_block bk(&mgr);
+    std::vector<struct file_desc> fds;
+
+    for (int i = 0; i < BENCH_FD_COUNT; ++i)
+    {
+        struct file_desc fd;
+
+        fd.bk = &bk;
+        fd.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        fd.socket = nullptr;
+        fd.read = true;
+        fd.write = false;
+        if (fd.fd == -1)
+        {
+            LOGGER_ERR("Failed to create event file descriptor: %s [errno=%d]", strerror(errno), errno);
+            break;
+        }
+        fds.push_back(fd);
+    }
+
+    // One operation is the registration then the removal of a file descriptor
+    b.run("engine.fd_add_remove", "fd", fds.size(), [&mgr, &fds](unsigned long) {
+        for (const auto &it : fds)
+        {
+            mgr.fd_add(it);
+        }
+        for (const auto &it : fds)
+        {
+            mgr.fd_remove(it);
+        }
+    });
+
+    // One operation is a poll of every file descriptor with a single one ready
+    for (const auto &it : fds)
+    {
+        mgr.fd_add(it);
+    }
+    b.run("engine.fd_poll", "poll", 10000u, [&mgr, &fds](unsigned long ops) {
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            uint64_t one = 1u;
+
+            if (write(fds[i % fds.size()].fd, &one, sizeof(one)) == static_cast<ssize_t>(sizeof(one)))
+            {
+                mgr.fd_poll();
+            }
+        }
+    });
+
+    for (const auto &it : fds)
+    {
+        mgr.fd_remove(it);
+        close(it.fd);
+    }
+}
+
+//
+// @brief Decode and execute configuration commands
+//
+static void bench_trans_pb(struct bench &b)
+{
+    struct manager mgr;
+    struct hello_factory hello;
+    struct trans_pb_factory factory;
+    struct trans_pb *bk;
+    std::vector<uint8_t> packed;
+    Command cmd;
+    BlockBind bind;
+
+    mgr.block_factory_register("hello", &hello);
+    mgr.block_factory_register("trans_pb", &factory);
+
+    ASSERT(mgr.block_add(1, "hello") == true);
+    ASSERT(mgr.block_add(2, "hello") == true);
+    ASSERT(mgr.block_add(3, "trans_pb") == true);
+    ASSERT(mgr.block_bind(3, 0, 2) == true);
+    bk = static_cast<struct trans_pb *>(mgr.block_get(3));
+
+    // Idempotent command: bind the same blocks again and again
+    command__init(&cmd);
+    block_bind__init(&bind);
+    cmd.type_case = COMMAND__TYPE_BIND;
+    cmd.bind = &bind;
+    cmd.bind->id = 1;
+    cmd.bind->port = 0;
+    cmd.bind->dest = 2;
+
+    packed.resize(command__get_packed_size(&cmd));
+    command__pack(&cmd, packed.data());
+
+    b.run("trans_pb.decode", "command", 100000u, [&packed](unsigned long ops) {
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            Command *unpacked;
+
+            unpacked = command__unpack(nullptr, packed.size(), packed.data());
+            command__free_unpacked(unpacked, nullptr);
+        }
+    });
+
+    b.run("trans_pb.command", "command", 100000u, [bk, &packed](unsigned long ops) {
+        const char *topic = "PROTO.CMD";
+        struct buffer buf;
+
+        buf.push_back(topic, strlen(topic));
+        buf.push_back(packed.data(), packed.size());
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            bk->data_(&buf);
+        }
+        buf.clear();
+    });
+
+    mgr.block_clear();
+}
+
+//
+// @brief Dispatch messages on hundreds of topics
+//
+static void bench_router(struct bench &b)
+{
+    struct manager mgr;
+    struct hello_factory hello;
+    struct router_factory factory;
+    struct router *rt;
+    std::vector<struct router_rule> rules;
+    std::vector<std::string> topics;
+
+    mgr.block_factory_register("hello", &hello);
+    mgr.block_factory_register("router", &factory);
+
+    ASSERT(mgr.block_add(1, "router") == true);
+    ASSERT(mgr.block_add(2, "hello") == true);
+    ASSERT(mgr.block_bind(1, 0, 2) == true);
+    rt = static_cast<struct router *>(mgr.block_get(1));
+
+    // Topics sharing a long prefix, as the ones of an application
+    for (int i = 0; i < BENCH_ROUTER_TOPIC; ++i)
+    {
+        topics.push_back("C3QO.APPLICATION.TOPIC." + std::to_string(i * 7919));
+        rules.push_back({topics.back(), false, 0});
+    }
+    rules.push_back({"C3QO.APPLICATION.", true, 0});
+    ASSERT(rt->rules_set(rules) == true);
+
+    b.run("router.match", "topic", 100000u, [rt, &topics](unsigned long ops) {
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            const std::string &topic = topics[i % topics.size()];
+
+            rt->table_.match(reinterpret_cast<const uint8_t *>(topic.data()), topic.size());
+        }
+    });
+
+    b.run("router.dispatch", "message", 100000u, [rt, &topics](unsigned long ops) {
+        struct buffer buf;
+
+        for (unsigned long i = 0u; i < ops; ++i)
+        {
+            const std::string &topic = topics[i % topics.size()];
+
+            buf.push_back(topic.data(), topic.size());
+            rt->data_(&buf);
+            buf.clear();
+        }
+    });
+
+    mgr.block_clear();
+}
+
+//
+// @brief Compress then restore payloads of representative sizes, with and without dictionary
+//
+static void bench_codec(struct bench &b)
+{
+    const char *path = "/tmp/bench_c3qo.dict";
+    const size_t sizes[] = {64u, 512u, 4096u, 65536u};
+    struct manager mgr;
+    struct codec enc(&mgr);
+    struct codec dec(&mgr);
+    std::string dict;
+    char name[64];
+    FILE *file;
+
+    if (b.selected("codec.") == false)
+    {
+        return;
+    }
+
+    // Messages of an application repeat the same fields
+    for (int seq = 0; dict.size() < 4096u; ++seq)
+    {
+        dict += "{\"sequence\":" + std::to_string(seq * 7919) + ",\"status\":\"running\",\"source\":\"c3qo\"}";
+    }
+    file = fopen(path, "w");
+    ASSERT(file != nullptr);
+    fwrite(dict.data(), 1u, dict.size(), file);
+    fclose(file);
+
+    dec.mode_ = CODEC_DECOMPRESS;
+    enc.min_size_ = 0u;
+
+    for (const char *variant : {"", "_dict"})
+    {
+        ASSERT(enc.dict_load((variant[0] == '\0') ? "" : path) == true);
+        ASSERT(dec.dict_load((variant[0] == '\0') ? "" : path) == true);
+
+        for (size_t size : sizes)
+        {
+            std::string payload;
+            std::string packed;
+            unsigned long count;
+            struct buffer sample;
+
+            for (int seq = 100000; payload.size() < size; ++seq)
+            {
+                payload += "{\"sequence\":" + std::to_string(seq) + ",\"status\":\"running\",\"source\":\"c3qo\"}";
+            }
+            payload.resize(size);
+            count = BENCH_CODEC_BYTES / size;
+
+            snprintf(name, sizeof(name), "codec.compress%s.%zu", variant, size);
+            b.run(name, "message", count, [&enc, &payload](unsigned long ops) {
+                struct buffer buf;
+
+                for (unsigned long i = 0u; i < ops; ++i)
+                {
+                    buf.push_back("TOPIC", strlen("TOPIC"));
+                    buf.push_back(payload.data(), payload.size());
+                    enc.data_(&buf);
+                    buf.clear();
+                }
+            });
+
+            sample.push_back("TOPIC", strlen("TOPIC"));
+            sample.push_back(payload.data(), payload.size());
+            ASSERT(enc.data_(&sample) == true);
+            packed.assign(static_cast<const char *>(sample.parts_[1].data), sample.parts_[1].len);
+            sample.clear();
+
+            snprintf(name, sizeof(name), "codec.decompress%s.%zu", variant, size);
+            b.run(name, "message", count, [&dec, &packed](unsigned long ops) {
+                struct buffer buf;
+
+                for (unsigned long i = 0u; i < ops; ++i)
+                {
+                    buf.push_back("TOPIC", strlen("TOPIC"));
+                    buf.push_back(packed.data(), packed.size());
+                    dec.data_(&buf);
+                    buf.clear();
+                }
+            });
+        }
+    }
+
+    remove(path);
+}
+
+//
+// @brief Exchange messages between two ZMQ hooks of the same manager
+//
+// @param transport : Name of the transport, for the name of the cases
+// @param addr      : Address bound by the server and connected by the client
+//
+static void bench_hook_zmq(struct bench &b, const char *transport, const char *addr)
+{
+    struct manager mgr;
+    struct hello_factory hello;
+    struct hook_zmq_factory factory;
+    struct hook_zmq *server;
+    struct hook_zmq *client;
+    char payload[BENCH_ZMQ_PAYLOAD];
+    char name[64];
+    void *ctx;
+
+    snprintf(name, sizeof(name), "hook_zmq.%s.", transport);
+    if (b.selected(name) == false)
+    {
+        return;
+    }
+
+    mgr.block_factory_register("hello", &hello);
+    mgr.block_factory_register("hook_zmq", &factory);
+
+    // The context is shared for inproc to work
+    ctx = zmq_ctx_new();
+    ASSERT(ctx != nullptr);
+
+    ASSERT(mgr.block_add(1, "hook_zmq") == true);
+    ASSERT(mgr.block_add(2, "hook_zmq") == true);
+    ASSERT(mgr.block_add(3, "hello") == true);
+
+    server = static_cast<struct hook_zmq *>(mgr.block_get(1));
+    server->type_ = ZMQ_PAIR;
+    server->client_ = false;
+    server->addr_ = std::string(addr);
+    server->ctx_ = ctx;
+
+    client = static_cast<struct hook_zmq *>(mgr.block_get(2));
+    client->type_ = ZMQ_PAIR;
+    client->client_ = true;
+    client->addr_ = std::string(addr);
+    client->ctx_ = ctx;
+
+    ASSERT(mgr.block_start(1) == true);
+    ASSERT(mgr.block_start(2) == true);
+    ASSERT(mgr.block_start(3) == true);
+
+    // Do not sleep between messages
+    mgr.fd_spin(1000);
+
+    memset(payload, 'P', sizeof(payload));
+
+    // Throughput: client -> server -> hello, with a window of messages in flight
+    ASSERT(mgr.block_bind(1, 0, 3) == true);
+
+    snprintf(name, sizeof(name), "hook_zmq.%s.throughput", transport);
+    b.run(name, "message", 100000u, [&mgr, server, client, &payload](unsigned long ops) {
+        struct buffer buf;
+        unsigned long base;
+        unsigned long sent;
+
+        buf.push_back(payload, sizeof(payload));
+
+        base = server->rx_pkt_;
+        sent = 0u;
+        while (sent < ops)
+        {
+            for (unsigned long i = 0u; (i < BENCH_ZMQ_WINDOW) && (sent < ops); ++i, ++sent)
+            {
+                client->data_(&buf);
+            }
+            while (server->rx_pkt_ - base < sent)
+            {
+                mgr.fd_poll();
+            }
+        }
+
+        buf.clear();
+    });
+
+    // Latency: client -> server -> client -> hello, one message at a time
+    ASSERT(mgr.block_bind(1, 0, 1) == true);
+    ASSERT(mgr.block_bind(2, 0, 3) == true);
+
+    snprintf(name, sizeof(name), "hook_zmq.%s.roundtrip", transport);
+    {
+        std::vector<double> samples;
+        struct perf_sample counters;
+        struct buffer buf;
+        unsigned long count;
+
+        buf.push_back(payload, sizeof(payload));
+
+        count = static_cast<unsigned long>(b.warmup_ + b.repeat_) * 1000u;
+        for (unsigned long i = 0u; i < count; ++i)
+        {
+            unsigned long begin;
+            unsigned long rx_pkt;
+
+            if (i == static_cast<unsigned long>(b.warmup_) * 1000u)
+            {
+                b.perf_.start();
+            }
+
+            rx_pkt = client->rx_pkt_;
+            begin = bench_now();
+            client->data_(&buf);
+            while (client->rx_pkt_ == rx_pkt)
+            {
+                mgr.fd_poll();
+            }
+            if (i >= static_cast<unsigned long>(b.warmup_) * 1000u)
+            {
+                samples.push_back(static_cast<double>(bench_now() - begin));
+            }
+        }
+
+        b.perf_.stop(counters, samples.size());
+        buf.clear();
+
+        b.record(name, "roundtrip", samples, counters);
+    }
+
+    // Sockets have to be closed before the context is terminated
+    mgr.block_clear();
+    zmq_ctx_term(ctx);
+}
+
+int main(int argc, char **argv)
+{
+    const char *options;
+    const char *output;
+    struct bench b;
+
+    options = "f:ho:pr:w:";
+    output = nullptr;
+    for (int opt = getopt(argc, argv, options); opt != -1; opt = getopt(argc, argv, options))
+    {
+        switch (opt)
+        {
+        case 'f':
+            b.filter_ = std::string(optarg);
+            break;
+
+        case 'h':
+            printf("Usage: %s [-f filter] [-w warmup] [-r repeat] [-o output.json] [-p]\n", argv[0]);
+            return 0;
+
+        case 'o':
+            output = optarg;
+            break;
+
+        case 'p':
+            // Hardware counters are optional: run without them if unavailable
+            if (b.perf_.open() == false)
+            {
+                fprintf(stderr, "No hardware counter available, see perf_event_paranoid\n");
+            }
+            break;
+
+        case 'r':
+            b.repeat_ = atoi(optarg);
+            break;
+
+        case 'w':
+            b.warmup_ = atoi(optarg);
+            break;
+
+        default:
+            return 1;
+        }
+    }
+    if ((b.repeat_ <= 0) || (b.warmup_ < 0))
+    {
+        fprintf(stderr, "Invalid repetitions [warmup=%d ; repeat=%d]\n", b.warmup_, b.repeat_);
+        return 1;
+    }
+
+    LOGGER_OPEN("bench_c3qo");
+    LOGGER_DISABLE();
+
+    bench_commutation(b);
+    bench_buffer(b);
+    bench_timer(b);
+    bench_fd(b);
+    bench_trans_pb(b);
+    bench_router(b);
+    bench_codec(b);
+    bench_hook_zmq(b, "inproc", "inproc://bench_c3qo");
+    bench_hook_zmq(b, "ipc", "ipc:///tmp/bench_c3qo.ipc");
+    bench_hook_zmq(b, "tcp", "tcp://127.0.0.1:16640");
+
+    LOGGER_ENABLE();
+    LOGGER_CLOSE();
+
+    // Report on standard output or in a file
+    if (output == nullptr)
+    {
+        b.report(stdout);
+    }
+    else
+    {
+        FILE *out;
+
+        out = fopen(output, "w");
+        if (out == nullptr)
+        {
+            fprintf(stderr, "Failed to open output: %s [errno=%d ; file=%s]\n", strerror(errno), errno, output);
+            return 1;
+        }
+        b.report(out);
+        fclose(out);
+    }
+
+    return 0;
+}
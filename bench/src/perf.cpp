@@ -0,0 +1,240 @@
+//
+// @brief Hardware performance counters through perf_event_open
+//
+
+// Project headers
+#include "bench/perf.hpp"
+
+// C headers
+extern "C"
+{
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+//
+// @brief Name of a counter, as written in reports
+//
+const char *perf_counter_name(int counter)
+{
+    switch (counter)
+    {
+    case PERF_CYCLES:
+        return "cycles";
+    case PERF_INSTRUCTIONS:
+        return "instructions";
+    case PERF_BRANCH_MISSES:
+        return "branch_misses";
+    case PERF_L1D_MISSES:
+        return "l1d_misses";
+    case PERF_LLC_MISSES:
+        return "llc_misses";
+    case PERF_DTLB_MISSES:
+        return "dtlb_misses";
+    default:
+        return "unknown";
+    }
+}
+
+//
+// @brief Event type and configuration of a counter
+//
+static void perf_counter_event(int counter, struct perf_event_attr &attr)
+{
+    const unsigned long read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    switch (counter)
+    {
+    case PERF_CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_BRANCH_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    case PERF_L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | read_miss;
+        break;
+    case PERF_LLC_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_LL | read_miss;
+        break;
+    case PERF_DTLB_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | read_miss;
+        break;
+    default:
+        break;
+    }
+}
+
+//
+// @brief Open a counter of the calling thread, disabled
+//
+static int perf_counter_open(int counter, bool user_only)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    perf_counter_event(counter, attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = user_only ? 1 : 0;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+perf_sample::perf_sample()
+{
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        valid_[i] = false;
+        value_[i] = 0.0;
+    }
+}
+
+perf_counters::perf_counters() : user_only_(false)
+{
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        fd_[i] = -1;
+    }
+}
+
+perf_counters::~perf_counters()
+{
+    close();
+}
+
+//
+// @brief Open the available counters
+//
+// @return false if no counter is available
+//
+bool perf_counters::open()
+{
+    close();
+
+    // Kernel events are commonly forbidden to unprivileged users
+    user_only_ = false;
+    fd_[PERF_CYCLES] = perf_counter_open(PERF_CYCLES, user_only_);
+    if ((fd_[PERF_CYCLES] == -1) && ((errno == EACCES) || (errno == EPERM)))
+    {
+        user_only_ = true;
+        fd_[PERF_CYCLES] = perf_counter_open(PERF_CYCLES, user_only_);
+    }
+
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        if (i != PERF_CYCLES)
+        {
+            fd_[i] = perf_counter_open(i, user_only_);
+        }
+        if (fd_[i] == -1)
+        {
+            fprintf(stderr, "Counter unavailable: %s [counter=%s ; errno=%d]\n",
+                    strerror(errno), perf_counter_name(i), errno);
+        }
+    }
+
+    return is_open();
+}
+
+//
+// @brief Close the counters
+//
+void perf_counters::close()
+{
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        if (fd_[i] != -1)
+        {
+            ::close(fd_[i]);
+            fd_[i] = -1;
+        }
+    }
+}
+
+//
+// @brief Verify if at least one counter is available
+//
+bool perf_counters::is_open() const
+{
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        if (fd_[i] != -1)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//
+// @brief Reset and enable the counters
+//
+void perf_counters::start()
+{
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        if (fd_[i] != -1)
+        {
+            ioctl(fd_[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+//
+// @brief Disable the counters and read them
+//
+// @param sample : Values per operation, scaled if the counters were multiplexed
+// @param ops    : Number of operations done since the start
+//
+void perf_counters::stop(struct perf_sample &sample, unsigned long ops)
+{
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        if (fd_[i] != -1)
+        {
+            ioctl(fd_[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (int i = 0; i < PERF_COUNT; ++i)
+    {
+        uint64_t value[3]; // Value, time enabled, time running
+
+        sample.valid_[i] = false;
+        sample.value_[i] = 0.0;
+
+        if ((fd_[i] == -1) || (ops == 0u))
+        {
+            continue;
+        }
+        if (read(fd_[i], value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+        {
+            continue;
+        }
+        if (value[2] == 0u)
+        {
+            // Never scheduled on the hardware
+            continue;
+        }
+
+        sample.valid_[i] = true;
+        sample.value_[i] = static_cast<double>(value[0]) * static_cast<double>(value[1]) /
+                           static_cast<double>(value[2]) / static_cast<double>(ops);
+    }
+}
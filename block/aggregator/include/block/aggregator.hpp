@@ -0,0 +1,84 @@
+#ifndef AGGREGATOR_HPP
+#define AGGREGATOR_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+//
+// A batch is a buffer with a single part, made of little-endian words:
+//   - number of messages (uint32_t)
+//   - for each message: number of parts (uint32_t)
+//   - for each part: length (uint32_t), data
+//
+
+//
+// @struct aggregator
+//
+// @brief Pack small messages into one batch, sent when it is big enough
+//        or when its oldest message has waited long enough
+//
+struct aggregator : block
+{
+    size_t max_bytes_; // Size of a batch triggering a flush, 0 for no limit
+    size_t max_count_; // Messages of a batch triggering a flush, 0 for no limit
+    long latency_us_;  // Longest wait of a message before a flush, 0 for no deadline
+    bool is_armed_;    // Deadline timer is running, its identifier is the block identifier
+
+    std::vector<uint8_t> batch_; // Batch being filled, with its header
+    size_t count_;               // Messages in the batch
+    uint64_t batch_deadline_ns_; // Latest deadline of the messages of the batch, 0 if one has none
+
+    unsigned long batch_tx_;       // Batches sent
+    unsigned long flush_size_;     // Flushes on size or count
+    unsigned long flush_deadline_; // Flushes on deadline
+
+    void timer_stop();
+    void flush();
+
+    //
+    // Implementation of the block interface
+    //
+    explicit aggregator(struct manager *mgr);
+    virtual ~aggregator() override final;
+
+    virtual void stop_() override final;
+
+    virtual bool data_(void *vdata) override final;
+
+    virtual void on_timer_(struct timer &tm) override final;
+};
+
+//
+// @struct deaggregator
+//
+// @brief Unpack the batches of an aggregator and forward each message
+//
+struct deaggregator : block
+{
+    unsigned long batch_rx_; // Batches received
+    unsigned long error_;    // Malformed batches
+
+    bool unpack(const uint8_t *data, size_t len, uint64_t deadline_ns);
+
+    //
+    // Implementation of the block interface
+    //
+    explicit deaggregator(struct manager *mgr);
+    virtual ~deaggregator() override final;
+
+    virtual bool data_(void *vdata) override final;
+};
+
+struct aggregator_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+struct deaggregator_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+#endif // AGGREGATOR_HPP
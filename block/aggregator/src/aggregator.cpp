@@ -0,0 +1,298 @@
+// Project headers
+#include "block/aggregator.hpp"
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+
+#define AGGREGATOR_MAX_BYTES (64u * 1024u) // Default size of a batch
+#define AGGREGATOR_MAX_COUNT 256u          // Default messages of a batch
+#define AGGREGATOR_LATENCY_US 1000l        // Default wait of a message
+
+#define AGGREGATOR_HEADER 4u // Size of a word of the batch
+
+//
+// @brief Append a word to a batch
+//
+static void aggregator_put(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 24));
+}
+
+//
+// @brief Write a word at a given offset of a batch
+//
+static void aggregator_set(std::vector<uint8_t> &out, size_t offset, uint32_t value)
+{
+    out[offset] = static_cast<uint8_t>(value);
+    out[offset + 1u] = static_cast<uint8_t>(value >> 8);
+    out[offset + 2u] = static_cast<uint8_t>(value >> 16);
+    out[offset + 3u] = static_cast<uint8_t>(value >> 24);
+}
+
+//
+// @brief Read a word of a batch
+//
+// @return false if the batch is too short
+//
+static bool aggregator_get(const uint8_t *data, size_t len, size_t &offset, uint32_t &value)
+{
+    if (len - offset < AGGREGATOR_HEADER)
+    {
+        return false;
+    }
+
+    value = static_cast<uint32_t>(data[offset]) |
+            (static_cast<uint32_t>(data[offset + 1u]) << 8) |
+            (static_cast<uint32_t>(data[offset + 2u]) << 16) |
+            (static_cast<uint32_t>(data[offset + 3u]) << 24);
+    offset += AGGREGATOR_HEADER;
+
+    return true;
+}
+
+aggregator::aggregator(struct manager *mgr) : block(mgr),
+                                              max_bytes_(AGGREGATOR_MAX_BYTES),
+                                              max_count_(AGGREGATOR_MAX_COUNT),
+                                              latency_us_(AGGREGATOR_LATENCY_US),
+                                              is_armed_(false),
+                                              count_(0u),
+                                              batch_deadline_ns_(0u),
+                                              batch_tx_(0u),
+                                              flush_size_(0u),
+                                              flush_deadline_(0u)
+{
+    batch_.resize(AGGREGATOR_HEADER, 0u);
+}
+aggregator::~aggregator()
+{
+    // Pending messages are lost, but the deadline must not fire on a deleted block.
+    // A replacement block shares the timer identifier: only the timers of this block are removed
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+}
+
+//
+// @brief Cancel the deadline of the batch
+//
+void aggregator::timer_stop()
+{
+    struct timer tm;
+
+    if (is_armed_ == false)
+    {
+        return;
+    }
+
+    tm.bk = this;
+    tm.tid = id_;
+    mgr_->timer_del(tm);
+    is_armed_ = false;
+}
+
+//
+// @brief Send the batch being filled, if any
+//
+void aggregator::flush()
+{
+    struct buffer buf;
+
+    timer_stop();
+    if (count_ == 0u)
+    {
+        return;
+    }
+
+    aggregator_set(batch_, 0u, static_cast<uint32_t>(count_));
+    buf.push_back(batch_.data(), batch_.size());
+    buf.deadline_ns_ = batch_deadline_ns_;
+
+    LOGGER_DEBUG("Flush batch [bk_id=%d ; count=%zu ; size=%zu]", id_, count_, batch_.size());
+
+    // The batch is ready for new messages before the data flow goes on
+    batch_.resize(AGGREGATOR_HEADER);
+    count_ = 0u;
+    ++batch_tx_;
+
+    process_data_(&buf);
+    buf.clear();
+}
+
+//
+// Implementation of the block interface
+//
+
+//
+// @brief Messages of a stopped block are not kept waiting
+//
+void aggregator::stop_()
+{
+    flush();
+}
+
+bool aggregator::data_(void *vdata)
+{
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to aggregate data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    const struct buffer &buf = *(static_cast<const struct buffer *>(vdata));
+
+    // The batch is stale once all of its messages are
+    if (count_ == 0u)
+    {
+        batch_deadline_ns_ = buf.deadline_ns_;
+    }
+    else if ((buf.deadline_ns_ == 0u) || (batch_deadline_ns_ == 0u))
+    {
+        batch_deadline_ns_ = 0u;
+    }
+    else if (buf.deadline_ns_ > batch_deadline_ns_)
+    {
+        batch_deadline_ns_ = buf.deadline_ns_;
+    }
+
+    aggregator_put(batch_, static_cast<uint32_t>(buf.parts_.size()));
+    for (const auto &part : buf.parts_)
+    {
+        aggregator_put(batch_, static_cast<uint32_t>(part.len));
+        batch_.insert(batch_.end(), static_cast<const uint8_t *>(part.data),
+                      static_cast<const uint8_t *>(part.data) + part.len);
+    }
+    ++count_;
+
+    if (((max_bytes_ != 0u) && (batch_.size() >= max_bytes_)) ||
+        ((max_count_ != 0u) && (count_ >= max_count_)))
+    {
+        ++flush_size_;
+        flush();
+    }
+    else if ((count_ == 1u) && (latency_us_ > 0))
+    {
+        struct timer tm;
+
+        // Deadline of the first message of the batch
+        tm.bk = this;
+        tm.arg = nullptr;
+        tm.tid = id_;
+        tm.time.tv_sec = latency_us_ / 1000000;
+        tm.time.tv_nsec = (latency_us_ % 1000000) * 1000;
+        is_armed_ = mgr_->timer_add(tm);
+    }
+
+    return false;
+}
+
+void aggregator::on_timer_(struct timer &)
+{
+    is_armed_ = false;
+    if (count_ != 0u)
+    {
+        ++flush_deadline_;
+        flush();
+    }
+}
+
+deaggregator::deaggregator(struct manager *mgr) : block(mgr),
+                                                  batch_rx_(0u),
+                                                  error_(0u)
+{
+}
+deaggregator::~deaggregator() {}
+
+//
+// @brief Forward every message of a batch
+//
+// @param deadline_ns : Deadline of the batch, given to its messages
+//
+// @return false if the batch is malformed, messages before the error are forwarded
+//
+bool deaggregator::unpack(const uint8_t *data, size_t len, uint64_t deadline_ns)
+{
+    struct buffer buf;
+    size_t offset;
+    uint32_t count;
+
+    offset = 0u;
+    if (aggregator_get(data, len, offset, count) == false)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0u; i < count; ++i)
+    {
+        uint32_t parts;
+
+        if (aggregator_get(data, len, offset, parts) == false)
+        {
+            return false;
+        }
+        for (uint32_t j = 0u; j < parts; ++j)
+        {
+            uint32_t part_len;
+
+            if ((aggregator_get(data, len, offset, part_len) == false) || (len - offset < part_len))
+            {
+                buf.clear();
+                return false;
+            }
+            buf.push_back(&data[offset], part_len);
+            offset += part_len;
+        }
+
+        buf.deadline_ns_ = deadline_ns;
+        process_data_(&buf);
+        buf.clear();
+    }
+
+    return (offset == len);
+}
+
+bool deaggregator::data_(void *vdata)
+{
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to unpack data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    const struct buffer &buf = *(static_cast<const struct buffer *>(vdata));
+
+    for (const auto &part : buf.parts_)
+    {
+        ++batch_rx_;
+        if (unpack(static_cast<const uint8_t *>(part.data), part.len, buf.deadline_ns_) == false)
+        {
+            LOGGER_ERR("Failed to unpack batch: malformed batch [bk_id=%d ; size=%zu]", id_, part.len);
+            ++error_;
+        }
+    }
+
+    return false;
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *aggregator_factory::constructor(struct manager *mgr)
+{
+    return new struct aggregator(mgr);
+}
+
+void aggregator_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct aggregator *>(bk);
+}
+
+struct block *deaggregator_factory::constructor(struct manager *mgr)
+{
+    return new struct deaggregator(mgr);
+}
+
+void deaggregator_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct deaggregator *>(bk);
+}
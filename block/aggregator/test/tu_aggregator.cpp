@@ -0,0 +1,247 @@
+//
+// @brief Test file for the aggregator and deaggregator blocks
+//
+
+// Project headers
+#include "block/aggregator.hpp"
+#include "engine/tu.hpp"
+
+//
+// @brief Keep a copy of the messages received
+//
+struct block_capture : block
+{
+    std::vector<std::vector<std::string>> msg_;
+    std::vector<uint64_t> deadline_ns_;
+
+    explicit block_capture(struct manager *mgr) : block(mgr) {}
+
+    virtual bool data_(void *vdata) override final
+    {
+        const struct buffer &buf = *(static_cast<const struct buffer *>(vdata));
+        std::vector<std::string> msg;
+
+        for (const auto &part : buf.parts_)
+        {
+            msg.push_back(std::string(static_cast<const char *>(part.data), part.len));
+        }
+        msg_.push_back(msg);
+        deadline_ns_.push_back(buf.deadline_ns_);
+
+        return false;
+    }
+};
+
+struct manager mgr_;
+
+//
+// @brief Send a message made of a topic and a payload
+//
+static void tu_aggregator_send(struct block *bk, const std::string &topic, const std::string &payload)
+{
+    struct buffer buf;
+
+    buf.push_back(topic.data(), topic.size());
+    buf.push_back(payload.data(), payload.size());
+    ASSERT(bk->data_(&buf) == false);
+    buf.clear();
+}
+
+//
+// @brief Forward the batches of a capture block to a deaggregator
+//
+static void tu_aggregator_unpack(struct block_capture &batches, struct deaggregator &deagg)
+{
+    for (const auto &msg : batches.msg_)
+    {
+        struct buffer buf;
+
+        for (const auto &part : msg)
+        {
+            buf.push_back(part.data(), part.size());
+        }
+        ASSERT(deagg.data_(&buf) == false);
+        buf.clear();
+    }
+}
+
+//
+// @brief Flush on count and size, messages are unpacked unchanged
+//
+static void tu_aggregator_threshold()
+{
+    struct aggregator agg(&mgr_);
+    struct deaggregator deagg(&mgr_);
+    struct block_capture batches(&mgr_);
+    struct block_capture msgs(&mgr_);
+
+    agg.sink_ = &batches;
+    agg.latency_us_ = 0;
+    deagg.sink_ = &msgs;
+
+    // Count
+    agg.max_count_ = 3u;
+    for (int i = 0; i < 7; ++i)
+    {
+        tu_aggregator_send(&agg, "topic", "payload-" + std::to_string(i));
+    }
+    ASSERT(batches.msg_.size() == 2u);
+    ASSERT(batches.msg_[0].size() == 1u);
+    ASSERT(agg.count_ == 1u);
+    ASSERT(agg.flush_size_ == 2u);
+
+    // Size: one big message is sent at once
+    agg.max_count_ = 0u;
+    agg.max_bytes_ = 100u;
+    tu_aggregator_send(&agg, "topic", std::string(200u, 'x'));
+    ASSERT(batches.msg_.size() == 3u);
+    ASSERT(agg.count_ == 0u);
+    ASSERT(agg.batch_tx_ == 3u);
+
+    tu_aggregator_unpack(batches, deagg);
+    ASSERT(deagg.batch_rx_ == 3u);
+    ASSERT(deagg.error_ == 0u);
+    ASSERT(msgs.msg_.size() == 8u);
+    for (int i = 0; i < 7; ++i)
+    {
+        ASSERT(msgs.msg_[static_cast<size_t>(i)].size() == 2u);
+        ASSERT(msgs.msg_[static_cast<size_t>(i)][0] == "topic");
+        ASSERT(msgs.msg_[static_cast<size_t>(i)][1] == "payload-" + std::to_string(i));
+    }
+    ASSERT(msgs.msg_[7][1] == std::string(200u, 'x'));
+
+    // Stop sends the pending messages
+    tu_aggregator_send(&agg, "topic", "");
+    agg.stop_();
+    ASSERT(batches.msg_.size() == 4u);
+    agg.stop_();
+    ASSERT(batches.msg_.size() == 4u);
+}
+
+//
+// @brief Flush on deadline
+//
+static void tu_aggregator_deadline()
+{
+    struct aggregator agg(&mgr_);
+    struct block_capture batches(&mgr_);
+
+    agg.id_ = 1;
+    agg.sink_ = &batches;
+    agg.latency_us_ = 1000;
+
+    tu_aggregator_send(&agg, "topic", "payload");
+    tu_aggregator_send(&agg, "topic", "payload");
+    ASSERT(agg.is_armed_ == true);
+    ASSERT(batches.msg_.empty() == true);
+
+    usleep(2 * 1000);
+    mgr_.timer_check_exp();
+    ASSERT(batches.msg_.size() == 1u);
+    ASSERT(agg.is_armed_ == false);
+    ASSERT(agg.flush_deadline_ == 1u);
+
+    // Flush on count cancels the deadline
+    agg.max_count_ = 2u;
+    tu_aggregator_send(&agg, "topic", "payload");
+    ASSERT(agg.is_armed_ == true);
+    tu_aggregator_send(&agg, "topic", "payload");
+    ASSERT(agg.is_armed_ == false);
+    ASSERT(mgr_.tm_list_.empty() == true);
+    ASSERT(batches.msg_.size() == 2u);
+
+    // Deleted block with a pending deadline
+    tu_aggregator_send(&agg, "topic", "payload");
+    ASSERT(mgr_.tm_list_.empty() == false);
+}
+
+//
+// @brief A batch is stale once all of its messages are, its messages keep its deadline
+//
+static void tu_aggregator_expiry()
+{
+    struct aggregator agg(&mgr_);
+    struct deaggregator deagg(&mgr_);
+    struct block_capture batches(&mgr_);
+    struct block_capture msgs(&mgr_);
+    struct buffer buf;
+
+    agg.sink_ = &batches;
+    agg.latency_us_ = 0;
+    agg.max_count_ = 2u;
+    deagg.sink_ = &msgs;
+
+    // Latest deadline
+    buf.push_back("topic", strlen("topic"));
+    buf.deadline_set(1000000);
+    ASSERT(agg.data_(&buf) == false);
+    buf.deadline_set(2000000);
+    ASSERT(agg.data_(&buf) == false);
+    ASSERT(batches.deadline_ns_.size() == 1u);
+    ASSERT(batches.deadline_ns_[0] == buf.deadline_ns_);
+
+    // Message without deadline
+    ASSERT(agg.data_(&buf) == false);
+    buf.deadline_set(0);
+    ASSERT(agg.data_(&buf) == false);
+    ASSERT(batches.deadline_ns_.size() == 2u);
+    ASSERT(batches.deadline_ns_[1] == 0u);
+    buf.clear();
+
+    // Unpacked messages
+    buf.push_back(batches.msg_[0][0].data(), batches.msg_[0][0].size());
+    buf.deadline_ns_ = batches.deadline_ns_[0];
+    ASSERT(deagg.data_(&buf) == false);
+    ASSERT(msgs.deadline_ns_.size() == 2u);
+    ASSERT(msgs.deadline_ns_[0] == batches.deadline_ns_[0]);
+    ASSERT(msgs.deadline_ns_[1] == batches.deadline_ns_[0]);
+    buf.clear();
+}
+
+static void tu_aggregator_errors()
+{
+    struct aggregator agg(&mgr_);
+    struct deaggregator deagg(&mgr_);
+    struct block_capture msgs(&mgr_);
+    struct buffer buf;
+    const uint8_t truncated[] = {2u, 0u, 0u, 0u, 1u, 0u, 0u, 0u, 1u, 0u, 0u, 0u, 'a', 1u, 0u, 0u, 0u, 8u};
+    const uint8_t trailing[] = {0u, 0u, 0u, 0u, 0u};
+
+    deagg.sink_ = &msgs;
+
+    ASSERT(agg.data_(nullptr) == false);
+    ASSERT(deagg.data_(nullptr) == false);
+
+    // Too short
+    buf.push_back("ab", 2u);
+    ASSERT(deagg.data_(&buf) == false);
+    ASSERT(deagg.error_ == 1u);
+    buf.clear();
+
+    // Second message is truncated: the first one is forwarded
+    buf.push_back(truncated, sizeof(truncated));
+    ASSERT(deagg.data_(&buf) == false);
+    ASSERT(deagg.error_ == 2u);
+    ASSERT(msgs.msg_.size() == 1u);
+    ASSERT(msgs.msg_[0][0] == "a");
+    buf.clear();
+
+    buf.push_back(trailing, sizeof(trailing));
+    ASSERT(deagg.data_(&buf) == false);
+    ASSERT(deagg.error_ == 3u);
+    buf.clear();
+}
+
+int main(int, char **)
+{
+    LOGGER_OPEN("tu_aggregator");
+
+    tu_aggregator_threshold();
+    tu_aggregator_deadline();
+    tu_aggregator_expiry();
+    ASSERT(mgr_.tm_list_.empty() == true);
+    tu_aggregator_errors();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef BALANCER_HPP
+#define BALANCER_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+//
+// @enum balancer_policy
+//
+enum balancer_policy
+{
+    BALANCER_ROUND_ROBIN = 0,      // Each sink in turn
+    BALANCER_HASH = 1,             // Consistent hashing of a part of the buffer
+    BALANCER_LEAST_OUTSTANDING = 2 // Sink with the fewest buffers not processed yet: queued or held
+};
+
+//
+// @struct balancer_sink
+//
+// @brief Sink bound on a port: a block, or the edge of a port bound with a queue.
+//        Blocks of another manager are bound with a queue
+//
+struct balancer_sink
+{
+    struct block *bk; // Sink, nullptr if none
+    struct edge *eg;  // Queue of the binding, nullptr if none
+    unsigned long tx; // Buffers sent
+};
+
+//
+// @struct balancer_point
+//
+// @brief Point of a sink on the consistent hashing ring
+//
+struct balancer_point
+{
+    uint64_t hash; // Position on the ring
+    int port;      // Port of the sink
+};
+
+//
+// @struct balancer
+//
+// @brief Distribute buffers across the sinks bound on its ports
+//
+struct balancer : block
+{
+    enum balancer_policy policy_; // Distribution policy
+    size_t hash_part_;            // Part of the buffer to hash, for example the ZMQ identity
+    size_t replicas_;             // Points of each sink on the ring
+
+    std::vector<struct balancer_sink> port_;  // Sinks, by port
+    std::vector<int> active_;                 // Ports bound to a sink
+    std::vector<struct balancer_point> ring_; // Consistent hashing ring, sorted by hash
+    size_t next_;                             // Next sink for the round-robin
+    unsigned long drop_;                      // Buffers without sink
+
+    void ring_build();
+    unsigned long outstanding(const struct balancer_sink &sink) const;
+    int pick(const struct buffer &buf);
+
+    //
+    // Implementation of the block interface
+    //
+    explicit balancer(struct manager *mgr);
+    virtual ~balancer() override final;
+
+    virtual void bind_(int port, struct block *bk) override final;
+
+    virtual bool data_(void *vdata) override final;
+};
+
+struct balancer_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+#endif // BALANCER_HPP
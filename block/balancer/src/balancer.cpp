@@ -0,0 +1,193 @@
+// Project headers
+#include "block/balancer.hpp"
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+
+// C++ headers
+#include <algorithm>
+
+#define BALANCER_REPLICAS 64u // Default points of each sink on the ring
+
+balancer::balancer(struct manager *mgr) : block(mgr),
+                                          policy_(BALANCER_ROUND_ROBIN),
+                                          hash_part_(0u),
+                                          replicas_(BALANCER_REPLICAS),
+                                          next_(0u),
+                                          drop_(0u)
+{
+}
+balancer::~balancer() {}
+
+//
+// @brief Compute the sinks in use and their points on the ring
+//
+// Each sink owns replicas_ points: adding or removing a sink only moves the
+// keys of the neighbouring points
+//
+void balancer::ring_build()
+{
+    active_.clear();
+    ring_.clear();
+
+    for (size_t port = 0u; port < port_.size(); ++port)
+    {
+        if (port_[port].bk == nullptr)
+        {
+            continue;
+        }
+
+        active_.push_back(static_cast<int>(port));
+        for (size_t i = 0u; i < replicas_; ++i)
+        {
+            ring_.push_back({buffer_mix((static_cast<uint64_t>(port) << 32) | i), static_cast<int>(port)});
+        }
+    }
+
+    std::sort(ring_.begin(), ring_.end(), [](const struct balancer_point &a, const struct balancer_point &b) {
+        return a.hash < b.hash;
+    });
+}
+
+//
+// @brief Buffers sent to a sink and not processed yet
+//
+// Data still queued for the sink, or held by the sink if it has flow control.
+// A sink called directly is done with the buffer once the call returns
+//
+unsigned long balancer::outstanding(const struct balancer_sink &sink) const
+{
+    if (sink.eg != nullptr)
+    {
+        return sink.eg->ring_.size();
+    }
+    if (sink.bk->credit_max_ > sink.bk->credit_)
+    {
+        return static_cast<unsigned long>(sink.bk->credit_max_ - sink.bk->credit_);
+    }
+    return 0u;
+}
+
+//
+// @brief Choose the port of a buffer
+//
+// @return Port, -1 if no sink is bound
+//
+int balancer::pick(const struct buffer &buf)
+{
+    unsigned long best_count;
+    size_t count;
+    size_t best;
+
+    count = active_.size();
+    if (count == 0u)
+    {
+        return -1;
+    }
+
+    switch (policy_)
+    {
+    case BALANCER_HASH:
+        if (buf.parts_.size() > hash_part_)
+        {
+            uint64_t hash;
+
+            hash = buffer_hash(buf.parts_[hash_part_].data, buf.parts_[hash_part_].len);
+
+            const auto &it = std::lower_bound(ring_.cbegin(), ring_.cend(), hash,
+                                              [](const struct balancer_point &point, uint64_t value) {
+                                                  return point.hash < value;
+                                              });
+            return (it == ring_.cend()) ? ring_.front().port : it->port;
+        }
+
+        // Nothing to hash: spread the buffers anyway
+        LOGGER_DEBUG("No part to hash [bk_id=%d ; hash_part=%zu ; parts_count=%zu]", id_, hash_part_, buf.parts_.size());
+        return active_[next_++ % count];
+
+    case BALANCER_LEAST_OUTSTANDING:
+        // Ties are broken in turn
+        best = next_++ % count;
+        best_count = outstanding(port_[static_cast<size_t>(active_[best])]);
+        for (size_t i = 1u; (i < count) && (best_count != 0u); ++i)
+        {
+            size_t candidate = (best + i) % count;
+            unsigned long candidate_count = outstanding(port_[static_cast<size_t>(active_[candidate])]);
+
+            if (candidate_count < best_count)
+            {
+                best = candidate;
+                best_count = candidate_count;
+            }
+        }
+        return active_[best];
+
+    case BALANCER_ROUND_ROBIN:
+    default:
+        return active_[next_++ % count];
+    }
+}
+
+//
+// Implementation of the block interface
+//
+
+void balancer::bind_(int port, struct block *bk)
+{
+    if (port < 0)
+    {
+        LOGGER_ERR("Failed to bind balancer: wrong port [bk_id=%d ; port=%d]", id_, port);
+        return;
+    }
+
+    if (static_cast<size_t>(port) >= port_.size())
+    {
+        port_.resize(static_cast<size_t>(port) + 1u, {nullptr, nullptr, 0u});
+    }
+    port_[static_cast<size_t>(port)].bk = bk;
+
+    // The manager gives the block the edge of a port bound with a queue, before binding it
+    const auto &eg = edge_.find(port);
+    port_[static_cast<size_t>(port)].eg = ((eg != edge_.cend()) && (eg->second == bk)) ? eg->second : nullptr;
+    ring_build();
+}
+
+bool balancer::data_(void *vdata)
+{
+    int port;
+
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to balance data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    struct buffer &buf = *(static_cast<struct buffer *>(vdata));
+
+    port = pick(buf);
+    if (port < 0)
+    {
+        LOGGER_DEBUG("Drop buffer: no sink bound [bk_id=%d]", id_);
+        ++drop_;
+        return false;
+    }
+
+    struct balancer_sink &sink = port_[static_cast<size_t>(port)];
+    ++sink.tx;
+    process_data_(sink.bk, vdata);
+
+    return false;
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *balancer_factory::constructor(struct manager *mgr)
+{
+    return new struct balancer(mgr);
+}
+
+void balancer_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct balancer *>(bk);
+}
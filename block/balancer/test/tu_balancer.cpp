@@ -0,0 +1,204 @@
+//
+// @brief Test file for the balancer block
+//
+
+// Project headers
+#include "block/balancer.hpp"
+#include "block/hello.hpp"
+#include "engine/tu.hpp"
+
+struct manager mgr_;
+
+static void tu_balancer_round_robin()
+{
+    struct balancer *bl;
+
+    bl = static_cast<struct balancer *>(tu_block_add(mgr_, 10, "balancer", 3));
+    ASSERT(bl->active_.size() == 3u);
+
+    for (int i = 0; i < 300; ++i)
+    {
+        tu_block_send(bl, {"key"});
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT(bl->port_[static_cast<size_t>(i)].tx == 100u);
+        ASSERT(tu_block_count(mgr_, 11 + i) == 100u);
+    }
+
+    mgr_.block_clear();
+}
+
+static void tu_balancer_hash()
+{
+    struct balancer *bl_3;
+    struct balancer *bl_4;
+    struct buffer buf;
+    int count[4] = {0, 0, 0, 0};
+
+    bl_3 = static_cast<struct balancer *>(tu_block_add(mgr_, 10, "balancer", 3));
+    bl_3->policy_ = BALANCER_HASH;
+    bl_4 = static_cast<struct balancer *>(tu_block_add(mgr_, 20, "balancer", 4));
+    bl_4->policy_ = BALANCER_HASH;
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        std::string key = "identity-" + std::to_string(i);
+        int port_3;
+        int port_4;
+
+        buf.push_back(key.data(), key.size());
+        port_3 = bl_3->pick(buf);
+        port_4 = bl_4->pick(buf);
+        buf.clear();
+
+        // Same key, same sink
+        buf.push_back(key.data(), key.size());
+        ASSERT(bl_3->pick(buf) == port_3);
+        buf.clear();
+
+        // Adding a sink only moves keys to this sink
+        ASSERT((port_4 == port_3) || (port_4 == 3));
+
+        ++count[port_4];
+    }
+
+    // Keys are spread across the sinks
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT(count[i] > 3000 / 4 / 2);
+        ASSERT(count[i] < 3000 / 4 * 2);
+    }
+
+    // Part to hash is missing: round-robin
+    bl_3->hash_part_ = 1u;
+    buf.push_back("key", strlen("key"));
+    ASSERT(bl_3->pick(buf) != bl_3->pick(buf));
+    buf.clear();
+
+    mgr_.block_clear();
+}
+
+static void tu_balancer_least_outstanding()
+{
+    struct balancer *bl;
+    struct bind_opt opt;
+
+    bl = static_cast<struct balancer *>(tu_block_add(mgr_, 10, "balancer", 3));
+    bl->policy_ = BALANCER_LEAST_OUTSTANDING;
+
+    // Sinks called directly are done once the call returns: buffers go in turn
+    for (int i = 0; i < 6; ++i)
+    {
+        tu_block_send(bl, {"key"});
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT(bl->port_[static_cast<size_t>(i)].tx == 2u);
+    }
+
+    // Buffers queued for a sink are outstanding until delivered
+    opt.queue = 8u;
+    ASSERT(mgr_.block_bind(10, 0, 11, opt) == true);
+    ASSERT(mgr_.block_bind(10, 2, 13, opt) == true);
+    ASSERT(bl->port_[0].eg != nullptr);
+    ASSERT(bl->port_[1].eg == nullptr);
+    for (int i = 0; i < 6; ++i)
+    {
+        tu_block_send(bl, {"key"});
+    }
+    ASSERT(bl->port_[0].tx == 3u);
+    ASSERT(bl->port_[1].tx == 6u);
+    ASSERT(bl->port_[2].tx == 3u);
+    ASSERT(bl->outstanding(bl->port_[0]) == 1u);
+    ASSERT(bl->outstanding(bl->port_[1]) == 0u);
+
+    for (int i = 0; (i < 100) && (mgr_.qu_ready_.pending_.load() != 0u); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(bl->outstanding(bl->port_[0]) == 0u);
+    ASSERT(tu_block_count(mgr_, 11) == 3u);
+
+    mgr_.block_clear();
+    mgr_.queue_clear();
+}
+
+//
+// @brief Buffers queued for the block of another manager
+//
+static void tu_balancer_shard()
+{
+    struct manager shard;
+    struct hello_factory hello_f;
+    struct bind_opt opt;
+    struct balancer *bl;
+    struct hello *bk;
+
+    shard.block_factory_register("hello", &hello_f);
+    ASSERT(shard.block_add(1, "hello") == true);
+    bk = static_cast<struct hello *>(shard.block_get(1));
+
+    bl = static_cast<struct balancer *>(tu_block_add(mgr_, 10, "balancer", 1));
+
+    // Queues of the shard are not started
+    opt.mgr = &shard;
+    opt.queue = 4u;
+    ASSERT(mgr_.block_bind(10, 1, 1, opt) == false);
+    ASSERT(bl->active_.size() == 1u);
+
+    ASSERT(shard.queue_start() == true);
+    ASSERT(mgr_.block_bind(10, 1, 1, opt) == true);
+    ASSERT(bl->active_.size() == 2u);
+    ASSERT(bl->binds_.at(1) == 1);
+    tu_block_send(bl, {"key"});
+    tu_block_send(bl, {"key"});
+    ASSERT(bl->port_[1].tx == 1u);
+    for (int i = 0; (i < 100) && (bk->count_ == 0); ++i)
+    {
+        shard.fd_poll();
+    }
+    ASSERT(bk->count_ == 1);
+
+    mgr_.block_clear();
+    shard.block_clear();
+    shard.queue_clear();
+}
+
+static void tu_balancer_errors()
+{
+    struct balancer *bl;
+
+    bl = static_cast<struct balancer *>(tu_block_add(mgr_, 10, "balancer", 0));
+
+    // No sink
+    tu_block_send(bl, {"key"});
+    ASSERT(bl->drop_ == 1u);
+
+    ASSERT(bl->data_(nullptr) == false);
+    bl->bind_(-1, nullptr);
+
+    mgr_.block_clear();
+}
+
+int main(int, char **)
+{
+    struct balancer_factory balancer_f;
+    struct hello_factory hello_f;
+
+    LOGGER_OPEN("tu_balancer");
+
+    mgr_.block_factory_register("balancer", &balancer_f);
+    mgr_.block_factory_register("hello", &hello_f);
+
+    tu_balancer_round_robin();
+    tu_balancer_hash();
+    tu_balancer_least_outstanding();
+    tu_balancer_shard();
+    tu_balancer_errors();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -0,0 +1,134 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+#define CACHE_NIL 0xffffffffu // No entry
+
+//
+// The key of a message is made of its parts selected by a mask, each one
+// preceded by its length: requests and replies select the parts holding the
+// same identifier, the topic by default
+//
+
+//
+// @struct cache_entry
+//
+// @brief Reply to a request, linked in the order of use and in the order of expiry
+//
+struct cache_entry
+{
+    std::string key;                // Key of the request
+    std::vector<std::string> reply; // Parts of the reply
+    uint64_t hash;                  // Hash of the key
+    uint64_t expiry;                // Expiration date, in monotonic nanoseconds
+    size_t bytes;                   // Memory accounted for the entry
+    uint32_t lru_prev;              // Entry used before
+    uint32_t lru_next;              // Entry used after
+    uint32_t age_prev;              // Entry expiring before, an entry without expiry is not listed
+    uint32_t age_next;              // Entry expiring after
+};
+
+//
+// @struct cache
+//
+// @brief Serve the replies of identical requests from memory.
+//
+// Requests missing the cache are sent on port 0, cached replies on port 1.
+// Replies are stored by a cache_return block bound to the cache. Entries are
+// evicted in LRU order above the memory budget, and removed once expired by
+// a single timer armed on the entry expiring first
+//
+struct cache : block
+{
+    uint32_t key_mask_; // Parts of a request forming its key, bit i for part i
+    long ttl_ms_;       // Lifetime of an entry, 0 for no expiry. A new value applies to new entries
+    size_t max_bytes_;  // Memory budget of the entries
+    bool is_armed_;     // Expiry timer is running, its identifier is the block identifier
+
+    std::vector<struct cache_entry> entry_; // Entries, in use or listed in free_
+    std::vector<uint32_t> free_;            // Entries not in use
+    std::vector<uint32_t> slot_;            // Open-addressing table of the entries, with linear probing
+    size_t count_;                          // Entries in use
+    size_t bytes_;                          // Memory accounted for the entries in use
+    uint32_t lru_head_;                     // Entry used least recently, evicted first
+    uint32_t lru_tail_;                     // Entry used most recently
+    uint32_t age_head_;                     // Entry expiring first
+    uint32_t age_tail_;                     // Entry expiring last
+    std::string key_;                       // Key of the message being processed
+
+    struct block *out_;   // Block bound on port 0, receives the requests missing the cache
+    struct block *reply_; // Block bound on port 1, receives the cached replies
+
+    unsigned long hit_;    // Requests served from the cache
+    unsigned long miss_;   // Requests sent on port 0
+    unsigned long fill_;   // Replies stored
+    unsigned long evict_;  // Entries evicted for the memory budget
+    unsigned long expire_; // Entries expired
+
+    uint32_t find(const std::string &key, uint64_t hash) const;
+    void slot_insert(uint32_t idx);
+    void slot_erase(uint32_t idx);
+    void rehash(size_t size);
+    bool store(const std::string &key, const struct buffer &reply);
+    void erase(uint32_t idx);
+    void age_insert(uint32_t idx);
+    void expire();
+    void flush();
+    void timer_arm();
+
+    //
+    // Implementation of the block interface
+    //
+    explicit cache(struct manager *mgr);
+    virtual ~cache() override final;
+
+    virtual void bind_(int port, struct block *bk) override final;
+    virtual void start_() override final;
+    virtual void stop_() override final;
+
+    virtual bool data_(void *vdata) override final;
+
+    virtual void on_timer_(struct timer &tm) override final;
+};
+
+//
+// @struct cache_return
+//
+// @brief Store the replies going back to the requesters in a cache.
+//
+// Replies are forwarded on port 0, the cache is bound on port 1
+//
+struct cache_return : block
+{
+    uint32_t key_mask_; // Parts of a reply forming its key, bit i for part i
+    std::string key_;   // Key of the message being processed
+
+    struct block *out_;   // Block bound on port 0, receives the replies
+    struct cache *cache_; // Cache bound on port 1, stores the replies
+
+    //
+    // Implementation of the block interface
+    //
+    explicit cache_return(struct manager *mgr);
+    virtual ~cache_return() override final;
+
+    virtual void bind_(int port, struct block *bk) override final;
+
+    virtual bool data_(void *vdata) override final;
+};
+
+struct cache_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+struct cache_return_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+#endif // CACHE_HPP
@@ -0,0 +1,581 @@
+// Project headers
+#include "block/cache.hpp"
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+
+#define CACHE_KEY_MASK 0x1u                   // Default parts forming the key: the topic
+#define CACHE_TTL_MS 1000l                    // Default lifetime of an entry
+#define CACHE_MAX_BYTES (64u * 1024u * 1024u) // Default memory budget
+#define CACHE_SLOTS 64u                       // Initial size of the table, a power of two
+
+#define CACHE_NEVER UINT64_MAX // Expiration date of an entry without lifetime
+
+//
+// @brief Build the key of a message from its selected parts
+//
+// @return false if the message has none of the selected parts
+//
+static bool cache_key(const struct buffer &buf, uint32_t mask, std::string &key)
+{
+    bool is_found;
+
+    key.clear();
+    is_found = false;
+    for (size_t i = 0u; (i < buf.parts_.size()) && (i < 32u); ++i)
+    {
+        uint32_t len;
+
+        if ((mask & (1u << i)) == 0u)
+        {
+            continue;
+        }
+
+        len = static_cast<uint32_t>(buf.parts_[i].len);
+        key.append(reinterpret_cast<const char *>(&len), sizeof(len));
+        key.append(static_cast<const char *>(buf.parts_[i].data), buf.parts_[i].len);
+        is_found = true;
+    }
+
+    return is_found;
+}
+
+//
+// @brief Append an entry to a list
+//
+static void cache_push(std::vector<struct cache_entry> &entry, uint32_t idx,
+                       uint32_t cache_entry::*prev, uint32_t cache_entry::*next,
+                       uint32_t &head, uint32_t &tail)
+{
+    entry[idx].*prev = tail;
+    entry[idx].*next = CACHE_NIL;
+    if (tail == CACHE_NIL)
+    {
+        head = idx;
+    }
+    else
+    {
+        entry[tail].*next = idx;
+    }
+    tail = idx;
+}
+
+//
+// @brief Remove an entry from a list
+//
+static void cache_unlink(std::vector<struct cache_entry> &entry, uint32_t idx,
+                         uint32_t cache_entry::*prev, uint32_t cache_entry::*next,
+                         uint32_t &head, uint32_t &tail)
+{
+    uint32_t p = entry[idx].*prev;
+    uint32_t n = entry[idx].*next;
+
+    if (p == CACHE_NIL)
+    {
+        head = n;
+    }
+    else
+    {
+        entry[p].*next = n;
+    }
+    if (n == CACHE_NIL)
+    {
+        tail = p;
+    }
+    else
+    {
+        entry[n].*prev = p;
+    }
+}
+
+cache::cache(struct manager *mgr) : block(mgr),
+                                    key_mask_(CACHE_KEY_MASK),
+                                    ttl_ms_(CACHE_TTL_MS),
+                                    max_bytes_(CACHE_MAX_BYTES),
+                                    is_armed_(false),
+                                    count_(0u),
+                                    bytes_(0u),
+                                    lru_head_(CACHE_NIL),
+                                    lru_tail_(CACHE_NIL),
+                                    age_head_(CACHE_NIL),
+                                    age_tail_(CACHE_NIL),
+                                    out_(nullptr),
+                                    reply_(nullptr),
+                                    hit_(0u),
+                                    miss_(0u),
+                                    fill_(0u),
+                                    evict_(0u),
+                                    expire_(0u)
+{
+}
+cache::~cache()
+{
+    // A replacement block shares the timer identifier: only the timers of this block are removed
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+}
+
+//
+// @brief Look for the entry of a key
+//
+// @return Index of the entry, CACHE_NIL if none
+//
+uint32_t cache::find(const std::string &key, uint64_t hash) const
+{
+    size_t mask;
+
+    if (slot_.empty() == true)
+    {
+        return CACHE_NIL;
+    }
+
+    mask = slot_.size() - 1u;
+    for (size_t i = hash & mask; slot_[i] != CACHE_NIL; i = (i + 1u) & mask)
+    {
+        const struct cache_entry &entry = entry_[slot_[i]];
+
+        if ((entry.hash == hash) && (entry.key == key))
+        {
+            return slot_[i];
+        }
+    }
+
+    return CACHE_NIL;
+}
+
+//
+// @brief Put an entry in the first free slot from its hash
+//
+void cache::slot_insert(uint32_t idx)
+{
+    size_t mask;
+    size_t i;
+
+    mask = slot_.size() - 1u;
+    for (i = entry_[idx].hash & mask; slot_[i] != CACHE_NIL; i = (i + 1u) & mask)
+    {
+    }
+    slot_[i] = idx;
+}
+
+//
+// @brief Free the slot of an entry, and shift back the following entries of the probe sequence
+//
+void cache::slot_erase(uint32_t idx)
+{
+    size_t mask;
+    size_t i;
+
+    mask = slot_.size() - 1u;
+    for (i = entry_[idx].hash & mask; slot_[i] != idx; i = (i + 1u) & mask)
+    {
+    }
+
+    for (size_t j = (i + 1u) & mask; slot_[j] != CACHE_NIL; j = (j + 1u) & mask)
+    {
+        size_t k = entry_[slot_[j]].hash & mask;
+
+        // Entry at j is still reachable from its home slot k without going through i
+        if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+        {
+            continue;
+        }
+
+        slot_[i] = slot_[j];
+        i = j;
+    }
+    slot_[i] = CACHE_NIL;
+}
+
+//
+// @brief Build the table again with another size
+//
+void cache::rehash(size_t size)
+{
+    slot_.assign(size, CACHE_NIL);
+    for (uint32_t idx = lru_head_; idx != CACHE_NIL; idx = entry_[idx].lru_next)
+    {
+        slot_insert(idx);
+    }
+}
+
+//
+// @brief Store the reply to a request, replacing the previous one
+//
+// @return false if the reply is larger than the memory budget
+//
+bool cache::store(const std::string &key, const struct buffer &reply)
+{
+    uint64_t hash;
+    size_t bytes;
+    uint32_t idx;
+
+    bytes = sizeof(struct cache_entry) + 2u * sizeof(uint32_t) + key.size();
+    for (const auto &part : reply.parts_)
+    {
+        bytes += sizeof(std::string) + part.len;
+    }
+    if (bytes > max_bytes_)
+    {
+        LOGGER_DEBUG("Reply not cached: larger than the memory budget [bk_id=%d ; bytes=%zu]", id_, bytes);
+        return false;
+    }
+
+    hash = buffer_hash(key.data(), key.size());
+    idx = find(key, hash);
+    if (idx != CACHE_NIL)
+    {
+        erase(idx);
+    }
+
+    while ((bytes_ + bytes > max_bytes_) && (lru_head_ != CACHE_NIL))
+    {
+        erase(lru_head_);
+        ++evict_;
+    }
+
+    // Keep the table at most half full, for short probe sequences
+    if (2u * (count_ + 1u) > slot_.size())
+    {
+        rehash((slot_.empty() == true) ? CACHE_SLOTS : 2u * slot_.size());
+    }
+
+    if (free_.empty() == true)
+    {
+        idx = static_cast<uint32_t>(entry_.size());
+        entry_.emplace_back();
+    }
+    else
+    {
+        idx = free_.back();
+        free_.pop_back();
+    }
+
+    struct cache_entry &entry = entry_[idx];
+
+    entry.key = key;
+    entry.reply.clear();
+    for (const auto &part : reply.parts_)
+    {
+        entry.reply.emplace_back(static_cast<const char *>(part.data), part.len);
+    }
+    entry.hash = hash;
+    entry.expiry = (ttl_ms_ > 0) ? buffer_now_ns() + static_cast<uint64_t>(ttl_ms_) * 1000000ull : CACHE_NEVER;
+    entry.bytes = bytes;
+
+    cache_push(entry_, idx, &cache_entry::lru_prev, &cache_entry::lru_next, lru_head_, lru_tail_);
+    age_insert(idx);
+    slot_insert(idx);
+    ++count_;
+    bytes_ += bytes;
+    ++fill_;
+
+    // Timer is armed on the entry expiring first
+    if ((is_started_ == true) && ((is_armed_ == false) || (age_head_ == idx)))
+    {
+        timer_arm();
+    }
+
+    return true;
+}
+
+//
+// @brief Remove an entry, its memory is released
+//
+void cache::erase(uint32_t idx)
+{
+    struct cache_entry &entry = entry_[idx];
+
+    slot_erase(idx);
+    cache_unlink(entry_, idx, &cache_entry::lru_prev, &cache_entry::lru_next, lru_head_, lru_tail_);
+    if (entry.expiry != CACHE_NEVER)
+    {
+        cache_unlink(entry_, idx, &cache_entry::age_prev, &cache_entry::age_next, age_head_, age_tail_);
+    }
+    --count_;
+    bytes_ -= entry.bytes;
+
+    std::string().swap(entry.key);
+    std::vector<std::string>().swap(entry.reply);
+    free_.push_back(idx);
+}
+
+//
+// @brief List an entry by expiry date, after the entries expiring before or with it
+//
+// Entries usually share a lifetime: they are appended. Entries without expiry
+// are not listed
+//
+void cache::age_insert(uint32_t idx)
+{
+    struct cache_entry &entry = entry_[idx];
+    uint32_t prev;
+
+    if (entry.expiry == CACHE_NEVER)
+    {
+        return;
+    }
+
+    prev = age_tail_;
+    while ((prev != CACHE_NIL) && (entry_[prev].expiry > entry.expiry))
+    {
+        prev = entry_[prev].age_prev;
+    }
+
+    entry.age_prev = prev;
+    entry.age_next = (prev == CACHE_NIL) ? age_head_ : entry_[prev].age_next;
+    if (prev == CACHE_NIL)
+    {
+        age_head_ = idx;
+    }
+    else
+    {
+        entry_[prev].age_next = idx;
+    }
+    if (entry.age_next == CACHE_NIL)
+    {
+        age_tail_ = idx;
+    }
+    else
+    {
+        entry_[entry.age_next].age_prev = idx;
+    }
+}
+
+//
+// @brief Remove the expired entries, first to expire first
+//
+void cache::expire()
+{
+    uint64_t now;
+
+    now = buffer_now_ns();
+    while ((age_head_ != CACHE_NIL) && (entry_[age_head_].expiry <= now))
+    {
+        erase(age_head_);
+        ++expire_;
+    }
+}
+
+//
+// @brief Remove all the entries
+//
+void cache::flush()
+{
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+    is_armed_ = false;
+
+    entry_.clear();
+    free_.clear();
+    slot_.clear();
+    count_ = 0u;
+    bytes_ = 0u;
+    lru_head_ = CACHE_NIL;
+    lru_tail_ = CACHE_NIL;
+    age_head_ = CACHE_NIL;
+    age_tail_ = CACHE_NIL;
+}
+
+//
+// @brief Arm the expiry timer on the entry expiring first, or move it there
+//
+void cache::timer_arm()
+{
+    struct timer tm;
+    uint64_t expiry;
+    uint64_t now;
+    uint64_t delay;
+
+    if (age_head_ == CACHE_NIL)
+    {
+        return;
+    }
+    expiry = entry_[age_head_].expiry;
+
+    now = buffer_now_ns();
+    delay = (expiry > now) ? expiry - now : 0u;
+
+    tm.bk = this;
+    tm.arg = nullptr;
+    tm.tid = id_;
+    tm.time.tv_sec = static_cast<time_t>(delay / 1000000000ull);
+    tm.time.tv_nsec = static_cast<long>(delay % 1000000000ull);
+    is_armed_ = mgr_->timer_add(tm);
+}
+
+//
+// Implementation of the block interface
+//
+
+void cache::bind_(int port, struct block *bk)
+{
+    switch (port)
+    {
+    case 0:
+        out_ = bk;
+        break;
+
+    case 1:
+        reply_ = bk;
+        break;
+
+    default:
+        LOGGER_ERR("Failed to bind cache: wrong port [bk_id=%d ; port=%d]", id_, port);
+        break;
+    }
+}
+
+void cache::start_()
+{
+    if (is_armed_ == false)
+    {
+        timer_arm();
+    }
+}
+
+//
+// @brief Entries are kept, but they only expire on use while the block is stopped
+//
+void cache::stop_()
+{
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+    is_armed_ = false;
+}
+
+bool cache::data_(void *vdata)
+{
+    struct buffer reply;
+    uint32_t idx;
+
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to look up cache: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    const struct buffer &buf = *(static_cast<const struct buffer *>(vdata));
+
+    idx = CACHE_NIL;
+    if (cache_key(buf, key_mask_, key_) == true)
+    {
+        idx = find(key_, buffer_hash(key_.data(), key_.size()));
+    }
+    if ((idx != CACHE_NIL) && (entry_[idx].expiry <= buffer_now_ns()))
+    {
+        erase(idx);
+        ++expire_;
+        idx = CACHE_NIL;
+    }
+
+    if (idx == CACHE_NIL)
+    {
+        ++miss_;
+        process_data_(out_, vdata);
+        return false;
+    }
+
+    // The reply is copied before the data flow goes on: the entry may be evicted by then
+    cache_unlink(entry_, idx, &cache_entry::lru_prev, &cache_entry::lru_next, lru_head_, lru_tail_);
+    cache_push(entry_, idx, &cache_entry::lru_prev, &cache_entry::lru_next, lru_head_, lru_tail_);
+    for (const auto &part : entry_[idx].reply)
+    {
+        reply.push_back(part.data(), part.size());
+    }
+    reply.deadline_ns_ = buf.deadline_ns_;
+    ++hit_;
+
+    process_data_(reply_, &reply);
+    reply.clear();
+
+    return false;
+}
+
+void cache::on_timer_(struct timer &)
+{
+    is_armed_ = false;
+
+    expire();
+    if (is_started_ == true)
+    {
+        timer_arm();
+    }
+}
+
+cache_return::cache_return(struct manager *mgr) : block(mgr),
+                                                  key_mask_(CACHE_KEY_MASK),
+                                                  out_(nullptr),
+                                                  cache_(nullptr)
+{
+}
+cache_return::~cache_return() {}
+
+//
+// Implementation of the block interface
+//
+
+void cache_return::bind_(int port, struct block *bk)
+{
+    switch (port)
+    {
+    case 0:
+        out_ = bk;
+        break;
+
+    case 1:
+        if ((bk != nullptr) && (bk->type_ != "cache"))
+        {
+            LOGGER_ERR("Failed to bind cache return: not a cache [bk_id=%d ; port=%d ; type=%s]",
+                       id_, port, bk->type_.c_str());
+            cache_ = nullptr;
+            break;
+        }
+        cache_ = static_cast<struct cache *>(bk);
+        break;
+
+    default:
+        LOGGER_ERR("Failed to bind cache return: wrong port [bk_id=%d ; port=%d]", id_, port);
+        break;
+    }
+}
+
+bool cache_return::data_(void *vdata)
+{
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to store reply: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    const struct buffer &buf = *(static_cast<const struct buffer *>(vdata));
+
+    if ((cache_ != nullptr) && (cache_key(buf, key_mask_, key_) == true))
+    {
+        cache_->store(key_, buf);
+    }
+
+    process_data_(out_, vdata);
+
+    return false;
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *cache_factory::constructor(struct manager *mgr)
+{
+    return new struct cache(mgr);
+}
+
+void cache_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct cache *>(bk);
+}
+
+struct block *cache_return_factory::constructor(struct manager *mgr)
+{
+    return new struct cache_return(mgr);
+}
+
+void cache_return_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct cache_return *>(bk);
+}
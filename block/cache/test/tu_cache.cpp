@@ -0,0 +1,289 @@
+//
+// @brief Test file for the cache block
+//
+
+// Project headers
+#include "block/cache.hpp"
+#include "block/hello.hpp"
+#include "engine/tu.hpp"
+
+// C++ headers
+#include <map>
+
+struct manager mgr_;
+
+//
+// @brief Add a cache between a requester and a service, and the return path of the replies
+//
+//   - block 1: cache, misses go to the service on port 0, hits to the requester on port 1
+//   - block 2: hello, the service
+//   - block 3: hello, the requester
+//   - block 4: cache_return, replies go to the requester on port 0, the cache is on port 1
+//
+static struct cache *tu_cache_add()
+{
+    struct cache *ca;
+
+    ca = static_cast<struct cache *>(tu_block_add(mgr_, 1, "cache", 2));
+    ASSERT(mgr_.block_add(4, "cache_return") == true);
+    ASSERT(mgr_.block_bind(4, 0, 3) == true);
+    ASSERT(mgr_.block_bind(4, 1, 1) == true);
+
+    return ca;
+}
+
+static void tu_cache_hit()
+{
+    struct cache *ca;
+
+    ca = tu_cache_add();
+
+    // Miss goes to the service
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    ASSERT(tu_block_count(mgr_, 2) == 1u);
+    ASSERT(tu_block_count(mgr_, 3) == 0u);
+    ASSERT(ca->miss_ == 1u);
+
+    // Reply is stored on its way back
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value A"});
+    ASSERT(tu_block_count(mgr_, 3) == 1u);
+    ASSERT(ca->fill_ == 1u);
+    ASSERT(ca->count_ == 1u);
+
+    // Hit is served by the cache
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    ASSERT(tu_block_count(mgr_, 2) == 1u);
+    ASSERT(tu_block_count(mgr_, 3) == 3u);
+    ASSERT(ca->hit_ == 2u);
+
+    // A new reply replaces the entry
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value A2"});
+    ASSERT(ca->count_ == 1u);
+    ASSERT(ca->entry_[ca->lru_tail_].reply[1] == "value A2");
+
+    // Keys made of several parts
+    ca->key_mask_ = 0x3u;
+    {
+        struct buffer buf;
+
+        buf.push_back("GET.A", strlen("GET.A"));
+        buf.push_back("ARG", strlen("ARG"));
+        ASSERT(ca->data_(&buf) == false);
+        buf.clear();
+    }
+    ASSERT(ca->miss_ == 2u);
+
+    ca->flush();
+    ASSERT(ca->count_ == 0u);
+    ASSERT(ca->bytes_ == 0u);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Least recently used entries leave first, above the memory budget
+//
+static void tu_cache_evict()
+{
+    struct cache *ca;
+    size_t bytes;
+
+    ca = tu_cache_add();
+
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value"});
+    bytes = ca->bytes_;
+    ca->max_bytes_ = 3u * bytes;
+
+    tu_block_send(mgr_.block_get(4), {"GET.B", "value"});
+    tu_block_send(mgr_.block_get(4), {"GET.C", "value"});
+    ASSERT(ca->count_ == 3u);
+    ASSERT(ca->bytes_ == 3u * bytes);
+
+    // A is used: B is the least recently used
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    ASSERT(ca->hit_ == 1u);
+    tu_block_send(mgr_.block_get(4), {"GET.D", "value"});
+    ASSERT(ca->count_ == 3u);
+    ASSERT(ca->evict_ == 1u);
+    tu_block_send(mgr_.block_get(1), {"GET.B"});
+    ASSERT(ca->miss_ == 1u);
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    tu_block_send(mgr_.block_get(1), {"GET.C"});
+    tu_block_send(mgr_.block_get(1), {"GET.D"});
+    ASSERT(ca->hit_ == 4u);
+
+    // Reply larger than the budget is not stored
+    ASSERT(ca->fill_ == 4u);
+    tu_block_send(mgr_.block_get(4), {"GET.E", std::string(4u * bytes, 'E')});
+    ASSERT(ca->fill_ == 4u);
+    ASSERT(ca->count_ == 3u);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Stores and evictions against a reference, across the growth of the table
+//
+static void tu_cache_table()
+{
+    std::map<std::string, std::string> ref;
+    struct cache *ca;
+    size_t bytes;
+
+    ca = tu_cache_add();
+
+    // Entries have the same size
+    tu_block_send(mgr_.block_get(4), {"KEY000", "0"});
+    bytes = ca->bytes_;
+    ca->flush();
+    ca->max_bytes_ = 500u * bytes;
+
+    srand(42);
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string key = "KEY" + std::to_string(1000 + rand() % 1000).substr(1u);
+
+        // Some keys are used, others replaced
+        ref[key] = std::to_string(i % 10);
+        if (rand() % 4 == 0)
+        {
+            tu_block_send(mgr_.block_get(1), {key});
+        }
+        tu_block_send(mgr_.block_get(4), {key, ref[key]});
+    }
+    ASSERT(ca->count_ == 500u);
+    ASSERT(ca->evict_ != 0u);
+
+    // Entries in the table are the last ones used, with their last reply
+    for (uint32_t idx = ca->lru_head_; idx != CACHE_NIL; idx = ca->entry_[idx].lru_next)
+    {
+        const struct cache_entry &entry = ca->entry_[idx];
+
+        ASSERT(ca->find(entry.key, entry.hash) == idx);
+        ASSERT(entry.reply[1] == ref[entry.reply[0]]);
+    }
+    ASSERT(ca->slot_.size() >= 2u * ca->count_);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Entries expire on the timer, or on use
+//
+static void tu_cache_expire()
+{
+    struct cache *ca;
+
+    ca = tu_cache_add();
+    ca->ttl_ms_ = 1;
+    ASSERT(mgr_.block_start(1) == true);
+
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value"});
+    tu_block_send(mgr_.block_get(4), {"GET.B", "value"});
+    ASSERT(ca->is_armed_ == true);
+    ASSERT(mgr_.tm_list_.empty() == false);
+
+    usleep(2 * 1000);
+    mgr_.timer_check_exp();
+    ASSERT(ca->count_ == 0u);
+    ASSERT(ca->expire_ == 2u);
+    ASSERT(ca->is_armed_ == false);
+    ASSERT(mgr_.tm_list_.empty() == true);
+
+    // Stopped block: entries expire on use
+    ASSERT(mgr_.block_stop(1) == true);
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value"});
+    ASSERT(mgr_.tm_list_.empty() == true);
+    usleep(2 * 1000);
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    ASSERT(ca->expire_ == 3u);
+    ASSERT(ca->miss_ == 1u);
+
+    // Started block: timer is armed on the entries left
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value"});
+    ASSERT(mgr_.block_start(1) == true);
+    ASSERT(ca->is_armed_ == true);
+    ASSERT(mgr_.block_stop(1) == true);
+    ASSERT(ca->is_armed_ == false);
+
+    // No lifetime
+    ca->flush();
+    ca->ttl_ms_ = 0;
+    ASSERT(mgr_.block_start(1) == true);
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value"});
+    ASSERT(ca->is_armed_ == false);
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    ASSERT(ca->hit_ == 1u);
+
+    // Mixed lifetimes: the timer follows the entry expiring first
+    ca->ttl_ms_ = 1000;
+    tu_block_send(mgr_.block_get(4), {"GET.B", "value"});
+    ASSERT(ca->is_armed_ == true);
+    ca->ttl_ms_ = 1;
+    tu_block_send(mgr_.block_get(4), {"GET.C", "value"});
+    usleep(2 * 1000);
+    mgr_.timer_check_exp();
+    ASSERT(ca->expire_ == 4u);
+    ASSERT(ca->count_ == 2u);
+    ASSERT(ca->is_armed_ == true);
+    ASSERT(mgr_.block_stop(1) == true);
+
+    mgr_.block_clear();
+}
+
+static void tu_cache_errors()
+{
+    struct cache *ca;
+    struct cache_return *ret;
+
+    ca = tu_cache_add();
+    ret = static_cast<struct cache_return *>(mgr_.block_get(4));
+
+    ASSERT(ca->data_(nullptr) == false);
+    ASSERT(ret->data_(nullptr) == false);
+    ca->bind_(2, nullptr);
+    ret->bind_(2, nullptr);
+
+    // Return path bound to another block does not store
+    ASSERT(mgr_.block_bind(4, 1, 2) == true);
+    ASSERT(ret->cache_ == nullptr);
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value"});
+    ASSERT(ca->fill_ == 0u);
+    ASSERT(tu_block_count(mgr_, 3) == 1u);
+
+    // Messages without key
+    ASSERT(mgr_.block_bind(4, 1, 1) == true);
+    ret->key_mask_ = 0x4u;
+    tu_block_send(mgr_.block_get(4), {"GET.A", "value"});
+    ASSERT(ca->fill_ == 0u);
+    ca->key_mask_ = 0x4u;
+    tu_block_send(mgr_.block_get(1), {"GET.A"});
+    ASSERT(ca->miss_ == 1u);
+
+    mgr_.block_clear();
+}
+
+int main(int, char **)
+{
+    struct cache_factory cache_f;
+    struct cache_return_factory cache_return_f;
+    struct hello_factory hello_f;
+
+    LOGGER_OPEN("tu_cache");
+
+    mgr_.block_factory_register("cache", &cache_f);
+    mgr_.block_factory_register("cache_return", &cache_return_f);
+    mgr_.block_factory_register("hello", &hello_f);
+
+    tu_cache_hit();
+    tu_cache_evict();
+    tu_cache_table();
+    tu_cache_expire();
+    tu_cache_errors();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+#define CAPTURE_MAGIC "C3QOCAP1" // First bytes of a capture file
+#define CAPTURE_VERSION 1u       // Version of the format
+
+//
+// A capture file is made of a header and records, in host byte order:
+//   - header: magic (8 bytes), version (uint32_t), size of the header (uint32_t)
+//   - record: size of the record (uint32_t), number of parts (uint32_t),
+//             date in nanoseconds since the epoch (uint64_t), then the
+//             length (uint32_t) and the data of each part
+// Records are padded with zeros to 8 bytes. A zero size, or the end of the
+// file, ends the records
+//
+
+//
+// @struct capture_file
+//
+// @brief File of a capture, opened or closed by a worker
+//
+struct capture_file
+{
+    std::string path; // Path of the file
+    int fd;           // File descriptor, -1 if closed
+    char *base;       // Mapping of the file, nullptr if not mapped
+    size_t size;      // Size of the file and of the mapping, in pages
+    size_t used;      // Bytes written from the start of the file
+    bool do_open;     // Operation requested: open, or close
+    bool do_unlink;   // Remove the file on close
+};
+
+//
+// @struct capture
+//
+// @brief Tap the data flow: buffers are forwarded untouched, and appended
+//        with their date to memory-mapped files.
+//
+// Files are preallocated and mapped with their pages populated, so that a
+// record costs a copy. The next file is opened by a worker in advance and
+// files are closed by a worker: the loop never waits for the file system.
+// Records are dropped while the next file is not ready, and all of them
+// without workers
+//
+struct capture : block
+{
+    std::string path_; // Files are named <path>.<sequence>
+    size_t file_size_; // Size of a file, rounded up to the page size
+
+    struct capture_file *cur_;                // File receiving the records
+    struct capture_file *next_;               // File ready to take over
+    std::vector<struct capture_file *> busy_; // Files handed to the workers, until their completion
+    bool is_opening_;                         // Next file is being opened
+    unsigned long seq_;                       // Sequence of the next file
+
+    unsigned long record_; // Records written
+    unsigned long bytes_;  // Bytes of the records written
+    unsigned long drop_;   // Records dropped: no file ready, or larger than a file
+    unsigned long rotate_; // Files closed when full
+    unsigned long error_;  // Files that failed to open
+
+    bool record(const struct buffer &buf);
+    void file_next();
+    void file_close(struct capture_file *file, bool unlink);
+    void file_submit(struct capture_file *file);
+    void file_done(struct capture_file *file);
+    void file_drop();
+
+    //
+    // Implementation of the block interface
+    //
+    explicit capture(struct manager *mgr);
+    virtual ~capture() override final;
+
+    virtual void start_() override final;
+    virtual void stop_() override final;
+
+    virtual bool data_(void *vdata) override final;
+
+    virtual bool work_(struct work &wk) override final;
+    virtual void on_work_(struct work &wk) override final;
+};
+
+struct capture_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+//
+// @struct capture_reader
+//
+// @brief Read the records of a capture file
+//
+struct capture_reader
+{
+    int fd_;           // File descriptor, -1 if closed
+    const char *base_; // Mapping of the file
+    size_t size_;      // Size of the file
+    size_t off_;       // Offset of the next record
+
+    bool open(const char *path);
+    void close();
+    bool next(struct buffer &buf, uint64_t &date_ns);
+
+    capture_reader();
+    ~capture_reader();
+};
+
+#endif // CAPTURE_HPP
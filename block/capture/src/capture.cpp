@@ -0,0 +1,576 @@
+// Project headers
+#include "block/capture.hpp"
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+
+// C++ headers
+#include <algorithm>
+
+// C headers
+extern "C"
+{
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+#define CAPTURE_PATH "/tmp/c3qo.cap"   // Default prefix of the files
+#define CAPTURE_FILE_SIZE (64ul << 20) // Default size of a file
+#define CAPTURE_HEADER_SIZE 16u        // Size of the file header
+#define CAPTURE_RECORD_SIZE 16u        // Size of the record header, before the parts
+#define CAPTURE_ALIGN 8u               // Records are padded to this size
+
+//
+// @brief Round a size up to a multiple of the page size
+//
+static size_t capture_page_round(size_t size)
+{
+    size_t page;
+
+    page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (size == 0u)
+    {
+        return page;
+    }
+
+    return (size + page - 1u) / page * page;
+}
+
+//
+// @brief Open or close a file, without any access to the block
+//
+// An opened file has its blocks allocated and its pages mapped, for
+// records not to fault nor to allocate on write
+//
+static void capture_file_run(struct capture_file &file)
+{
+    uint32_t value;
+    int ret;
+
+    if (file.do_open == false)
+    {
+        munmap(file.base, file.size);
+        file.base = nullptr;
+
+        if (file.do_unlink == true)
+        {
+            unlink(file.path.c_str());
+        }
+        else if (ftruncate(file.fd, static_cast<off_t>(capture_page_round(file.used))) == -1)
+        {
+            LOGGER_ERR("Failed to truncate capture file: %s [errno=%d ; path=%s]", strerror(errno), errno, file.path.c_str());
+        }
+
+        close(file.fd);
+        file.fd = -1;
+        return;
+    }
+
+    file.fd = open(file.path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file.fd == -1)
+    {
+        LOGGER_ERR("Failed to open capture file: %s [errno=%d ; path=%s]", strerror(errno), errno, file.path.c_str());
+        return;
+    }
+
+    ret = posix_fallocate(file.fd, 0, static_cast<off_t>(file.size));
+    if (ret != 0)
+    {
+        LOGGER_ERR("Failed to allocate capture file: %s [errno=%d ; path=%s]", strerror(ret), ret, file.path.c_str());
+        unlink(file.path.c_str());
+        close(file.fd);
+        file.fd = -1;
+        return;
+    }
+
+    void *base = mmap(nullptr, file.size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, file.fd, 0);
+    if (base == MAP_FAILED)
+    {
+        LOGGER_ERR("Failed to map capture file: %s [errno=%d ; path=%s]", strerror(errno), errno, file.path.c_str());
+        unlink(file.path.c_str());
+        close(file.fd);
+        file.fd = -1;
+        return;
+    }
+    file.base = static_cast<char *>(base);
+
+    memcpy(file.base, CAPTURE_MAGIC, strlen(CAPTURE_MAGIC));
+    value = CAPTURE_VERSION;
+    memcpy(file.base + 8, &value, sizeof(value));
+    value = CAPTURE_HEADER_SIZE;
+    memcpy(file.base + 12, &value, sizeof(value));
+    file.used = CAPTURE_HEADER_SIZE;
+}
+
+capture::capture(struct manager *mgr) : block(mgr),
+                                        path_(CAPTURE_PATH),
+                                        file_size_(CAPTURE_FILE_SIZE),
+                                        cur_(nullptr),
+                                        next_(nullptr),
+                                        is_opening_(false),
+                                        seq_(0u),
+                                        record_(0u),
+                                        bytes_(0u),
+                                        drop_(0u),
+                                        rotate_(0u),
+                                        error_(0u)
+{
+}
+capture::~capture()
+{
+    // Files are closed on stop: this is a last resort, in the loop
+    for (struct capture_file *file : {cur_, next_})
+    {
+        if (file != nullptr)
+        {
+            file->do_open = false;
+            file->do_unlink = false;
+            capture_file_run(*file);
+            delete file;
+        }
+    }
+
+    // Block is deleted once its work is processed, completions may be dropped
+    file_drop();
+}
+
+//
+// @brief Append a buffer to the current file, move to the next file if full
+//
+// @return true if the buffer is recorded
+//
+bool capture::record(const struct buffer &buf)
+{
+    struct timespec now;
+    uint64_t date_ns;
+    uint32_t value;
+    size_t size;
+    char *rec;
+
+    size = CAPTURE_RECORD_SIZE;
+    for (const auto &part : buf.parts_)
+    {
+        size += sizeof(uint32_t) + part.len;
+    }
+    size = (size + CAPTURE_ALIGN - 1u) / CAPTURE_ALIGN * CAPTURE_ALIGN;
+
+    // Record must fit in an empty file
+    if ((size + CAPTURE_HEADER_SIZE > capture_page_round(file_size_)) || (size > UINT32_MAX))
+    {
+        LOGGER_DEBUG("Drop record: larger than a file [bk_id=%d ; size=%zu]", id_, size);
+        ++drop_;
+        return false;
+    }
+
+    if ((cur_ == nullptr) || (cur_->used + size > cur_->size))
+    {
+        // Next file opened before a change of size
+        if ((next_ != nullptr) && (size + CAPTURE_HEADER_SIZE > next_->size))
+        {
+            file_close(next_, true);
+            next_ = nullptr;
+        }
+        if (next_ == nullptr)
+        {
+            LOGGER_DEBUG("Drop record: no file ready [bk_id=%d ; size=%zu]", id_, size);
+            ++drop_;
+            file_next();
+            return false;
+        }
+
+        // Rotate
+        if (cur_ != nullptr)
+        {
+            file_close(cur_, false);
+            ++rotate_;
+        }
+        cur_ = next_;
+        next_ = nullptr;
+        file_next();
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    date_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000u + static_cast<uint64_t>(now.tv_nsec);
+
+    // Size is written last, a reader of a live file does not see a partial record
+    rec = cur_->base + cur_->used;
+    value = static_cast<uint32_t>(buf.parts_.size());
+    memcpy(rec + 4, &value, sizeof(value));
+    memcpy(rec + 8, &date_ns, sizeof(date_ns));
+    rec += CAPTURE_RECORD_SIZE;
+    for (const auto &part : buf.parts_)
+    {
+        value = static_cast<uint32_t>(part.len);
+        memcpy(rec, &value, sizeof(value));
+        memcpy(rec + sizeof(value), part.data, part.len);
+        rec += sizeof(value) + part.len;
+    }
+    value = static_cast<uint32_t>(size);
+    memcpy(cur_->base + cur_->used, &value, sizeof(value));
+
+    cur_->used += size;
+    ++record_;
+    bytes_ += size;
+
+    return true;
+}
+
+//
+// @brief Open the next file in advance, unless it is ready or being opened
+//
+void capture::file_next()
+{
+    struct capture_file *file;
+    char seq[32];
+
+    // Files are opened by the workers only
+    if ((next_ != nullptr) || (is_opening_ == true) || (mgr_->wk_thread_.empty() == true))
+    {
+        return;
+    }
+
+    snprintf(seq, sizeof(seq), ".%06lu", seq_);
+    ++seq_;
+
+    file = new struct capture_file;
+    file->path = path_ + seq;
+    file->fd = -1;
+    file->base = nullptr;
+    file->size = capture_page_round(file_size_);
+    file->used = 0u;
+    file->do_open = true;
+    file->do_unlink = false;
+
+    is_opening_ = true;
+    file_submit(file);
+}
+
+//
+// @brief Close a file, it is deleted once closed
+//
+void capture::file_close(struct capture_file *file, bool unlink)
+{
+    file->do_open = false;
+    file->do_unlink = unlink;
+    file_submit(file);
+}
+
+//
+// @brief Hand a file to a worker
+//
+// Without workers, a file to open is dropped and a file to close is closed in
+// the loop, as a last resort
+//
+void capture::file_submit(struct capture_file *file)
+{
+    struct buffer buf;
+
+    if ((mgr_->wk_thread_.empty() == false) && (mgr_->work_submit(this, buf, file) == true))
+    {
+        busy_.push_back(file);
+        return;
+    }
+
+    if (file->do_open == true)
+    {
+        is_opening_ = false;
+        ++error_;
+    }
+    else
+    {
+        capture_file_run(*file);
+    }
+    delete file;
+}
+
+//
+// @brief Take over a file opened, or delete a file closed
+//
+void capture::file_done(struct capture_file *file)
+{
+    busy_.erase(std::remove(busy_.begin(), busy_.end(), file), busy_.end());
+
+    if (file->do_open == false)
+    {
+        delete file;
+        return;
+    }
+
+    is_opening_ = false;
+    if (file->base == nullptr)
+    {
+        ++error_;
+        delete file;
+        return;
+    }
+
+    // Block stopped in the meantime
+    if (is_started_ == false)
+    {
+        file_close(file, true);
+        return;
+    }
+
+    if (cur_ == nullptr)
+    {
+        cur_ = file;
+        file_next();
+    }
+    else
+    {
+        next_ = file;
+    }
+}
+
+//
+// @brief Delete the files processed by the workers whose completion was dropped
+//
+// Workers must be stopped, or done with the files of the block. Files opened
+// are removed
+//
+void capture::file_drop()
+{
+    for (struct capture_file *file : busy_)
+    {
+        if (file->base != nullptr)
+        {
+            LOGGER_DEBUG("Remove capture file: completion dropped [bk_id=%d ; path=%s]", id_, file->path.c_str());
+            file->do_open = false;
+            file->do_unlink = true;
+            capture_file_run(*file);
+        }
+        delete file;
+    }
+    busy_.clear();
+    is_opening_ = false;
+}
+
+//
+// Implementation of the block interface
+//
+
+void capture::start_()
+{
+    if (mgr_->wk_thread_.empty() == true)
+    {
+        LOGGER_ERR("Failed to start capture: no worker to open the files, records are dropped [bk_id=%d]", id_);
+        return;
+    }
+
+    file_next();
+}
+
+//
+// @brief Close the current file, remove the next one
+//
+// Files still handed to the workers are closed once back, or here if the
+// workers stopped in the meantime
+//
+void capture::stop_()
+{
+    if (cur_ != nullptr)
+    {
+        file_close(cur_, false);
+        cur_ = nullptr;
+    }
+    if (next_ != nullptr)
+    {
+        file_close(next_, true);
+        next_ = nullptr;
+    }
+
+    if (mgr_->wk_thread_.empty() == true)
+    {
+        file_drop();
+    }
+}
+
+bool capture::data_(void *vdata)
+{
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to capture data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    if (is_started_ == true)
+    {
+        record(*(static_cast<const struct buffer *>(vdata)));
+    }
+
+    // Capture may end the data flow
+    return (sink_ != nullptr);
+}
+
+bool capture::work_(struct work &wk)
+{
+    capture_file_run(*(static_cast<struct capture_file *>(wk.arg)));
+
+    return false;
+}
+
+void capture::on_work_(struct work &wk)
+{
+    file_done(static_cast<struct capture_file *>(wk.arg));
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *capture_factory::constructor(struct manager *mgr)
+{
+    return new struct capture(mgr);
+}
+
+void capture_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct capture *>(bk);
+}
+
+//
+// Implementation of the reader
+//
+
+capture_reader::capture_reader() : fd_(-1), base_(nullptr), size_(0u), off_(0u) {}
+capture_reader::~capture_reader()
+{
+    close();
+}
+
+//
+// @brief Map a capture file and check its header
+//
+bool capture_reader::open(const char *path)
+{
+    struct stat st;
+    uint32_t value;
+
+    close();
+
+    fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd_ == -1)
+    {
+        LOGGER_ERR("Failed to open capture file: %s [errno=%d ; path=%s]", strerror(errno), errno, path);
+        return false;
+    }
+
+    if ((fstat(fd_, &st) == -1) || (st.st_size < static_cast<off_t>(CAPTURE_HEADER_SIZE)))
+    {
+        LOGGER_ERR("Failed to read capture file: no header [path=%s]", path);
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    void *base = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (base == MAP_FAILED)
+    {
+        LOGGER_ERR("Failed to map capture file: %s [errno=%d ; path=%s]", strerror(errno), errno, path);
+        close();
+        return false;
+    }
+    base_ = static_cast<const char *>(base);
+
+    memcpy(&value, base_ + 8, sizeof(value));
+    if ((memcmp(base_, CAPTURE_MAGIC, strlen(CAPTURE_MAGIC)) != 0) || (value != CAPTURE_VERSION))
+    {
+        LOGGER_ERR("Failed to read capture file: unknown format [path=%s ; version=%u]", path, value);
+        close();
+        return false;
+    }
+    memcpy(&value, base_ + 12, sizeof(value));
+    if ((value < CAPTURE_HEADER_SIZE) || (value > size_))
+    {
+        LOGGER_ERR("Failed to read capture file: bad header size [path=%s ; header_size=%u]", path, value);
+        close();
+        return false;
+    }
+    off_ = value;
+
+    return true;
+}
+
+void capture_reader::close()
+{
+    if (base_ != nullptr)
+    {
+        munmap(const_cast<char *>(base_), size_);
+        base_ = nullptr;
+    }
+    if (fd_ != -1)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0u;
+    off_ = 0u;
+}
+
+//
+// @brief Read the next record
+//
+// @param buf     : Receives the parts of the record, appended
+// @param date_ns : Receives the date of the record
+//
+// @return false at the end of the records, or on a corrupted record
+//
+bool capture_reader::next(struct buffer &buf, uint64_t &date_ns)
+{
+    uint32_t size;
+    uint32_t parts;
+    size_t off;
+
+    if ((base_ == nullptr) || (off_ + CAPTURE_RECORD_SIZE > size_))
+    {
+        return false;
+    }
+
+    memcpy(&size, base_ + off_, sizeof(size));
+    if (size == 0u)
+    {
+        return false;
+    }
+    if ((size < CAPTURE_RECORD_SIZE) || (size > size_ - off_))
+    {
+        LOGGER_ERR("Failed to read record: bad size [offset=%zu ; size=%u]", off_, size);
+        return false;
+    }
+    memcpy(&parts, base_ + off_ + 4, sizeof(parts));
+    memcpy(&date_ns, base_ + off_ + 8, sizeof(date_ns));
+
+    // Check the parts before building the buffer
+    off = off_ + CAPTURE_RECORD_SIZE;
+    for (uint32_t i = 0u; i < parts; ++i)
+    {
+        uint32_t len;
+
+        if (off + sizeof(len) > off_ + size)
+        {
+            LOGGER_ERR("Failed to read record: bad part [offset=%zu ; part=%u]", off_, i);
+            return false;
+        }
+        memcpy(&len, base_ + off, sizeof(len));
+        off += sizeof(len);
+        if (len > off_ + size - off)
+        {
+            LOGGER_ERR("Failed to read record: bad part [offset=%zu ; part=%u]", off_, i);
+            return false;
+        }
+        off += len;
+    }
+
+    off = off_ + CAPTURE_RECORD_SIZE;
+    for (uint32_t i = 0u; i < parts; ++i)
+    {
+        uint32_t len;
+
+        memcpy(&len, base_ + off, sizeof(len));
+        buf.push_back(base_ + off + sizeof(len), len);
+        off += sizeof(len) + len;
+    }
+    off_ += size;
+
+    return true;
+}
@@ -0,0 +1,316 @@
+//
+// @brief Test file for the capture block
+//
+
+// Project headers
+#include "block/capture.hpp"
+#include "block/hello.hpp"
+#include "engine/tu.hpp"
+
+// C headers
+extern "C"
+{
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+#define TU_CAPTURE_PATH "/tmp/tu_capture.cap" // Prefix of the files
+
+struct manager mgr_;
+
+//
+// @brief Add a capture block and a hello block bound on it
+//
+static struct capture *tu_capture_add()
+{
+    struct capture *cap;
+
+    cap = static_cast<struct capture *>(tu_block_add(mgr_, 1, "capture", 1));
+    cap->path_ = TU_CAPTURE_PATH;
+    cap->file_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    return cap;
+}
+
+//
+// @brief Path of a file of the capture
+//
+static std::string tu_capture_path(unsigned long seq)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), TU_CAPTURE_PATH ".%06lu", seq);
+
+    return std::string(name);
+}
+
+//
+// @brief Read the files of a capture, check the records and remove the files
+//
+// @return Number of records read
+//
+static unsigned long tu_capture_check(unsigned long files)
+{
+    unsigned long count;
+    uint64_t last_ns;
+
+    count = 0u;
+    last_ns = 0u;
+    for (unsigned long seq = 0u; seq < files; ++seq)
+    {
+        struct capture_reader reader;
+        struct buffer buf;
+        struct stat st;
+        uint64_t date_ns;
+        off_t page_rest;
+
+        // Closed files are truncated to a number of pages
+        if (stat(tu_capture_path(seq).c_str(), &st) != 0)
+        {
+            continue;
+        }
+        page_rest = st.st_size % sysconf(_SC_PAGESIZE);
+        ASSERT(page_rest == 0);
+
+        ASSERT(reader.open(tu_capture_path(seq).c_str()) == true);
+        while (reader.next(buf, date_ns) == true)
+        {
+            ASSERT(buf.parts_.size() == 2u);
+            ASSERT(std::string(static_cast<char *>(buf.parts_[0].data), buf.parts_[0].len) == "TOPIC");
+            ASSERT(std::string(static_cast<char *>(buf.parts_[1].data), buf.parts_[1].len) == std::to_string(count));
+            ASSERT(date_ns >= last_ns);
+            last_ns = date_ns;
+            buf.clear();
+            ++count;
+        }
+        reader.close();
+
+        unlink(tu_capture_path(seq).c_str());
+    }
+
+    return count;
+}
+
+//
+// @brief Wait for the workers to hand the files back
+//
+static void tu_capture_wait(struct capture *cap)
+{
+    for (int i = 0; (i < 1000) && (cap->busy_.empty() == false); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(cap->busy_.empty() == true);
+}
+
+//
+// @brief Without workers, files are not opened in the loop
+//
+static void tu_capture_no_worker()
+{
+    struct capture *cap;
+
+    cap = tu_capture_add();
+
+    // Stopped block forwards without recording
+    tu_block_send(mgr_.block_get(1), {"TOPIC", ""});
+    ASSERT(tu_block_count(mgr_, 2) == 1u);
+    ASSERT(cap->record_ == 0u);
+    ASSERT(cap->seq_ == 0u);
+
+    // Started block forwards and drops the records
+    ASSERT(mgr_.block_start(1) == true);
+    ASSERT(cap->is_opening_ == false);
+    tu_block_send(mgr_.block_get(1), {"TOPIC", "0"});
+    ASSERT(tu_block_count(mgr_, 2) == 2u);
+    ASSERT(cap->drop_ == 1u);
+    ASSERT(cap->seq_ == 0u);
+    ASSERT(mgr_.block_stop(1) == true);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Files opened and closed by workers
+//
+static void tu_capture_worker()
+{
+    struct capture *cap;
+    unsigned long count;
+    unsigned long files;
+
+    ASSERT(mgr_.work_start(2u) == true);
+    cap = tu_capture_add();
+
+    // Records are dropped until the first file is ready
+    ASSERT(mgr_.block_start(1) == true);
+    ASSERT(cap->is_opening_ == true);
+    for (int i = 0; (i < 1000) && (cap->next_ == nullptr); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(cap->cur_ != nullptr);
+    ASSERT(cap->next_ != nullptr);
+
+    // Wait for the next file before each record, none is dropped
+    count = 0u;
+    while (cap->rotate_ < 3u)
+    {
+        tu_block_send(mgr_.block_get(1), {"TOPIC", std::to_string(count)});
+        ++count;
+
+        while (cap->next_ == nullptr)
+        {
+            mgr_.fd_poll();
+        }
+    }
+    ASSERT(cap->drop_ == 0u);
+    ASSERT(cap->record_ == count);
+
+    // Deleted block is kept until its files are closed
+    ASSERT(mgr_.block_stop(1) == true);
+    ASSERT(cap->wk_pending_ != 0u);
+    files = cap->seq_;
+    ASSERT(mgr_.block_del(1) == true);
+    ASSERT(mgr_.bk_retired_.size() == 1u);
+    for (int i = 0; (i < 1000) && (mgr_.bk_retired_.empty() == false); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(mgr_.bk_retired_.empty() == true);
+
+    // Next file is removed on stop
+    ASSERT(access(tu_capture_path(files - 1u).c_str(), F_OK) != 0);
+    ASSERT(tu_capture_check(files) == count);
+
+    mgr_.work_stop();
+    mgr_.block_clear();
+}
+
+//
+// @brief Files still in the hands of the workers when they stop
+//
+static void tu_capture_shutdown()
+{
+    struct capture *cap;
+    unsigned long files;
+
+    cap = tu_capture_add();
+
+    // File opened, its completion is dropped: it is removed on stop
+    ASSERT(mgr_.work_start(1u) == true);
+    ASSERT(mgr_.block_start(1) == true);
+    ASSERT(cap->busy_.size() == 1u);
+    mgr_.work_stop();
+    ASSERT(cap->busy_.size() == 1u);
+    ASSERT(mgr_.block_stop(1) == true);
+    ASSERT(cap->busy_.empty() == true);
+    ASSERT(cap->is_opening_ == false);
+    ASSERT(access(tu_capture_path(0u).c_str(), F_OK) != 0);
+
+    // Files closed, their completion is dropped: they are deleted with the block
+    ASSERT(mgr_.work_start(1u) == true);
+    ASSERT(mgr_.block_start(1) == true);
+    for (int i = 0; (i < 1000) && (cap->next_ == nullptr); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(cap->next_ != nullptr);
+    files = cap->seq_;
+    ASSERT(mgr_.block_stop(1) == true);
+    ASSERT(cap->busy_.size() == 2u);
+    mgr_.work_stop();
+    mgr_.block_clear();
+
+    ASSERT(access(tu_capture_path(files - 1u).c_str(), F_OK) != 0);
+    ASSERT(tu_capture_check(files) == 0u);
+}
+
+static void tu_capture_errors()
+{
+    struct capture_reader reader;
+    struct capture *cap;
+    struct buffer buf;
+    uint64_t date_ns;
+    FILE *file;
+
+    ASSERT(mgr_.work_start(1u) == true);
+    cap = tu_capture_add();
+    ASSERT(cap->data_(nullptr) == false);
+
+    // Record larger than a file
+    ASSERT(mgr_.block_start(1) == true);
+    tu_block_send(mgr_.block_get(1), {"TOPIC", std::string(cap->file_size_, 'A')});
+    ASSERT(cap->drop_ == 1u);
+    ASSERT(tu_block_count(mgr_, 2) == 1u);
+    ASSERT(mgr_.block_stop(1) == true);
+    tu_capture_wait(cap);
+    ASSERT(tu_capture_check(cap->seq_) == 0u);
+
+    // File that cannot be opened
+    cap->path_ = "/nonexistent/tu_capture.cap";
+    ASSERT(mgr_.block_start(1) == true);
+    tu_capture_wait(cap);
+    ASSERT(cap->error_ == 1u);
+    tu_block_send(mgr_.block_get(1), {"TOPIC", "0"});
+    ASSERT(cap->drop_ == 2u);
+    tu_capture_wait(cap);
+    ASSERT(cap->error_ == 2u);
+    ASSERT(mgr_.block_stop(1) == true);
+
+    // Capture ending the data flow
+    mgr_.block_get(1)->sink_ = nullptr;
+    ASSERT(mgr_.block_get(1)->data_(&buf) == false);
+
+    // Reader
+    ASSERT(reader.open("/nonexistent/tu_capture.cap") == false);
+    ASSERT(reader.next(buf, date_ns) == false);
+
+    file = fopen(TU_CAPTURE_PATH ".bad", "w");
+    ASSERT(file != nullptr);
+    fputs("NOT A CAPTURE FILE", file);
+    fclose(file);
+    ASSERT(reader.open(TU_CAPTURE_PATH ".bad") == false);
+    unlink(TU_CAPTURE_PATH ".bad");
+
+    // Record overflowing the file
+    file = fopen(TU_CAPTURE_PATH ".bad", "w");
+    ASSERT(file != nullptr);
+    {
+        uint32_t header[4] = {0u, 0u, CAPTURE_VERSION, 16u};
+        uint32_t record[4] = {64u, 1u, 0u, 0u};
+
+        memcpy(header, CAPTURE_MAGIC, 8u);
+        fwrite(header, sizeof(header), 1u, file);
+        fwrite(record, sizeof(record), 1u, file);
+    }
+    fclose(file);
+    ASSERT(reader.open(TU_CAPTURE_PATH ".bad") == true);
+    ASSERT(reader.next(buf, date_ns) == false);
+    ASSERT(buf.parts_.empty() == true);
+    unlink(TU_CAPTURE_PATH ".bad");
+
+    mgr_.work_stop();
+    mgr_.block_clear();
+}
+
+int main(int, char **)
+{
+    struct capture_factory capture_f;
+    struct hello_factory hello_f;
+
+    LOGGER_OPEN("tu_capture");
+
+    mgr_.block_factory_register("capture", &capture_f);
+    mgr_.block_factory_register("hello", &hello_f);
+
+    tu_capture_no_worker();
+    tu_capture_worker();
+    tu_capture_shutdown();
+    tu_capture_errors();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
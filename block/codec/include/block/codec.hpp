@@ -0,0 +1,80 @@
+#ifndef CODEC_HPP
+#define CODEC_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+// C headers
+extern "C"
+{
+#include <zlib.h>
+}
+
+//
+// @enum codec_mode
+//
+enum codec_mode
+{
+    CODEC_COMPRESS = 0,  // Compress the selected parts
+    CODEC_DECOMPRESS = 1 // Restore the parts compressed by another codec
+};
+
+//
+// A selected part is replaced by a header and its data:
+//   - format (uint8_t): raw, deflate, or deflate with the dictionary
+//   - for deflate: length of the raw data (uint32_t, little-endian)
+//   - for deflate with the dictionary: Adler-32 of the dictionary (uint32_t, little-endian)
+// Parts below the size threshold, or not shrinking, are left raw
+//
+
+//
+// @struct codec
+//
+// @brief Compress or decompress some parts of the buffers in place, with raw
+//        deflate. Streams and scratch memory are kept from one buffer to the other
+//
+struct codec : block
+{
+    enum codec_mode mode_; // Compress or decompress
+    int level_;            // Compression level, 1 (fast) to 9 (small)
+    size_t min_size_;      // Parts below this size are not compressed
+    uint32_t part_mask_;   // Parts to process, bit i for part i
+
+    std::string dict_path_;     // File of the dictionary
+    std::vector<uint8_t> dict_; // Dictionary shared by both sides, empty if none
+    uint32_t dict_id_;          // Adler-32 of the dictionary
+
+    z_stream deflate_;         // Compression stream, reset for each part
+    z_stream inflate_;         // Decompression stream, reset for each part
+    bool is_init_;             // Streams are initialized
+    std::vector<uint8_t> out_; // Compressed part being built
+
+    unsigned long msg_;       // Buffers processed
+    unsigned long bytes_in_;  // Size of the selected parts, before processing
+    unsigned long bytes_out_; // Size of the selected parts, after processing
+    unsigned long skip_;      // Parts left raw
+    unsigned long error_;     // Buffers dropped, or parts left raw on compression error
+    unsigned long cpu_ns_;    // CPU time spent processing the buffers
+    unsigned long last_ns_;   // CPU time spent on the last buffer
+
+    bool stream_init();
+    bool dict_load(const char *path);
+    bool compress(struct buffer_part &part);
+    bool decompress(struct buffer_part &part);
+
+    //
+    // Implementation of the block interface
+    //
+    explicit codec(struct manager *mgr);
+    virtual ~codec() override final;
+
+    virtual bool data_(void *vdata) override final;
+};
+
+struct codec_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+#endif // CODEC_HPP
@@ -0,0 +1,397 @@
+// Project headers
+#include "block/codec.hpp"
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+
+#define CODEC_LEVEL 1               // Default compression level, favors speed
+#define CODEC_MIN_SIZE 128u         // Default size below which parts are not compressed
+#define CODEC_PART_MASK 0xfffffffeu // Default parts to process: all but the topic
+#define CODEC_MAX_SIZE (64u << 20)  // Largest part restored, against forged headers
+#define CODEC_WINDOW_BITS (-15)     // Raw deflate: no zlib header nor checksum
+#define CODEC_MEM_LEVEL 8           // Default memory level of zlib
+
+#define CODEC_RAW 0u     // Part left raw
+#define CODEC_DEFLATE 1u // Part compressed
+#define CODEC_DICT 2u    // Part compressed with the dictionary
+
+//
+// @brief Write a little-endian word
+//
+static void codec_put(uint8_t *out, uint32_t value)
+{
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+//
+// @brief Read a little-endian word
+//
+static uint32_t codec_get(const uint8_t *data)
+{
+    return static_cast<uint32_t>(data[0]) |
+           (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) |
+           (static_cast<uint32_t>(data[3]) << 24);
+}
+
+//
+// @brief Replace the data of a part, allocated as buffer::push_back does
+//
+static void codec_part_set(struct buffer_part &part, char *data, size_t len)
+{
+    data[len] = '\0';
+    delete[] static_cast<char *>(part.data);
+    part.data = data;
+    part.len = len;
+}
+
+//
+// @brief Leave a part raw, behind a header
+//
+static void codec_part_raw(struct buffer_part &part)
+{
+    char *data;
+
+    data = new char[part.len + 2u];
+    data[0] = static_cast<char>(CODEC_RAW);
+    memcpy(&data[1], part.data, part.len);
+    codec_part_set(part, data, part.len + 1u);
+}
+
+//
+// @brief CPU time of the thread in nanoseconds
+//
+static unsigned long codec_cpu_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return static_cast<unsigned long>(ts.tv_sec) * 1000000000ul + static_cast<unsigned long>(ts.tv_nsec);
+}
+
+codec::codec(struct manager *mgr) : block(mgr),
+                                    mode_(CODEC_COMPRESS),
+                                    level_(CODEC_LEVEL),
+                                    min_size_(CODEC_MIN_SIZE),
+                                    part_mask_(CODEC_PART_MASK),
+                                    dict_path_(""),
+                                    dict_id_(0u),
+                                    is_init_(false),
+                                    msg_(0u),
+                                    bytes_in_(0u),
+                                    bytes_out_(0u),
+                                    skip_(0u),
+                                    error_(0u),
+                                    cpu_ns_(0u),
+                                    last_ns_(0u)
+{
+    memset(&deflate_, 0, sizeof(deflate_));
+    memset(&inflate_, 0, sizeof(inflate_));
+}
+codec::~codec()
+{
+    if (is_init_ == true)
+    {
+        deflateEnd(&deflate_);
+        inflateEnd(&inflate_);
+    }
+}
+
+//
+// @brief Initialize the streams, or initialize them again with a new level
+//
+bool codec::stream_init()
+{
+    if (is_init_ == true)
+    {
+        deflateEnd(&deflate_);
+        inflateEnd(&inflate_);
+        is_init_ = false;
+    }
+
+    memset(&deflate_, 0, sizeof(deflate_));
+    memset(&inflate_, 0, sizeof(inflate_));
+
+    if (deflateInit2(&deflate_, level_, Z_DEFLATED, CODEC_WINDOW_BITS, CODEC_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        LOGGER_ERR("Failed to initialize compression stream [bk_id=%d ; level=%d]", id_, level_);
+        return false;
+    }
+    if (inflateInit2(&inflate_, CODEC_WINDOW_BITS) != Z_OK)
+    {
+        LOGGER_ERR("Failed to initialize decompression stream [bk_id=%d]", id_);
+        deflateEnd(&deflate_);
+        return false;
+    }
+    is_init_ = true;
+
+    return true;
+}
+
+//
+// @brief Load a dictionary from a file, both sides must load the same one
+//
+// @param path : File of the dictionary, empty to use none
+//
+// Deflate only looks back 32 KiB: the end of a larger dictionary is used
+//
+bool codec::dict_load(const char *path)
+{
+    std::vector<uint8_t> dict;
+    uint8_t chunk[4096];
+    FILE *file;
+    size_t len;
+
+    if (path[0] == '\0')
+    {
+        dict_path_.clear();
+        dict_.clear();
+        dict_id_ = 0u;
+        return true;
+    }
+
+    file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        LOGGER_ERR("Failed to open dictionary: %s [errno=%d ; bk_id=%d ; path=%s]", strerror(errno), errno, id_, path);
+        return false;
+    }
+    while ((len = fread(chunk, 1u, sizeof(chunk), file)) != 0u)
+    {
+        dict.insert(dict.end(), chunk, chunk + len);
+    }
+    if (ferror(file) != 0)
+    {
+        LOGGER_ERR("Failed to read dictionary: %s [errno=%d ; bk_id=%d ; path=%s]", strerror(errno), errno, id_, path);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    if (dict.empty() == true)
+    {
+        LOGGER_ERR("Failed to load dictionary: empty file [bk_id=%d ; path=%s]", id_, path);
+        return false;
+    }
+
+    dict_path_ = std::string(path);
+    dict_.swap(dict);
+    dict_id_ = static_cast<uint32_t>(adler32(adler32(0ul, Z_NULL, 0u), dict_.data(), static_cast<uInt>(dict_.size())));
+
+    LOGGER_INFO("Loaded dictionary [bk_id=%d ; path=%s ; size=%zu ; dict_id=%08x]", id_, path, dict_.size(), dict_id_);
+
+    return true;
+}
+
+//
+// @brief Compress a part in place
+//
+// @return false if the part is left raw
+//
+bool codec::compress(struct buffer_part &part)
+{
+    size_t header;
+    size_t len;
+    char *data;
+    int ret;
+
+    if ((part.len < min_size_) || (part.len > CODEC_MAX_SIZE))
+    {
+        codec_part_raw(part);
+        return false;
+    }
+
+    deflateReset(&deflate_);
+    header = 1u + sizeof(uint32_t);
+    if (dict_.empty() == false)
+    {
+        deflateSetDictionary(&deflate_, dict_.data(), static_cast<uInt>(dict_.size()));
+        header += sizeof(uint32_t);
+    }
+
+    out_.resize(header + deflateBound(&deflate_, static_cast<uLong>(part.len)));
+    deflate_.next_in = static_cast<Bytef *>(part.data);
+    deflate_.avail_in = static_cast<uInt>(part.len);
+    deflate_.next_out = &out_[header];
+    deflate_.avail_out = static_cast<uInt>(out_.size() - header);
+
+    ret = deflate(&deflate_, Z_FINISH);
+    if (ret != Z_STREAM_END)
+    {
+        LOGGER_ERR("Failed to compress part: %s [bk_id=%d ; ret=%d]", (deflate_.msg != nullptr) ? deflate_.msg : "", id_, ret);
+        ++error_;
+        codec_part_raw(part);
+        return false;
+    }
+
+    // Not worth it
+    len = header + deflate_.total_out;
+    if (len >= part.len + 1u)
+    {
+        codec_part_raw(part);
+        return false;
+    }
+
+    out_[0] = (dict_.empty() == true) ? CODEC_DEFLATE : CODEC_DICT;
+    codec_put(&out_[1], static_cast<uint32_t>(part.len));
+    if (dict_.empty() == false)
+    {
+        codec_put(&out_[1u + sizeof(uint32_t)], dict_id_);
+    }
+
+    data = new char[len + 1u];
+    memcpy(data, out_.data(), len);
+    codec_part_set(part, data, len);
+
+    return true;
+}
+
+//
+// @brief Restore a part in place
+//
+// @return false if the part is malformed
+//
+bool codec::decompress(struct buffer_part &part)
+{
+    const uint8_t *in;
+    size_t header;
+    uint32_t len;
+    char *data;
+    int ret;
+
+    in = static_cast<const uint8_t *>(part.data);
+    if (part.len < 1u)
+    {
+        LOGGER_ERR("Failed to decompress part: empty part [bk_id=%d]", id_);
+        return false;
+    }
+
+    if (in[0] == CODEC_RAW)
+    {
+        data = new char[part.len];
+        memcpy(data, &in[1], part.len - 1u);
+        codec_part_set(part, data, part.len - 1u);
+        return true;
+    }
+
+    header = 1u + sizeof(uint32_t) + ((in[0] == CODEC_DICT) ? sizeof(uint32_t) : 0u);
+    if ((in[0] > CODEC_DICT) || (part.len < header))
+    {
+        LOGGER_ERR("Failed to decompress part: wrong header [bk_id=%d ; format=%u ; len=%zu]", id_, in[0], part.len);
+        return false;
+    }
+    len = codec_get(&in[1]);
+    if (len > CODEC_MAX_SIZE)
+    {
+        LOGGER_ERR("Failed to decompress part: part too large [bk_id=%d ; len=%u]", id_, len);
+        return false;
+    }
+
+    inflateReset(&inflate_);
+    if (in[0] == CODEC_DICT)
+    {
+        if ((dict_.empty() == true) || (codec_get(&in[1u + sizeof(uint32_t)]) != dict_id_))
+        {
+            LOGGER_ERR("Failed to decompress part: unknown dictionary [bk_id=%d ; dict_id=%08x]",
+                       id_, codec_get(&in[1u + sizeof(uint32_t)]));
+            return false;
+        }
+        inflateSetDictionary(&inflate_, dict_.data(), static_cast<uInt>(dict_.size()));
+    }
+
+    data = new char[len + 1u];
+    inflate_.next_in = const_cast<Bytef *>(&in[header]);
+    inflate_.avail_in = static_cast<uInt>(part.len - header);
+    inflate_.next_out = reinterpret_cast<Bytef *>(data);
+    inflate_.avail_out = len;
+
+    ret = inflate(&inflate_, Z_FINISH);
+    if ((ret != Z_STREAM_END) || (inflate_.total_out != len))
+    {
+        LOGGER_ERR("Failed to decompress part: %s [bk_id=%d ; ret=%d]", (inflate_.msg != nullptr) ? inflate_.msg : "", id_, ret);
+        delete[] data;
+        return false;
+    }
+    codec_part_set(part, data, len);
+
+    return true;
+}
+
+//
+// Implementation of the block interface
+//
+
+bool codec::data_(void *vdata)
+{
+    unsigned long start;
+    bool is_ok;
+
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to process data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    struct buffer &buf = *(static_cast<struct buffer *>(vdata));
+
+    if ((is_init_ == false) && (stream_init() == false))
+    {
+        ++error_;
+        return false;
+    }
+
+    start = codec_cpu_ns();
+    is_ok = true;
+    for (size_t i = 0u; (i < buf.parts_.size()) && (i < 32u) && (is_ok == true); ++i)
+    {
+        if ((part_mask_ & (1u << i)) == 0u)
+        {
+            continue;
+        }
+
+        bytes_in_ += buf.parts_[i].len;
+        if (mode_ == CODEC_COMPRESS)
+        {
+            if (compress(buf.parts_[i]) == false)
+            {
+                ++skip_;
+            }
+        }
+        else
+        {
+            is_ok = decompress(buf.parts_[i]);
+        }
+        bytes_out_ += buf.parts_[i].len;
+    }
+    last_ns_ = codec_cpu_ns() - start;
+    cpu_ns_ += last_ns_;
+    ++msg_;
+
+    if (is_ok == false)
+    {
+        ++error_;
+        return false;
+    }
+
+    LOGGER_DEBUG("Processed buffer [bk_id=%d ; mode=%d ; cpu_ns=%lu ; bytes_in=%lu ; bytes_out=%lu]",
+                 id_, mode_, last_ns_, bytes_in_, bytes_out_);
+
+    return true;
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *codec_factory::constructor(struct manager *mgr)
+{
+    return new struct codec(mgr);
+}
+
+void codec_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct codec *>(bk);
+}
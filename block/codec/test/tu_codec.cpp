@@ -0,0 +1,202 @@
+//
+// @brief Test file for the codec block
+//
+
+// Project headers
+#include "block/codec.hpp"
+#include "engine/tu.hpp"
+
+struct manager mgr_;
+
+//
+// @brief Payload repeating the fields of a message, as the ones of an application
+//
+static std::string tu_codec_payload(int seq, size_t size)
+{
+    std::string payload;
+
+    while (payload.size() < size)
+    {
+        payload += "{\"sequence\":" + std::to_string(seq++) + ",\"status\":\"running\",\"source\":\"c3qo\"}";
+    }
+    payload.resize(size);
+
+    return payload;
+}
+
+//
+// @brief Compress then decompress a message made of a topic and a payload
+//
+// @return Size of the compressed payload
+//
+static size_t tu_codec_roundtrip(struct codec &enc, struct codec &dec, const std::string &payload)
+{
+    struct buffer buf;
+    size_t len;
+
+    buf.push_back("TOPIC", strlen("TOPIC"));
+    buf.push_back(payload.data(), payload.size());
+
+    ASSERT(enc.data_(&buf) == true);
+    ASSERT(buf.parts_.size() == 2u);
+    len = buf.parts_[1].len;
+
+    ASSERT(dec.data_(&buf) == true);
+    ASSERT(std::string(static_cast<const char *>(buf.parts_[0].data), buf.parts_[0].len) == "TOPIC");
+    ASSERT(std::string(static_cast<const char *>(buf.parts_[1].data), buf.parts_[1].len) == payload);
+    ASSERT(static_cast<const char *>(buf.parts_[1].data)[buf.parts_[1].len] == '\0');
+    buf.clear();
+
+    return len;
+}
+
+static void tu_codec_compress()
+{
+    struct codec enc(&mgr_);
+    struct codec dec(&mgr_);
+    std::string payload;
+
+    dec.mode_ = CODEC_DECOMPRESS;
+
+    // Repetitive payload shrinks
+    payload = tu_codec_payload(0, 4096u);
+    ASSERT(tu_codec_roundtrip(enc, dec, payload) < payload.size() / 4u);
+    ASSERT(enc.msg_ == 1u);
+    ASSERT(enc.bytes_out_ < enc.bytes_in_);
+    ASSERT(enc.skip_ == 0u);
+
+    // Small payload is left raw, behind its header
+    payload = tu_codec_payload(0, 64u);
+    ASSERT(tu_codec_roundtrip(enc, dec, payload) == payload.size() + 1u);
+    ASSERT(enc.skip_ == 1u);
+
+    // Random payload does not shrink
+    payload.clear();
+    for (int i = 0; i < 1024; ++i)
+    {
+        payload.push_back(static_cast<char>(rand()));
+    }
+    ASSERT(tu_codec_roundtrip(enc, dec, payload) == payload.size() + 1u);
+    ASSERT(enc.skip_ == 2u);
+
+    // Every part
+    enc.part_mask_ = 0xffffffffu;
+    dec.part_mask_ = 0xffffffffu;
+    payload = tu_codec_payload(0, 512u);
+    tu_codec_roundtrip(enc, dec, payload);
+
+    // Another level
+    enc.level_ = 9;
+    ASSERT(enc.stream_init() == true);
+    payload = tu_codec_payload(0, 4096u);
+    ASSERT(tu_codec_roundtrip(enc, dec, payload) < payload.size() / 4u);
+
+    ASSERT(enc.error_ == 0u);
+    ASSERT(dec.error_ == 0u);
+}
+
+//
+// @brief A dictionary of the common fields helps small messages
+//
+static void tu_codec_dictionary()
+{
+    const char *path = "/tmp/tu_codec.dict";
+    struct codec enc(&mgr_);
+    struct codec dec(&mgr_);
+    std::string payload;
+    std::string dict;
+    size_t plain;
+    FILE *file;
+
+    dec.mode_ = CODEC_DECOMPRESS;
+
+    dict = tu_codec_payload(1000, 1024u);
+    file = fopen(path, "w");
+    ASSERT(file != nullptr);
+    fwrite(dict.data(), 1u, dict.size(), file);
+    fclose(file);
+
+    payload = tu_codec_payload(2000, 192u);
+    plain = tu_codec_roundtrip(enc, dec, payload);
+
+    ASSERT(enc.dict_load(path) == true);
+    ASSERT(enc.dict_.size() == dict.size());
+
+    // Decompression requires the same dictionary
+    {
+        struct buffer buf;
+
+        buf.push_back("TOPIC", strlen("TOPIC"));
+        buf.push_back(payload.data(), payload.size());
+        ASSERT(enc.data_(&buf) == true);
+        ASSERT(dec.data_(&buf) == false);
+        ASSERT(dec.error_ == 1u);
+        buf.clear();
+    }
+
+    ASSERT(dec.dict_load(path) == true);
+    ASSERT(tu_codec_roundtrip(enc, dec, payload) < plain);
+
+    // No dictionary
+    ASSERT(enc.dict_load("") == true);
+    ASSERT(enc.dict_.empty() == true);
+    ASSERT(tu_codec_roundtrip(enc, dec, payload) == plain);
+
+    // Errors
+    ASSERT(enc.dict_load("/tmp/tu_codec.nonexistent") == false);
+    file = fopen(path, "w");
+    ASSERT(file != nullptr);
+    fclose(file);
+    ASSERT(enc.dict_load(path) == false);
+
+    remove(path);
+}
+
+static void tu_codec_errors()
+{
+    struct codec dec(&mgr_);
+    struct buffer buf;
+    const uint8_t wrong_format[] = {7u, 0u, 0u, 0u, 0u};
+    const uint8_t truncated[] = {1u, 0u, 1u};
+    const uint8_t too_large[] = {1u, 0u, 0u, 0u, 0x80u};
+    const uint8_t garbage[] = {1u, 16u, 0u, 0u, 0u, 0xffu, 0xffu, 0xffu};
+
+    dec.mode_ = CODEC_DECOMPRESS;
+    dec.part_mask_ = 0xffffffffu;
+
+    ASSERT(dec.data_(nullptr) == false);
+
+    buf.push_back("", 0u);
+    ASSERT(dec.data_(&buf) == false);
+    buf.clear();
+
+    buf.push_back(wrong_format, sizeof(wrong_format));
+    ASSERT(dec.data_(&buf) == false);
+    buf.clear();
+
+    buf.push_back(truncated, sizeof(truncated));
+    ASSERT(dec.data_(&buf) == false);
+    buf.clear();
+
+    buf.push_back(too_large, sizeof(too_large));
+    ASSERT(dec.data_(&buf) == false);
+    buf.clear();
+
+    buf.push_back(garbage, sizeof(garbage));
+    ASSERT(dec.data_(&buf) == false);
+    buf.clear();
+
+    ASSERT(dec.error_ == 5u);
+}
+
+int main(int, char **)
+{
+    LOGGER_OPEN("tu_codec");
+
+    tu_codec_compress();
+    tu_codec_dictionary();
+    tu_codec_errors();
+
+    LOGGER_CLOSE();
+    return 0;
+}
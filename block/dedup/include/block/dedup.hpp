@@ -0,0 +1,71 @@
+#ifndef DEDUP_HPP
+#define DEDUP_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+#define DEDUP_GENERATIONS 4u                                       // Generations of the filter, one of them receives the new fingerprints
+#define DEDUP_MIN_WORDS 64u                                        // Smallest generation, in words
+#define DEDUP_MIN_BYTES (DEDUP_MIN_WORDS * 8u * DEDUP_GENERATIONS) // Smallest memory of the filter
+
+//
+// @struct dedup
+//
+// @brief Drop the repeats of a message within a time window.
+//
+// Messages are fingerprinted with a 64-bit hash of some of their parts, and
+// looked up in a rotating Bloom filter made of generations. Messages without
+// any of these parts pass. The oldest
+// generation is cleared and receives the new fingerprints every
+// window / (generations - 1): a fingerprint is remembered for the window at
+// least. A lookup tests every generation: each one is sized for a share of
+// the false positive rate. A generation reaching its capacity rotates early,
+// to keep the false positive rate, and shortens the window
+//
+struct dedup : block
+{
+    uint32_t part_mask_; // Parts fingerprinted, bit i for part i
+    long window_ms_;     // Repeats are dropped within this window, at least
+    double fp_rate_;     // False positive rate of a lookup, with the generations at capacity
+    size_t max_bytes_;   // Memory of the filter, DEDUP_MIN_BYTES at least
+
+    size_t bits_;                  // Bits of a generation, a power of two
+    size_t hashes_;                // Bits set per fingerprint
+    size_t capacity_;              // Fingerprints of a generation at the false positive rate
+    std::vector<uint64_t> filter_; // Bits of the generations, one after the other
+    size_t cur_;                   // Generation receiving the new fingerprints
+    size_t count_;                 // Fingerprints in the current generation
+
+    unsigned long msg_;         // Messages received
+    unsigned long pass_;        // Messages forwarded
+    unsigned long dup_;         // Messages dropped as repeats
+    unsigned long rotate_;      // Rotations of the filter
+    unsigned long rotate_full_; // Rotations of a generation at capacity, before the timer
+
+    void limits_update();
+    bool fingerprint(const struct buffer &buf, uint64_t &fp) const;
+    bool check(uint64_t fp);
+    void rotate();
+    void timer_arm();
+
+    //
+    // Implementation of the block interface
+    //
+    explicit dedup(struct manager *mgr);
+    virtual ~dedup() override final;
+
+    virtual void start_() override final;
+    virtual void stop_() override final;
+
+    virtual bool data_(void *vdata) override final;
+
+    virtual void on_timer_(struct timer &tm) override final;
+};
+
+struct dedup_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+#endif // DEDUP_HPP
@@ -0,0 +1,275 @@
+// Project headers
+#include "block/dedup.hpp"
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+
+// C++ headers
+#include <algorithm>
+#include <cmath>
+
+#define DEDUP_PART_MASK 0xffffffffu // Default parts fingerprinted: all of them
+#define DEDUP_WINDOW_MS 1000l       // Default window
+#define DEDUP_FP_RATE 0.001         // Default false positive rate
+#define DEDUP_MAX_BYTES (1u << 20)  // Default memory of the filter
+
+dedup::dedup(struct manager *mgr) : block(mgr),
+                                    part_mask_(DEDUP_PART_MASK),
+                                    window_ms_(DEDUP_WINDOW_MS),
+                                    fp_rate_(DEDUP_FP_RATE),
+                                    max_bytes_(DEDUP_MAX_BYTES),
+                                    bits_(0u),
+                                    hashes_(0u),
+                                    capacity_(0u),
+                                    cur_(0u),
+                                    count_(0u),
+                                    msg_(0u),
+                                    pass_(0u),
+                                    dup_(0u),
+                                    rotate_(0u),
+                                    rotate_full_(0u)
+{
+    limits_update();
+}
+dedup::~dedup()
+{
+    // A replacement block shares the timer identifier: only the timers of this block are removed
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+}
+
+//
+// @brief Size the filter from the limits, once they are set. Fingerprints are forgotten
+//
+// A lookup is a false positive if any generation gives one: each generation
+// gets the rate p = fp_rate / generations. For m bits per generation, the best
+// number of hashes is -log2(p), for a capacity of m * ln(2)^2 / -ln(p) fingerprints
+//
+void dedup::limits_update()
+{
+    double gen_fp_rate;
+    size_t words;
+
+    if ((fp_rate_ <= 0.0) || (fp_rate_ >= 1.0))
+    {
+        fp_rate_ = DEDUP_FP_RATE;
+    }
+    if (window_ms_ <= 0)
+    {
+        window_ms_ = DEDUP_WINDOW_MS;
+    }
+    if (max_bytes_ < DEDUP_MIN_BYTES)
+    {
+        max_bytes_ = DEDUP_MIN_BYTES;
+    }
+
+    // Generations are a power of two of words, for the bits to be found with a mask
+    words = DEDUP_MIN_WORDS;
+    while (2u * words * sizeof(uint64_t) * DEDUP_GENERATIONS <= max_bytes_)
+    {
+        words *= 2u;
+    }
+
+    bits_ = words * 64u;
+    gen_fp_rate = fp_rate_ / DEDUP_GENERATIONS;
+    hashes_ = static_cast<size_t>(std::max(1.0, std::round(-std::log2(gen_fp_rate))));
+    capacity_ = static_cast<size_t>(static_cast<double>(bits_) * std::log(2.0) * std::log(2.0) / -std::log(gen_fp_rate));
+    if (capacity_ == 0u)
+    {
+        capacity_ = 1u;
+    }
+
+    filter_.assign(words * DEDUP_GENERATIONS, 0u);
+    cur_ = 0u;
+    count_ = 0u;
+
+    LOGGER_DEBUG("Sized filter [bk_id=%d ; bits=%zu ; hashes=%zu ; capacity=%zu]", id_, bits_, hashes_, capacity_);
+}
+
+//
+// @brief Hash the selected parts of a message, each one seeded with the hash of the previous ones
+//
+// @return false if none of the selected parts is in the message
+//
+bool dedup::fingerprint(const struct buffer &buf, uint64_t &fp) const
+{
+    bool is_found;
+
+    fp = 0u;
+    is_found = false;
+    for (size_t i = 0u; (i < buf.parts_.size()) && (i < 32u); ++i)
+    {
+        if ((part_mask_ & (1u << i)) == 0u)
+        {
+            continue;
+        }
+
+        fp = buffer_hash(buf.parts_[i].data, buf.parts_[i].len, fp ^ i);
+        is_found = true;
+    }
+
+    return is_found;
+}
+
+//
+// @brief Look for a fingerprint in the generations, and add it to the current one if new
+//
+// @return true if the fingerprint was seen
+//
+bool dedup::check(uint64_t fp)
+{
+    uint64_t h1;
+    uint64_t h2;
+    size_t words;
+    size_t mask;
+
+    // Bits are derived from two halves of the fingerprint
+    h1 = fp;
+    h2 = ((fp >> 32) | (fp << 32)) | 1u;
+    words = bits_ / 64u;
+    mask = bits_ - 1u;
+
+    for (size_t g = 0u; g < DEDUP_GENERATIONS; ++g)
+    {
+        const uint64_t *gen = &filter_[g * words];
+        size_t i;
+
+        for (i = 0u; i < hashes_; ++i)
+        {
+            size_t bit = static_cast<size_t>(h1 + i * h2) & mask;
+
+            if ((gen[bit / 64u] & (1ull << (bit % 64u))) == 0u)
+            {
+                break;
+            }
+        }
+        if (i == hashes_)
+        {
+            return true;
+        }
+    }
+
+    if (count_ >= capacity_)
+    {
+        ++rotate_full_;
+        rotate();
+    }
+
+    uint64_t *gen = &filter_[cur_ * words];
+    for (size_t i = 0u; i < hashes_; ++i)
+    {
+        size_t bit = static_cast<size_t>(h1 + i * h2) & mask;
+
+        gen[bit / 64u] |= 1ull << (bit % 64u);
+    }
+    ++count_;
+
+    return false;
+}
+
+//
+// @brief Clear the oldest generation, it receives the new fingerprints
+//
+void dedup::rotate()
+{
+    size_t words;
+
+    words = bits_ / 64u;
+    cur_ = (cur_ + 1u) % DEDUP_GENERATIONS;
+    std::fill(filter_.begin() + static_cast<long>(cur_ * words), filter_.begin() + static_cast<long>((cur_ + 1u) * words), 0u);
+    count_ = 0u;
+    ++rotate_;
+}
+
+//
+// @brief Arm the rotation timer
+//
+void dedup::timer_arm()
+{
+    struct timer tm;
+    long period_ms;
+
+    period_ms = window_ms_ / static_cast<long>(DEDUP_GENERATIONS - 1u);
+    if (period_ms <= 0)
+    {
+        period_ms = 1;
+    }
+
+    tm.bk = this;
+    tm.arg = nullptr;
+    tm.tid = id_;
+    tm.time.tv_sec = period_ms / 1000;
+    tm.time.tv_nsec = (period_ms % 1000) * 1000000;
+    mgr_->timer_add(tm);
+}
+
+//
+// Implementation of the block interface
+//
+
+void dedup::start_()
+{
+    timer_arm();
+}
+
+//
+// @brief Fingerprints are kept, but they are not forgotten while the block is stopped
+//
+void dedup::stop_()
+{
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+}
+
+bool dedup::data_(void *vdata)
+{
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to deduplicate data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    const struct buffer &buf = *(static_cast<const struct buffer *>(vdata));
+    uint64_t fp;
+
+    ++msg_;
+
+    // Nothing to tell the messages apart
+    if (fingerprint(buf, fp) == false)
+    {
+        LOGGER_DEBUG("Pass message: no part to fingerprint [bk_id=%d ; parts_count=%zu]", id_, buf.parts_.size());
+        ++pass_;
+        return true;
+    }
+
+    if (check(fp) == true)
+    {
+        LOGGER_DEBUG("Drop message: repeat [bk_id=%d]", id_);
+        ++dup_;
+        return false;
+    }
+    ++pass_;
+
+    return true;
+}
+
+void dedup::on_timer_(struct timer &)
+{
+    rotate();
+
+    if (is_started_ == true)
+    {
+        timer_arm();
+    }
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *dedup_factory::constructor(struct manager *mgr)
+{
+    return new struct dedup(mgr);
+}
+
+void dedup_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct dedup *>(bk);
+}
@@ -0,0 +1,168 @@
+//
+// @brief Test file for the dedup block
+//
+
+// Project headers
+#include "block/dedup.hpp"
+#include "block/hello.hpp"
+#include "engine/tu.hpp"
+
+struct manager mgr_;
+
+//
+// @brief Rotate the filter as the timer would
+//
+static void tu_dedup_rotate(struct dedup *dd)
+{
+    struct timer tm;
+
+    tm.bk = dd;
+    tm.arg = nullptr;
+    tm.tid = dd->id_;
+    dd->on_timer_(tm);
+}
+
+static void tu_dedup_window()
+{
+    struct dedup *dd;
+
+    dd = static_cast<struct dedup *>(tu_block_add(mgr_, 1, "dedup", 1));
+
+    // Repeats are dropped
+    tu_block_send(mgr_.block_get(1), {"A", "1"});
+    tu_block_send(mgr_.block_get(1), {"A", "1"});
+    tu_block_send(mgr_.block_get(1), {"A", "2"});
+    tu_block_send(mgr_.block_get(1), {"B", "1"});
+    tu_block_send(mgr_.block_get(1), {"B", "1"});
+    ASSERT(tu_block_count(mgr_, 2) == 3u);
+    ASSERT(dd->msg_ == 5u);
+    ASSERT(dd->pass_ == 3u);
+    ASSERT(dd->dup_ == 2u);
+
+    // Fingerprints are remembered for the window
+    for (size_t i = 0u; i < DEDUP_GENERATIONS - 1u; ++i)
+    {
+        tu_dedup_rotate(dd);
+        tu_block_send(mgr_.block_get(1), {"A", "1"});
+    }
+    ASSERT(tu_block_count(mgr_, 2) == 3u);
+
+    // Then forgotten
+    tu_dedup_rotate(dd);
+    tu_block_send(mgr_.block_get(1), {"A", "1"});
+    ASSERT(tu_block_count(mgr_, 2) == 4u);
+    ASSERT(dd->rotate_ == DEDUP_GENERATIONS);
+
+    // Only the topic is fingerprinted
+    dd->part_mask_ = 0x1u;
+    tu_block_send(mgr_.block_get(1), {"C", "1"});
+    tu_block_send(mgr_.block_get(1), {"C", "2"});
+    ASSERT(tu_block_count(mgr_, 2) == 5u);
+
+    // Messages without the parts fingerprinted pass
+    dd->part_mask_ = 0x4u;
+    tu_block_send(mgr_.block_get(1), {"C", "1"});
+    tu_block_send(mgr_.block_get(1), {"C", "1"});
+    ASSERT(tu_block_count(mgr_, 2) == 7u);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief False positive rate of a lookup, with the generations at capacity
+//
+static void tu_dedup_fp_rate()
+{
+    struct dedup *dd;
+    size_t capacity;
+    unsigned long dup;
+
+    dd = static_cast<struct dedup *>(tu_block_add(mgr_, 1, "dedup", 1));
+    dd->fp_rate_ = 0.01;
+    dd->max_bytes_ = 64u * 1024u;
+    dd->limits_update();
+    ASSERT(dd->hashes_ == 9u);
+    ASSERT(dd->filter_.size() * sizeof(uint64_t) <= dd->max_bytes_);
+
+    // Fill the older generations, the lookups go through all of them
+    capacity = dd->capacity_;
+    for (size_t gen = 1u; gen < DEDUP_GENERATIONS; ++gen)
+    {
+        for (size_t i = 0u; i < capacity; ++i)
+        {
+            tu_block_send(mgr_.block_get(1), {"FILL", std::to_string(gen * capacity + i)});
+        }
+        dd->rotate();
+    }
+    ASSERT(dd->rotate_full_ == 0u);
+
+    // New messages are seldom taken for repeats
+    dup = dd->dup_;
+    for (size_t i = 0u; i < 5000u; ++i)
+    {
+        tu_block_send(mgr_.block_get(1), {"TEST", std::to_string(i)});
+    }
+    ASSERT(dd->dup_ - dup < 5000u / 100u);
+
+    // Generation at capacity rotates
+    dd->count_ = dd->capacity_;
+    tu_block_send(mgr_.block_get(1), {"FULL", ""});
+    ASSERT(dd->rotate_full_ == 1u);
+    ASSERT(dd->count_ == 1u);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Rotation timer of a started block
+//
+static void tu_dedup_timer()
+{
+    struct dedup *dd;
+
+    dd = static_cast<struct dedup *>(tu_block_add(mgr_, 1, "dedup", 1));
+    dd->window_ms_ = 3;
+    ASSERT(mgr_.block_start(1) == true);
+    ASSERT(mgr_.tm_list_.empty() == false);
+
+    usleep(2 * 1000);
+    mgr_.timer_check_exp();
+    ASSERT(dd->rotate_ == 1u);
+    ASSERT(mgr_.tm_list_.empty() == false);
+
+    ASSERT(mgr_.block_stop(1) == true);
+    ASSERT(mgr_.tm_list_.empty() == true);
+
+    // Errors
+    ASSERT(dd->data_(nullptr) == false);
+    dd->fp_rate_ = 1.5;
+    dd->window_ms_ = 0;
+    dd->max_bytes_ = 0u;
+    dd->limits_update();
+    ASSERT(dd->fp_rate_ < 1.0);
+    ASSERT(dd->window_ms_ > 0);
+    ASSERT(dd->max_bytes_ == DEDUP_MIN_BYTES);
+    ASSERT(dd->bits_ == DEDUP_MIN_WORDS * 64u);
+
+    mgr_.block_clear();
+}
+
+int main(int, char **)
+{
+    struct dedup_factory dedup_f;
+    struct hello_factory hello_f;
+
+    LOGGER_OPEN("tu_dedup");
+
+    mgr_.block_factory_register("dedup", &dedup_f);
+    mgr_.block_factory_register("hello", &hello_f);
+
+    tu_dedup_window();
+    tu_dedup_fp_rate();
+    tu_dedup_timer();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -4,6 +4,18 @@
 // Project headers
 #include "engine/block.hpp"
 
+// C++ headers
+#include <deque>
+
+//
+// @struct hook_zmq
+//
+// @brief Exchange messages with a ZMQ socket
+//
+// With flow control, messages the congested peer cannot take are held, one
+// credit each, and sent once the socket is writable again. Out of credits,
+// the blocks sending to the hook are paused; a paused hook stops reading
+//
 struct hook_zmq : block
 {
     // Context
@@ -15,23 +27,39 @@ struct hook_zmq : block
     int type_;         // ZMQ socket type
     std::string name_; // identity of this hook
     std::string addr_; // address to connect or bind
+    void *ctx_;        // context shared with other hooks (inproc), nullptr to own one
+
+    // Deadline stamped on the received messages, 0 for none
+    long deadline_us_;
+
+    // Scheduling of the ZMQ I/O thread
+    std::vector<int> io_cpu_; // CPUs to run on, empty to keep the affinity
+    int io_priority_;         // SCHED_FIFO priority, 0 to keep the default policy
+
+    // Messages held while the peer is congested
+    std::deque<struct buffer> tx_queue_;
 
     // Statistics
     unsigned long rx_pkt_;
     unsigned long tx_pkt_;
+    unsigned long tx_drop_; // Messages not sent: failure, or peer congested without credit left
 
     bool send_(struct buffer &buf);
     bool recv_(struct buffer &buf);
+    void flush_();
+    void poll_update_();
 
     explicit hook_zmq(struct manager *mgr);
     virtual ~hook_zmq() override final;
 
     virtual void start_() override final;
     virtual void stop_() override final;
+    virtual void transfer_(struct block *old_bk) override final;
 
     virtual bool data_(void *vdata) override final;
 
     virtual void on_fd_(struct file_desc &fd) override final;
+    virtual void on_flow_(bool is_paused) override final;
 };
 
 struct hook_zmq_factory : block_factory
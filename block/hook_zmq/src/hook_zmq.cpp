@@ -4,17 +4,38 @@
 #include "block/hook_zmq.hpp"
 #include "engine/manager.hpp"
 
+// C headers
+extern "C"
+{
+#include <sched.h>
+}
+
 hook_zmq::hook_zmq(struct manager *mgr) : block(mgr),
                                           client_(false),
                                           type_(ZMQ_PAIR),
                                           name_(""),
                                           addr_("tcp://127.0.0.1:6666"),
+                                          ctx_(nullptr),
+                                          deadline_us_(0),
+                                          io_priority_(0),
                                           rx_pkt_(0u),
-                                          tx_pkt_(0u)
+                                          tx_pkt_(0u),
+                                          tx_drop_(0u)
 {
+    zmq_sock_.bk = this;
+    zmq_sock_.fd = -1;
+    zmq_sock_.socket = nullptr;
+    zmq_sock_.read = true;
+    zmq_sock_.write = false;
 }
 
-hook_zmq::~hook_zmq() {}
+hook_zmq::~hook_zmq()
+{
+    for (auto &buf : tx_queue_)
+    {
+        buf.clear();
+    }
+}
 
 //
 // @brief Receive a ZMQ multi-parts message
@@ -50,6 +71,8 @@ bool hook_zmq::recv_(struct buffer &buf)
 //
 // @brief Send a ZMQ multi-part message
 //
+// @return false on failure, errno is EAGAIN if the peer is congested
+//
 bool hook_zmq::send_(struct buffer &buf)
 {
     int flags = ZMQ_DONTWAIT | ZMQ_SNDMORE;
@@ -70,8 +93,14 @@ bool hook_zmq::send_(struct buffer &buf)
         rc = zmq_msg_send(&message, zmq_sock_.socket, flags);
         if (rc == -1)
         {
-            LOGGER_ERR("Failed to send ZMQ message: %s [errno=%d]", strerror(errno), errno);
+            int error = errno;
+
+            if (error != EAGAIN)
+            {
+                LOGGER_ERR("Failed to send ZMQ message: %s [errno=%d]", strerror(error), error);
+            }
             zmq_msg_close(&message);
+            errno = error;
             return false;
         }
     }
@@ -79,11 +108,84 @@ bool hook_zmq::send_(struct buffer &buf)
 }
 
 //
-// @brief Callback to handle data available on the socket
+// @brief Send the held messages in order, while the peer takes them
+//
+void hook_zmq::flush_()
+{
+    uint64_t now_ns;
+    long released;
+
+    now_ns = buffer_now_ns();
+    released = 0;
+    while (tx_queue_.empty() == false)
+    {
+        struct buffer &buf = tx_queue_.front();
+
+        if (buf.is_expired(now_ns) == true)
+        {
+            ++data_expired_;
+        }
+        else if (send_(buf) == true)
+        {
+            ++tx_pkt_;
+        }
+        else if (errno == EAGAIN)
+        {
+            // Peer still congested
+            break;
+        }
+        else
+        {
+            ++tx_drop_;
+        }
+
+        buf.clear();
+        tx_queue_.pop_front();
+        ++released;
+    }
+
+    LOGGER_DEBUG("Sent held messages [bk_id=%d ; released=%ld ; held=%zu]", id_, released, tx_queue_.size());
+
+    if (tx_queue_.empty() == true)
+    {
+        poll_update_();
+    }
+    credit_give_(released);
+}
+
+//
+// @brief Update the events polled on the socket: read unless paused, write while messages are held
+//
+void hook_zmq::poll_update_()
+{
+    zmq_sock_.read = (flow_hold_ == 0u);
+    zmq_sock_.write = (tx_queue_.empty() == false);
+
+    // Not registered while stopped
+    if (mgr_->fd_find(zmq_sock_.fd, zmq_sock_.socket) != -1)
+    {
+        mgr_->fd_add(zmq_sock_);
+    }
+}
+
+//
+// @brief Stop reading while a sink downstream is out of credits
+//
+void hook_zmq::on_flow_(bool is_paused)
+{
+    LOGGER_DEBUG("%s reading [bk_id=%d]", (is_paused == true) ? "Paused" : "Resumed", id_);
+
+    poll_update_();
+}
+
+//
+// @brief Callback to handle the socket ready to receive or to send
 //
 void hook_zmq::on_fd_(struct file_desc &fd)
 {
     struct buffer buf;
+    size_t size;
+    int events;
 
     if (fd.socket != zmq_sock_.socket)
     {
@@ -93,10 +195,27 @@ void hook_zmq::on_fd_(struct file_desc &fd)
         return;
     }
 
+    // Look for the events of the socket
+    size = sizeof(events);
+    if (zmq_getsockopt(zmq_sock_.socket, ZMQ_EVENTS, &events, &size) != 0)
+    {
+        LOGGER_ERR("Failed to get ZMQ_EVENTS: %s [errno=%d ; bk_id=%d]", strerror(errno), errno, id_);
+        return;
+    }
+    if (((events & ZMQ_POLLOUT) != 0) && (tx_queue_.empty() == false))
+    {
+        flush_();
+    }
+    if (((events & ZMQ_POLLIN) == 0) || (zmq_sock_.read == false))
+    {
+        return;
+    }
+
     bool is_ok = recv_(buf);
     if (is_ok == true)
     {
         ++rx_pkt_;
+        buf.deadline_set(deadline_us_);
 
         LOGGER_DEBUG("Received message [bk_id=%d ; parts_count=%zu]", id_, buf.parts_.size());
 
@@ -114,10 +233,34 @@ void hook_zmq::start_()
 {
     int ret;
 
-    // Create a ZMQ context
-    zmq_ctx_ = zmq_ctx_new();
+    // Create a ZMQ context, unless it is shared
+    zmq_ctx_ = (ctx_ != nullptr) ? ctx_ : zmq_ctx_new();
     ASSERT(zmq_ctx_ != nullptr);
 
+    // Schedule the I/O thread, before the first socket starts it
+    for (int cpu : io_cpu_)
+    {
+        ret = zmq_ctx_set(zmq_ctx_, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu);
+        if (ret != 0)
+        {
+            LOGGER_ERR("Failed to set ZMQ_THREAD_AFFINITY_CPU_ADD: %s [errno=%d ; bk_id=%d ; cpu=%d]",
+                       strerror(errno), errno, id_, cpu);
+        }
+    }
+    if (io_priority_ != 0)
+    {
+        ret = zmq_ctx_set(zmq_ctx_, ZMQ_THREAD_SCHED_POLICY, SCHED_FIFO);
+        if (ret == 0)
+        {
+            ret = zmq_ctx_set(zmq_ctx_, ZMQ_THREAD_PRIORITY, io_priority_);
+        }
+        if (ret != 0)
+        {
+            LOGGER_ERR("Failed to set ZMQ I/O thread priority: %s [errno=%d ; bk_id=%d ; priority=%d]",
+                       strerror(errno), errno, id_, io_priority_);
+        }
+    }
+
     // Create the socket
     zmq_sock_.socket = zmq_socket(zmq_ctx_, type_);
     if (zmq_sock_.socket == nullptr)
@@ -165,11 +308,11 @@ void hook_zmq::start_()
         LOGGER_DEBUG("Bound server socket [bk_id=%d ; addr=%s]", id_, addr_.c_str());
     }
 
-    // Register a callback for reception
+    // Register a callback for reception, unless a sink downstream is out of credits
     zmq_sock_.bk = this;
     zmq_sock_.fd = -1;
-    zmq_sock_.read = true;
-    zmq_sock_.write = false;
+    zmq_sock_.read = (flow_hold_ == 0u);
+    zmq_sock_.write = (tx_queue_.empty() == false);
     mgr_->fd_add(zmq_sock_);
 
     // Send a first message to register identity
@@ -196,15 +339,60 @@ void hook_zmq::stop_()
     // Remove the socket's callback
     mgr_->fd_remove(zmq_sock_);
 
+    // Held messages are lost
+    for (auto &buf : tx_queue_)
+    {
+        buf.clear();
+    }
+    tx_drop_ += tx_queue_.size();
+    credit_give_(static_cast<long>(tx_queue_.size()));
+    tx_queue_.clear();
+
     // Close the socket
     zmq_close(zmq_sock_.socket);
 
-    // Delete the context
-    zmq_ctx_term(zmq_ctx_);
+    // Delete the context, unless it is shared
+    if (ctx_ == nullptr)
+    {
+        zmq_ctx_term(zmq_ctx_);
+    }
 
     LOGGER_INFO("Stopped ZMQ hook [bk_id=%d]", id_);
 }
 
+//
+// @brief Take over the configuration and the held messages of a hook replaced
+//
+// Held messages keep their credits, they are sent on the socket of the new hook
+//
+void hook_zmq::transfer_(struct block *old_bk)
+{
+    struct hook_zmq *old_hook;
+
+    if (old_bk->type_ != block::type_)
+    {
+        return;
+    }
+    old_hook = static_cast<struct hook_zmq *>(old_bk);
+
+    client_ = old_hook->client_;
+    type_ = old_hook->type_;
+    name_ = old_hook->name_;
+    addr_ = old_hook->addr_;
+    ctx_ = old_hook->ctx_;
+    deadline_us_ = old_hook->deadline_us_;
+    io_cpu_ = old_hook->io_cpu_;
+    io_priority_ = old_hook->io_priority_;
+
+    credit_max_ = old_hook->credit_max_;
+    credit_ = old_hook->credit_;
+    tx_queue_.swap(old_hook->tx_queue_);
+
+    rx_pkt_ = old_hook->rx_pkt_;
+    tx_pkt_ = old_hook->tx_pkt_;
+    tx_drop_ = old_hook->tx_drop_;
+}
+
 //
 // @brief Send data to the exterior
 //
@@ -219,12 +407,35 @@ bool hook_zmq::data_(void *vdata)
     }
     struct buffer &buf = *(static_cast<struct buffer *>(vdata));
 
-    // Send topic and data
-    ok = send_(buf);
-    if (ok == true)
+    // Send topic and data, after the held messages
+    if (tx_queue_.empty() == true)
+    {
+        ok = send_(buf);
+        if (ok == true)
+        {
+            LOGGER_DEBUG("Message sent on ZMQ socket [bk_id=%d ; parts=%zu]", id_, buf.parts_.size());
+            tx_pkt_++;
+            return false;
+        }
+        if (errno != EAGAIN)
+        {
+            ++tx_drop_;
+            return false;
+        }
+    }
+
+    // Peer congested: hold the message while there are credits
+    if ((credit_max_ == 0) || (credit_take_() == false))
+    {
+        LOGGER_DEBUG("Drop message: peer congested [bk_id=%d ; credit=%ld]", id_, credit_);
+        ++tx_drop_;
+        return false;
+    }
+    tx_queue_.emplace_back();
+    tx_queue_.back().swap(buf);
+    if (tx_queue_.size() == 1u)
     {
-        LOGGER_DEBUG("Message sent on ZMQ socket [bk_id=%d ; parts=%zu]", id_, buf.parts_.size());
-        tx_pkt_++;
+        poll_update_();
     }
 
     return false;
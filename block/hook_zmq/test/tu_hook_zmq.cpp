@@ -133,6 +133,64 @@ static void tu_hook_dealer_router()
     server.stop_();
 }
 
+//
+// @brief Messages are held while the peer is missing, the hook stops reading while paused
+//
+static void tu_hook_zmq_flow()
+{
+    struct hook_zmq client(&mgr_);
+    struct hook_zmq server(&mgr_);
+    const char *address = "tcp://127.0.0.1:5556";
+    struct buffer buf;
+
+    server.id_ = 1;
+    server.type_ = ZMQ_PAIR;
+    server.addr_ = std::string(address);
+    server.credit_set_(2);
+    client.id_ = 2;
+    client.type_ = ZMQ_PAIR;
+    client.addr_ = std::string(address);
+    client.client_ = true;
+
+    // No peer: messages are held until the credits run out
+    server.start_();
+    for (int i = 0; i < 3; i++)
+    {
+        message_create(buf, "hello", "world");
+        server.data_(&buf);
+        message_destroy(buf);
+    }
+    ASSERT(server.tx_queue_.size() == 2u);
+    ASSERT(server.tx_drop_ == 1u);
+    ASSERT(server.credit_empty_ == true);
+    ASSERT(server.zmq_sock_.write == true);
+
+    // Held messages are sent once the peer is there
+    client.start_();
+    for (int i = 0; (i < 100) && (client.rx_pkt_ < 2u); i++)
+    {
+        usleep(10 * 1000);
+        mgr_.fd_poll();
+    }
+    ASSERT(server.tx_queue_.empty() == true);
+    ASSERT(server.tx_pkt_ == 2u);
+    ASSERT(server.credit_ == 2);
+    ASSERT(server.credit_empty_ == false);
+    ASSERT(server.zmq_sock_.write == false);
+    ASSERT(client.rx_pkt_ == 2u);
+
+    // Paused hook does not read
+    client.flow_hold_ = 1u;
+    client.on_flow_(true);
+    ASSERT(client.zmq_sock_.read == false);
+    client.flow_hold_ = 0u;
+    client.on_flow_(false);
+    ASSERT(client.zmq_sock_.read == true);
+
+    client.stop_();
+    server.stop_();
+}
+
 // Test error cases
 static void tu_hook_zmq_error()
 {
@@ -199,6 +257,7 @@ int main(int, char **)
 
     tu_hook_pair_pair();
     tu_hook_dealer_router();
+    tu_hook_zmq_flow();
     tu_hook_zmq_error();
 
     LOGGER_CLOSE();
@@ -0,0 +1,89 @@
+#ifndef ROUTER_HPP
+#define ROUTER_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+//
+// @struct router_rule
+//
+// @brief Route of a topic to an output port
+//
+struct router_rule
+{
+    std::string topic_; // Topic, or beginning of the topics for a prefix rule
+    bool prefix_;       // Match every topic starting with the rule topic
+    int port_;          // Output port
+};
+
+//
+// @struct router_node
+//
+// @brief Node of the compiled trie, reached by its label
+//
+struct router_node
+{
+    uint32_t label_;       // Offset of the label in the byte pool
+    uint32_t label_len_;   // Length of the label
+    uint32_t child_;       // Offset of the first child in the edge arrays
+    uint32_t child_count_; // Number of children
+    int exact_;            // Port of the exact rule ending here, -1 if none
+    int prefix_;           // Port of the prefix rule ending here, -1 if none
+};
+
+//
+// @struct router_table
+//
+// @brief Rules compiled into a radix trie laid out in flat arrays:
+//          - chains of single children are merged into one label
+//          - the children of a node are contiguous and found with memchr
+//          - labels are compared with memcmp
+//
+struct router_table
+{
+    std::vector<struct router_node> node_; // Nodes, the root first
+    std::vector<uint8_t> edge_byte_;       // First byte of the label of each child
+    std::vector<uint32_t> edge_node_;      // Node of each child
+    std::vector<uint8_t> label_;           // Byte pool of the labels
+
+    bool compile(const std::vector<struct router_rule> &rules);
+    int match(const uint8_t *topic, size_t len) const;
+    void swap(struct router_table &other);
+};
+
+//
+// @struct router
+//
+// @brief Dispatch messages to the block bound on the port of their topic.
+//        The longest matching rule wins, an exact rule wins over a prefix rule
+//
+struct router : block
+{
+    size_t topic_part_;                    // Part of the message holding the topic
+    int default_port_;                     // Port of the unmatched topics, -1 to drop them
+    std::vector<struct router_rule> rule_; // Rules in use
+    struct router_table table_;            // Rules in use, compiled
+    std::vector<struct block *> port_;     // Bound blocks, by port
+    unsigned long drop_;                   // Messages without route
+
+    bool rules_set(const std::vector<struct router_rule> &rules);
+
+    //
+    // Implementation of the block interface
+    //
+    explicit router(struct manager *mgr);
+    virtual ~router() override final;
+
+    virtual void bind_(int port, struct block *bk) override final;
+    virtual void transfer_(struct block *old_bk) override final;
+
+    virtual bool data_(void *vdata) override final;
+};
+
+struct router_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+#endif // ROUTER_HPP
@@ -0,0 +1,317 @@
+//
+// @brief Router: topics are matched in a compiled trie to find the output port
+//          - exact rules win over prefix rules, the longest prefix wins
+//          - topics matching no rule go to the default port, or are dropped
+//
+
+// Project headers
+#include "block/router.hpp"
+#include "utils/buffer.hpp"
+
+// C++ headers
+#include <map>
+
+//
+// @struct router_build
+//
+// @brief Node of the trie being built, one byte per level
+//
+struct router_build
+{
+    std::map<uint8_t, size_t> next_; // Children by byte
+    int exact_;                      // Port of the exact rule ending here, -1 if none
+    int prefix_;                     // Port of the prefix rule ending here, -1 if none
+};
+
+//
+// @brief Lay out the children of a node, merging the chains of single children
+//
+static void router_flatten(struct router_table &table, const std::vector<struct router_build> &build, size_t b, size_t n)
+{
+    size_t edge;
+
+    edge = table.edge_byte_.size();
+    table.node_[n].child_ = static_cast<uint32_t>(edge);
+    table.node_[n].child_count_ = static_cast<uint32_t>(build[b].next_.size());
+
+    // Children are contiguous to be searched at once
+    for (const auto &it : build[b].next_)
+    {
+        table.edge_byte_.push_back(it.first);
+        table.edge_node_.push_back(0u);
+    }
+
+    for (const auto &it : build[b].next_)
+    {
+        struct router_node child;
+        size_t current;
+
+        child.label_ = static_cast<uint32_t>(table.label_.size());
+        table.label_.push_back(it.first);
+
+        current = it.second;
+        while ((build[current].exact_ < 0) && (build[current].prefix_ < 0) && (build[current].next_.size() == 1u))
+        {
+            table.label_.push_back(build[current].next_.cbegin()->first);
+            current = build[current].next_.cbegin()->second;
+        }
+
+        child.label_len_ = static_cast<uint32_t>(table.label_.size()) - child.label_;
+        child.child_ = 0u;
+        child.child_count_ = 0u;
+        child.exact_ = build[current].exact_;
+        child.prefix_ = build[current].prefix_;
+
+        table.edge_node_[edge] = static_cast<uint32_t>(table.node_.size());
+        table.node_.push_back(child);
+        router_flatten(table, build, current, table.edge_node_[edge]);
+
+        ++edge;
+    }
+}
+
+//
+// @brief Compile the rules, the table is left empty on failure
+//
+bool router_table::compile(const std::vector<struct router_rule> &rules)
+{
+    std::vector<struct router_build> build;
+    struct router_node root;
+
+    node_.clear();
+    edge_byte_.clear();
+    edge_node_.clear();
+    label_.clear();
+
+    build.push_back({{}, -1, -1});
+    for (const auto &rule : rules)
+    {
+        size_t current;
+        int *port;
+
+        if (rule.port_ < 0)
+        {
+            LOGGER_ERR("Failed to compile routing rule: wrong port [topic=%s ; port=%d]", rule.topic_.c_str(), rule.port_);
+            return false;
+        }
+
+        current = 0u;
+        for (char c : rule.topic_)
+        {
+            const auto &it = build[current].next_.find(static_cast<uint8_t>(c));
+            if (it != build[current].next_.cend())
+            {
+                current = it->second;
+                continue;
+            }
+
+            build[current].next_[static_cast<uint8_t>(c)] = build.size();
+            current = build.size();
+            build.push_back({{}, -1, -1});
+        }
+
+        port = (rule.prefix_ == true) ? &build[current].prefix_ : &build[current].exact_;
+        if (*port >= 0)
+        {
+            LOGGER_ERR("Failed to compile routing rule: duplicate rule [topic=%s ; prefix=%s]",
+                       rule.topic_.c_str(), rule.prefix_ ? "true" : "false");
+            return false;
+        }
+        *port = rule.port_;
+    }
+
+    root.label_ = 0u;
+    root.label_len_ = 0u;
+    root.child_ = 0u;
+    root.child_count_ = 0u;
+    root.exact_ = build[0].exact_;
+    root.prefix_ = build[0].prefix_;
+    node_.push_back(root);
+    router_flatten(*this, build, 0u, 0u);
+
+    return true;
+}
+
+//
+// @brief Find the port of a topic
+//
+// @return Port of the longest matching rule, -1 if none
+//
+int router_table::match(const uint8_t *topic, size_t len) const
+{
+    const struct router_node *node;
+    size_t pos;
+    int port;
+
+    if (node_.empty() == true)
+    {
+        return -1;
+    }
+
+    node = &node_[0];
+    pos = 0u;
+    port = -1;
+    while (true)
+    {
+        const uint8_t *edge;
+        const struct router_node *child;
+
+        if (node->prefix_ >= 0)
+        {
+            port = node->prefix_;
+        }
+        if (pos == len)
+        {
+            return (node->exact_ >= 0) ? node->exact_ : port;
+        }
+        if (node->child_count_ == 0u)
+        {
+            return port;
+        }
+
+        edge = static_cast<const uint8_t *>(memchr(&edge_byte_[node->child_], topic[pos], node->child_count_));
+        if (edge == nullptr)
+        {
+            return port;
+        }
+
+        child = &node_[edge_node_[static_cast<size_t>(edge - edge_byte_.data())]];
+        if ((child->label_len_ > len - pos) ||
+            (memcmp(&label_[child->label_], &topic[pos], child->label_len_) != 0))
+        {
+            return port;
+        }
+
+        pos += child->label_len_;
+        node = child;
+    }
+}
+
+void router_table::swap(struct router_table &other)
+{
+    node_.swap(other.node_);
+    edge_byte_.swap(other.edge_byte_);
+    edge_node_.swap(other.edge_node_);
+    label_.swap(other.label_);
+}
+
+//
+// Implementation of the block interface
+//
+
+router::router(struct manager *mgr) : block(mgr),
+                                      topic_part_(0u),
+                                      default_port_(-1),
+                                      drop_(0u)
+{
+    // No rule: every topic goes to the default port
+    table_.compile(rule_);
+}
+router::~router() {}
+
+//
+// @brief Replace the rules: the new ones are compiled aside, then
+//        swapped in at once. The rules in use are kept on failure
+//
+bool router::rules_set(const std::vector<struct router_rule> &rules)
+{
+    struct router_table table;
+
+    if (table.compile(rules) == false)
+    {
+        LOGGER_ERR("Failed to set routing rules: keeping the rules in use [bk_id=%d ; count=%zu]", id_, rule_.size());
+        return false;
+    }
+
+    table_.swap(table);
+    rule_ = rules;
+
+    LOGGER_INFO("Set routing rules [bk_id=%d ; count=%zu ; node_count=%zu]", id_, rule_.size(), table_.node_.size());
+
+    return true;
+}
+
+void router::bind_(int port, struct block *bk)
+{
+    if (port < 0)
+    {
+        LOGGER_ERR("Failed to bind router: wrong port [bk_id=%d ; port=%d]", id_, port);
+        return;
+    }
+
+    if (static_cast<size_t>(port) >= port_.size())
+    {
+        port_.resize(static_cast<size_t>(port) + 1u, nullptr);
+    }
+    port_[static_cast<size_t>(port)] = bk;
+}
+
+//
+// @brief Take over the rules of a router replaced, the ports are bound already
+//
+void router::transfer_(struct block *old_bk)
+{
+    struct router *old_rt;
+
+    if (old_bk->type_ != type_)
+    {
+        return;
+    }
+    old_rt = static_cast<struct router *>(old_bk);
+
+    topic_part_ = old_rt->topic_part_;
+    default_port_ = old_rt->default_port_;
+    rule_.swap(old_rt->rule_);
+    table_.swap(old_rt->table_);
+    drop_ = old_rt->drop_;
+}
+
+bool router::data_(void *vdata)
+{
+    int port;
+
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to route data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    struct buffer &buf = *(static_cast<struct buffer *>(vdata));
+    if (buf.parts_.size() <= topic_part_)
+    {
+        LOGGER_DEBUG("Drop message without topic [bk_id=%d ; parts_count=%zu]", id_, buf.parts_.size());
+        ++drop_;
+        return false;
+    }
+
+    port = table_.match(static_cast<const uint8_t *>(buf.parts_[topic_part_].data), buf.parts_[topic_part_].len);
+    if (port < 0)
+    {
+        port = default_port_;
+    }
+    if ((port < 0) || (static_cast<size_t>(port) >= port_.size()) || (port_[static_cast<size_t>(port)] == nullptr))
+    {
+        LOGGER_DEBUG("Drop message without route [bk_id=%d ; port=%d]", id_, port);
+        ++drop_;
+        return false;
+    }
+
+    // The data flow continues on the bound block, not on the sink
+    process_data_(port_[static_cast<size_t>(port)], vdata);
+
+    return false;
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *router_factory::constructor(struct manager *mgr)
+{
+    return new struct router(mgr);
+}
+
+void router_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct router *>(bk);
+}
@@ -0,0 +1,205 @@
+//
+// @brief Test file for the router block
+//
+
+// Project headers
+#include "block/hello.hpp"
+#include "block/router.hpp"
+#include "engine/tu.hpp"
+
+struct manager mgr_;
+
+//
+// @brief Find the port of a topic
+//
+static int tu_router_match(const struct router_table &table, const char *topic)
+{
+    return table.match(reinterpret_cast<const uint8_t *>(topic), strlen(topic));
+}
+
+//
+// @brief Exact and prefix rules, longest match
+//
+static void tu_router_table()
+{
+    struct router_table table;
+    std::vector<struct router_rule> rules;
+
+    // No rule
+    ASSERT(table.compile(rules) == true);
+    ASSERT(tu_router_match(table, "") == -1);
+    ASSERT(tu_router_match(table, "PROTO.CMD") == -1);
+
+    rules.push_back({"PROTO.CMD", false, 1});
+    rules.push_back({"PROTO.CMD.REP", false, 2});
+    rules.push_back({"PROTO.", true, 3});
+    rules.push_back({"PROTO.CMD", true, 4});
+    rules.push_back({"STATS", false, 5});
+    rules.push_back({"", true, 6});
+    ASSERT(table.compile(rules) == true);
+
+    // Exact rules win over prefix rules of the same length
+    ASSERT(tu_router_match(table, "PROTO.CMD") == 1);
+    ASSERT(tu_router_match(table, "PROTO.CMD.REP") == 2);
+
+    // Longest prefix
+    ASSERT(tu_router_match(table, "PROTO.CMD.RE") == 4);
+    ASSERT(tu_router_match(table, "PROTO.CMD.REPLY") == 4);
+    ASSERT(tu_router_match(table, "PROTO.CM") == 3);
+    ASSERT(tu_router_match(table, "PROTO.") == 3);
+
+    // Exact rules do not match longer or shorter topics
+    ASSERT(tu_router_match(table, "STATS") == 5);
+    ASSERT(tu_router_match(table, "STATSX") == 6);
+    ASSERT(tu_router_match(table, "STAT") == 6);
+    ASSERT(tu_router_match(table, "PROTO") == 6);
+    ASSERT(tu_router_match(table, "") == 6);
+
+    // Many topics sharing prefixes
+    rules.clear();
+    for (int i = 0; i < 500; ++i)
+    {
+        rules.push_back({"TOPIC." + std::to_string(i), false, i});
+    }
+    ASSERT(table.compile(rules) == true);
+    for (int i = 0; i < 500; ++i)
+    {
+        ASSERT(tu_router_match(table, ("TOPIC." + std::to_string(i)).c_str()) == i);
+    }
+    ASSERT(tu_router_match(table, "TOPIC.500") == -1);
+    ASSERT(tu_router_match(table, "TOPIC.") == -1);
+    ASSERT(tu_router_match(table, "TOPIC") == -1);
+
+    // Topics are not strings
+    {
+        const uint8_t topic[] = {0x00u, 0xffu, 0x00u};
+
+        rules.clear();
+        rules.push_back({std::string(reinterpret_cast<const char *>(topic), sizeof(topic)), false, 7});
+        ASSERT(table.compile(rules) == true);
+        ASSERT(table.match(topic, sizeof(topic)) == 7);
+        ASSERT(table.match(topic, sizeof(topic) - 1u) == -1);
+    }
+}
+
+//
+// @brief Dispatch messages to the bound blocks
+//
+static void tu_router_flow()
+{
+    struct router *rt;
+    struct hello *bk_1;
+    struct hello *bk_2;
+    std::vector<struct router_rule> rules;
+    struct buffer buf;
+    const char *topic;
+
+    ASSERT(mgr_.block_add(1, "router") == true);
+    ASSERT(mgr_.block_add(2, "hello") == true);
+    ASSERT(mgr_.block_add(3, "hello") == true);
+    ASSERT(mgr_.block_bind(1, 0, 2) == true);
+    ASSERT(mgr_.block_bind(1, 1, 3) == true);
+
+    rt = static_cast<struct router *>(mgr_.block_get(1));
+    bk_1 = static_cast<struct hello *>(mgr_.block_get(2));
+    bk_2 = static_cast<struct hello *>(mgr_.block_get(3));
+    ASSERT(rt != nullptr);
+    ASSERT(bk_1 != nullptr);
+    ASSERT(bk_2 != nullptr);
+
+    rules.push_back({"A", false, 0});
+    rules.push_back({"B", true, 1});
+    ASSERT(rt->rules_set(rules) == true);
+
+    topic = "A";
+    buf.push_back(topic, strlen(topic));
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(bk_1->count_ == 1);
+    ASSERT(bk_2->count_ == 0);
+    buf.clear();
+
+    topic = "BCD";
+    buf.push_back(topic, strlen(topic));
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(bk_1->count_ == 1);
+    ASSERT(bk_2->count_ == 1);
+    buf.clear();
+
+    // Unmatched topic, without then with a default port
+    topic = "C";
+    buf.push_back(topic, strlen(topic));
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(rt->drop_ == 1u);
+    rt->default_port_ = 1;
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(bk_2->count_ == 2);
+    buf.clear();
+
+    // Topic in another part of the message
+    rt->topic_part_ = 1u;
+    topic = "A";
+    buf.push_back(topic, strlen(topic));
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(rt->drop_ == 2u);
+    buf.push_back(topic, strlen(topic));
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(bk_1->count_ == 2);
+    buf.clear();
+
+    // Wrong rules keep the rules in use
+    rules.push_back({"A", false, 1});
+    ASSERT(rt->rules_set(rules) == false);
+    ASSERT(rt->rule_.size() == 2u);
+    rules.pop_back();
+    rules.push_back({"D", false, -1});
+    ASSERT(rt->rules_set(rules) == false);
+    ASSERT(tu_router_match(rt->table_, "A") == 0);
+
+    // Port without bound block
+    rules.pop_back();
+    rules.push_back({"E", false, 5});
+    ASSERT(rt->rules_set(rules) == true);
+    rt->topic_part_ = 0u;
+    topic = "E";
+    buf.push_back(topic, strlen(topic));
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(rt->drop_ == 3u);
+    buf.clear();
+
+    // Replaced router keeps its rules
+    ASSERT(mgr_.block_replace(1, "router") == true);
+    rt = static_cast<struct router *>(mgr_.block_get(1));
+    ASSERT(rt->rule_.size() == 3u);
+    ASSERT(rt->default_port_ == 1);
+    ASSERT(rt->drop_ == 3u);
+    topic = "BCD";
+    buf.push_back(topic, strlen(topic));
+    ASSERT(rt->data_(&buf) == false);
+    ASSERT(bk_2->count_ == 3);
+    buf.clear();
+
+    // Errors
+    ASSERT(rt->data_(nullptr) == false);
+    rt->bind_(-1, bk_1);
+
+    mgr_.block_clear();
+}
+
+int main(int, char **)
+{
+    struct router_factory router_f;
+    struct hello_factory hello_f;
+
+    LOGGER_OPEN("tu_router");
+
+    mgr_.block_factory_register("router", &router_f);
+    mgr_.block_factory_register("hello", &hello_f);
+
+    tu_router_table();
+    tu_router_flow();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef SHAPER_HPP
+#define SHAPER_HPP
+
+// Project headers
+#include "engine/block.hpp"
+
+// C++ headers
+#include <deque>
+#include <unordered_map>
+
+//
+// @enum shaper_policy
+//
+enum shaper_policy
+{
+    SHAPER_DROP = 0,  // Messages over the limit are dropped
+    SHAPER_QUEUE = 1, // Messages over the limit wait for tokens, dropped if the queue is full
+    SHAPER_MARK = 2   // Messages over the limit are sent on port 1, or on port 0 if unbound
+};
+
+//
+// @struct shaper_bucket
+//
+// @brief Token bucket of a key, refilled lazily from the tick of its last use
+//
+struct shaper_bucket
+{
+    uint64_t credit;      // Tokens available, in millionths of token
+    uint64_t tick;        // Tick of the last refill
+    unsigned long queued; // Messages of the key in the queue
+};
+
+//
+// @struct shaper_item
+//
+// @brief Message waiting for a token
+//
+struct shaper_item
+{
+    struct shaper_bucket *bucket; // Bucket of the message, kept while it has queued messages
+    struct buffer buf;            // Message, moved from the incoming buffer
+};
+
+//
+// @struct shaper
+//
+// @brief Limit the rate of messages per key, with one token bucket per key.
+//
+// Buckets are refilled when they are used, from the ticks elapsed on the
+// monotonic clock. A periodic timer sends the queued messages, and removes
+// full idle buckets a few at a time, as they behave like new buckets. Each
+// message costs a lookup, a clock read and a few operations
+//
+struct shaper : block
+{
+    enum shaper_policy policy_; // Policy for the messages over the limit
+    size_t key_part_;           // Part of the buffer holding the key, messages without it share a bucket
+    uint64_t rate_;             // Messages per second and per key, 0 for no limit
+    uint64_t burst_;            // Size of a bucket, in messages
+    size_t queue_max_;          // Messages waiting for a token
+    long tick_us_;              // Period of a refill and of the timer, its identifier is the block identifier
+
+    uint64_t origin_ns_; // Monotonic date of the tick 0
+    uint64_t tick_ns_;   // Period of a refill, in nanoseconds
+    uint64_t tick_;      // Ticks elapsed since the origin
+    uint64_t tick_fill_; // Refill of a bucket per tick, in millionths of token
+    uint64_t cap_;       // Size of a bucket, in millionths of token
+    uint64_t fill_;      // Ticks filling an empty bucket
+
+    std::unordered_map<std::string, struct shaper_bucket> bucket_; // Buckets, by key
+    std::string key_;                                             // Key of the message being processed
+    size_t sweep_;                                                // Next hash bucket to look for idle buckets
+    std::deque<struct shaper_item> queue_;                        // Messages waiting for a token
+
+    struct block *out_;  // Block bound on port 0
+    struct block *mark_; // Block bound on port 1
+
+    unsigned long pass_;   // Messages within the limit
+    unsigned long delay_;  // Messages queued
+    unsigned long marked_; // Messages marked
+    unsigned long drop_;   // Messages dropped
+
+    void limits_update();
+    void tick_update(uint64_t now_ns);
+    void refill(struct shaper_bucket &bucket);
+    bool consume(struct shaper_bucket &bucket);
+    void drain(uint64_t now_ns);
+    void sweep();
+    void timer_arm();
+
+    //
+    // Implementation of the block interface
+    //
+    explicit shaper(struct manager *mgr);
+    virtual ~shaper() override final;
+
+    virtual void bind_(int port, struct block *bk) override final;
+    virtual void start_() override final;
+    virtual void stop_() override final;
+    virtual void transfer_(struct block *old_bk) override final;
+
+    virtual bool data_(void *vdata) override final;
+
+    virtual void on_timer_(struct timer &tm) override final;
+};
+
+struct shaper_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final;
+    virtual void destructor(struct block *bk) override final;
+};
+
+#endif // SHAPER_HPP
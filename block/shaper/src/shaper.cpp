@@ -0,0 +1,411 @@
+// Project headers
+#include "block/shaper.hpp"
+#include "engine/manager.hpp"
+#include "utils/buffer.hpp"
+
+// C++ headers
+#include <algorithm>
+
+#define SHAPER_TOKEN 1000000ull // One token, in millionths of token
+#define SHAPER_RATE 1000u       // Default messages per second
+#define SHAPER_BURST 100u       // Default size of a bucket
+#define SHAPER_QUEUE_MAX 1024u  // Default messages waiting for a token
+#define SHAPER_TICK_US 1000l    // Default period of a refill and of the timer
+#define SHAPER_SWEEP 64u        // Hash buckets looked at per tick for idle buckets
+
+shaper::shaper(struct manager *mgr) : block(mgr),
+                                      policy_(SHAPER_DROP),
+                                      key_part_(0u),
+                                      rate_(SHAPER_RATE),
+                                      burst_(SHAPER_BURST),
+                                      queue_max_(SHAPER_QUEUE_MAX),
+                                      tick_us_(SHAPER_TICK_US),
+                                      origin_ns_(0u),
+                                      tick_ns_(0u),
+                                      tick_(0u),
+                                      tick_fill_(0u),
+                                      cap_(0u),
+                                      fill_(0u),
+                                      sweep_(0u),
+                                      out_(nullptr),
+                                      mark_(nullptr),
+                                      pass_(0u),
+                                      delay_(0u),
+                                      marked_(0u),
+                                      drop_(0u)
+{
+    limits_update();
+}
+shaper::~shaper()
+{
+    for (auto &item : queue_)
+    {
+        item.buf.clear();
+    }
+
+    // A replacement block shares the timer identifier: only the timers of this block are removed
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+}
+
+//
+// @brief Compute the refill of the buckets from the limits, once they are set
+//
+// Buckets get the tokens earned with the previous limits, then the ticks
+// start again from now with the new period
+//
+void shaper::limits_update()
+{
+    uint64_t now_ns;
+
+    now_ns = buffer_now_ns();
+    if (tick_ns_ != 0u)
+    {
+        tick_update(now_ns);
+        for (auto &it : bucket_)
+        {
+            refill(it.second);
+            it.second.tick = 0u;
+        }
+    }
+
+    if (burst_ == 0u)
+    {
+        burst_ = 1u;
+    }
+    if (tick_us_ <= 0)
+    {
+        tick_us_ = SHAPER_TICK_US;
+    }
+
+    origin_ns_ = now_ns;
+    tick_ns_ = static_cast<uint64_t>(tick_us_) * 1000u;
+    tick_ = 0u;
+    tick_fill_ = rate_ * static_cast<uint64_t>(tick_us_);
+    cap_ = burst_ * SHAPER_TOKEN;
+    fill_ = (tick_fill_ == 0u) ? 0u : (cap_ + tick_fill_ - 1u) / tick_fill_;
+}
+
+//
+// @brief Count the ticks elapsed on the monotonic clock, whenever the timer fires
+//
+void shaper::tick_update(uint64_t now_ns)
+{
+    if (now_ns > origin_ns_)
+    {
+        tick_ = (now_ns - origin_ns_) / tick_ns_;
+    }
+}
+
+//
+// @brief Add the tokens earned since the last use of a bucket
+//
+void shaper::refill(struct shaper_bucket &bucket)
+{
+    uint64_t elapsed;
+
+    elapsed = tick_ - bucket.tick;
+    if (elapsed >= fill_)
+    {
+        bucket.credit = cap_;
+    }
+    else
+    {
+        bucket.credit = std::min(cap_, bucket.credit + elapsed * tick_fill_);
+    }
+    bucket.tick = tick_;
+}
+
+//
+// @brief Take a token from a bucket
+//
+// @return false if the bucket is empty
+//
+bool shaper::consume(struct shaper_bucket &bucket)
+{
+    refill(bucket);
+    if (bucket.credit < SHAPER_TOKEN)
+    {
+        return false;
+    }
+    bucket.credit -= SHAPER_TOKEN;
+
+    return true;
+}
+
+//
+// @brief Send the queued messages having a token, in order
+//
+// Within a tick the credit of a bucket only decreases: once a message of a key
+// stays in the queue, the next ones of the key stay too and the order is kept
+//
+void shaper::drain(uint64_t now_ns)
+{
+    size_t count;
+
+    count = queue_.size();
+    for (size_t i = 0u; i < count; ++i)
+    {
+        struct shaper_item item;
+
+        item.bucket = queue_.front().bucket;
+        item.buf.swap(queue_.front().buf);
+        queue_.pop_front();
+
+        // Stale messages do not take a token
+        if (item.buf.is_expired(now_ns) == true)
+        {
+            LOGGER_DEBUG("Drop message: deadline expired in queue [bk_id=%d]", id_);
+            --item.bucket->queued;
+            ++data_expired_;
+            item.buf.clear();
+            continue;
+        }
+
+        if (consume(*item.bucket) == false)
+        {
+            queue_.push_back(item);
+            continue;
+        }
+
+        --item.bucket->queued;
+        ++pass_;
+        process_data_(out_, &item.buf);
+        item.buf.clear();
+    }
+}
+
+//
+// @brief Remove some buckets that are full and unused, they behave like new ones
+//
+void shaper::sweep()
+{
+    std::vector<std::string> idle;
+    size_t count;
+
+    count = bucket_.bucket_count();
+    for (size_t i = 0u; i < SHAPER_SWEEP; ++i)
+    {
+        size_t n = sweep_++ % count;
+
+        for (auto it = bucket_.begin(n); it != bucket_.end(n); ++it)
+        {
+            if (it->second.queued != 0u)
+            {
+                continue;
+            }
+
+            refill(it->second);
+            if (it->second.credit == cap_)
+            {
+                idle.push_back(it->first);
+            }
+        }
+    }
+
+    for (const auto &key : idle)
+    {
+        bucket_.erase(key);
+    }
+}
+
+//
+// @brief Arm the timer sending the queued messages
+//
+void shaper::timer_arm()
+{
+    struct timer tm;
+
+    tm.bk = this;
+    tm.arg = nullptr;
+    tm.tid = id_;
+    tm.time.tv_sec = tick_us_ / 1000000;
+    tm.time.tv_nsec = (tick_us_ % 1000000) * 1000;
+    mgr_->timer_add(tm);
+}
+
+//
+// Implementation of the block interface
+//
+
+void shaper::bind_(int port, struct block *bk)
+{
+    switch (port)
+    {
+    case 0:
+        out_ = bk;
+        break;
+
+    case 1:
+        mark_ = bk;
+        break;
+
+    default:
+        LOGGER_ERR("Failed to bind shaper: wrong port [bk_id=%d ; port=%d]", id_, port);
+        break;
+    }
+}
+
+void shaper::start_()
+{
+    timer_arm();
+}
+
+//
+// @brief Queued messages are dropped
+//
+void shaper::stop_()
+{
+    mgr_->tm_list_.remove_if([this](const struct timer &tm) { return tm.bk == this; });
+
+    for (auto &item : queue_)
+    {
+        --item.bucket->queued;
+        item.buf.clear();
+        ++drop_;
+    }
+    queue_.clear();
+}
+
+//
+// @brief Take over the limits, the buckets and the queued messages of a shaper replaced
+//
+// Buckets keep their address in the swap, the queued messages keep their bucket
+//
+void shaper::transfer_(struct block *old_bk)
+{
+    struct shaper *old_sh;
+
+    if (old_bk->type_ != type_)
+    {
+        return;
+    }
+    old_sh = static_cast<struct shaper *>(old_bk);
+
+    policy_ = old_sh->policy_;
+    key_part_ = old_sh->key_part_;
+    rate_ = old_sh->rate_;
+    burst_ = old_sh->burst_;
+    queue_max_ = old_sh->queue_max_;
+    tick_us_ = old_sh->tick_us_;
+
+    origin_ns_ = old_sh->origin_ns_;
+    tick_ns_ = old_sh->tick_ns_;
+    tick_ = old_sh->tick_;
+    tick_fill_ = old_sh->tick_fill_;
+    cap_ = old_sh->cap_;
+    fill_ = old_sh->fill_;
+
+    bucket_.swap(old_sh->bucket_);
+    queue_.swap(old_sh->queue_);
+
+    pass_ = old_sh->pass_;
+    delay_ = old_sh->delay_;
+    marked_ = old_sh->marked_;
+    drop_ = old_sh->drop_;
+}
+
+bool shaper::data_(void *vdata)
+{
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to shape data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+
+    struct buffer &buf = *(static_cast<struct buffer *>(vdata));
+
+    if (rate_ == 0u)
+    {
+        ++pass_;
+        process_data_(out_, vdata);
+        return false;
+    }
+
+    tick_update(buffer_now_ns());
+
+    // The key is copied in a string kept from one message to the other
+    if (buf.parts_.size() > key_part_)
+    {
+        key_.assign(static_cast<const char *>(buf.parts_[key_part_].data), buf.parts_[key_part_].len);
+    }
+    else
+    {
+        key_.clear();
+    }
+
+    auto it = bucket_.find(key_);
+    if (it == bucket_.end())
+    {
+        it = bucket_.emplace(key_, shaper_bucket{cap_, tick_, 0u}).first;
+    }
+    struct shaper_bucket &bucket = it->second;
+
+    // Messages of a key are not sent before its queued messages
+    if ((bucket.queued == 0u) && (consume(bucket) == true))
+    {
+        ++pass_;
+        process_data_(out_, vdata);
+        return false;
+    }
+
+    switch (policy_)
+    {
+    case SHAPER_QUEUE:
+        if (queue_.size() < queue_max_)
+        {
+            queue_.emplace_back();
+            queue_.back().bucket = &bucket;
+            queue_.back().buf.swap(buf);
+            ++bucket.queued;
+            ++delay_;
+        }
+        else
+        {
+            LOGGER_DEBUG("Drop message: queue is full [bk_id=%d ; queue_max=%zu]", id_, queue_max_);
+            ++drop_;
+        }
+        break;
+
+    case SHAPER_MARK:
+        ++marked_;
+        process_data_((mark_ != nullptr) ? mark_ : out_, vdata);
+        break;
+
+    case SHAPER_DROP:
+    default:
+        ++drop_;
+        break;
+    }
+
+    return false;
+}
+
+void shaper::on_timer_(struct timer &)
+{
+    uint64_t now_ns;
+
+    now_ns = buffer_now_ns();
+    tick_update(now_ns);
+
+    drain(now_ns);
+    sweep();
+
+    if (is_started_ == true)
+    {
+        timer_arm();
+    }
+}
+
+//
+// Implementation of the factory interface
+//
+
+struct block *shaper_factory::constructor(struct manager *mgr)
+{
+    return new struct shaper(mgr);
+}
+
+void shaper_factory::destructor(struct block *bk)
+{
+    delete static_cast<struct shaper *>(bk);
+}
@@ -0,0 +1,312 @@
+//
+// @brief Test file for the shaper block
+//
+
+// Project headers
+#include "block/hello.hpp"
+#include "block/shaper.hpp"
+#include "engine/tu.hpp"
+
+struct manager mgr_;
+
+//
+// @brief Add a shaper and hello blocks bound on its ports
+//
+static struct shaper *tu_shaper_add(enum shaper_policy policy)
+{
+    struct shaper *sh;
+
+    // One token per tick, two per bucket. Ticks are long enough for the test
+    // to run within one, they elapse when the test says so
+    sh = static_cast<struct shaper *>(tu_block_add(mgr_, 1, "shaper", 2));
+    sh->policy_ = policy;
+    sh->rate_ = 1u;
+    sh->burst_ = 2u;
+    sh->tick_us_ = 1000 * 1000;
+    sh->limits_update();
+
+    return sh;
+}
+
+//
+// @brief Let a tick elapse, then run the timer
+//
+static void tu_shaper_tick(struct shaper *sh)
+{
+    struct timer tm;
+
+    sh->origin_ns_ -= sh->tick_ns_;
+
+    tm.bk = sh;
+    tm.arg = nullptr;
+    tm.tid = sh->id_;
+    sh->on_timer_(tm);
+}
+
+static void tu_shaper_drop()
+{
+    struct shaper *sh;
+
+    sh = tu_shaper_add(SHAPER_DROP);
+
+    // Keys have their own bucket
+    for (int i = 0; i < 5; ++i)
+    {
+        tu_block_send(sh, {"A"});
+    }
+    tu_block_send(sh, {"B"});
+    tu_block_send(sh, {"B"});
+    ASSERT(tu_block_count(mgr_, 2) == 4u);
+    ASSERT(sh->pass_ == 4u);
+    ASSERT(sh->drop_ == 3u);
+    ASSERT(sh->bucket_.size() == 2u);
+
+    // One token per tick
+    tu_shaper_tick(sh);
+    tu_block_send(sh, {"A"});
+    tu_block_send(sh, {"A"});
+    ASSERT(tu_block_count(mgr_, 2) == 5u);
+    ASSERT(sh->drop_ == 4u);
+
+    // Buckets are full again, they are removed
+    tu_shaper_tick(sh);
+    tu_shaper_tick(sh);
+    ASSERT(sh->bucket_.empty() == true);
+
+    // No limit
+    sh->rate_ = 0u;
+    sh->limits_update();
+    for (int i = 0; i < 5; ++i)
+    {
+        tu_block_send(sh, {"A"});
+    }
+    ASSERT(tu_block_count(mgr_, 2) == 10u);
+
+    mgr_.block_clear();
+}
+
+static void tu_shaper_queue()
+{
+    struct shaper *sh;
+
+    sh = tu_shaper_add(SHAPER_QUEUE);
+    sh->queue_max_ = 4u;
+
+    // Messages are queued once the bucket is empty, then dropped once the queue is full
+    for (int i = 0; i < 7; ++i)
+    {
+        tu_block_send(sh, {"A"});
+    }
+    ASSERT(tu_block_count(mgr_, 2) == 2u);
+    ASSERT(sh->queue_.size() == 4u);
+    ASSERT(sh->delay_ == 4u);
+    ASSERT(sh->drop_ == 1u);
+    ASSERT(sh->bucket_["A"].queued == 4u);
+
+    // Messages of another key are not delayed by the queue
+    tu_block_send(sh, {"B"});
+    ASSERT(tu_block_count(mgr_, 2) == 3u);
+
+    // Messages of a key with queued messages wait for them
+    tu_shaper_tick(sh);
+    ASSERT(tu_block_count(mgr_, 2) == 4u);
+    ASSERT(sh->queue_.size() == 3u);
+    tu_shaper_tick(sh);
+    tu_shaper_tick(sh);
+    tu_shaper_tick(sh);
+    ASSERT(tu_block_count(mgr_, 2) == 7u);
+    ASSERT(sh->queue_.empty() == true);
+    ASSERT(sh->bucket_["A"].queued == 0u);
+
+    // Stale messages leave the queue without a token
+    tu_block_send(sh, {"C"});
+    tu_block_send(sh, {"C"});
+    for (int i = 0; i < 3; ++i)
+    {
+        struct buffer buf;
+
+        buf.push_back("C", strlen("C"));
+        buf.deadline_set((i == 2) ? 1000000 : 1000);
+        ASSERT(sh->data_(&buf) == false);
+        buf.clear();
+    }
+    ASSERT(tu_block_count(mgr_, 2) == 9u);
+    ASSERT(sh->queue_.size() == 3u);
+    ASSERT(sh->queue_.front().buf.deadline_ns_ != 0u);
+    usleep(2 * 1000);
+    tu_shaper_tick(sh);
+    ASSERT(tu_block_count(mgr_, 2) == 10u);
+    ASSERT(sh->queue_.empty() == true);
+    ASSERT(sh->data_expired_ == 2u);
+    ASSERT(sh->bucket_["C"].queued == 0u);
+
+    // Stop drops the queued messages
+    for (int i = 0; i < 4; ++i)
+    {
+        tu_block_send(sh, {"D"});
+    }
+    ASSERT(sh->queue_.size() == 2u);
+    sh->is_started_ = true;
+    ASSERT(mgr_.block_stop(1) == true);
+    ASSERT(sh->queue_.empty() == true);
+    ASSERT(sh->drop_ == 3u);
+
+    mgr_.block_clear();
+}
+
+static void tu_shaper_mark()
+{
+    struct shaper *sh;
+
+    sh = tu_shaper_add(SHAPER_MARK);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        tu_block_send(sh, {"A"});
+    }
+    ASSERT(tu_block_count(mgr_, 2) == 2u);
+    ASSERT(tu_block_count(mgr_, 3) == 3u);
+    ASSERT(sh->marked_ == 3u);
+
+    // Key part is missing: messages share a bucket
+    sh->key_part_ = 1u;
+    tu_block_send(sh, {"A"});
+    tu_block_send(sh, {"B"});
+    tu_block_send(sh, {"C"});
+    ASSERT(tu_block_count(mgr_, 2) == 4u);
+    ASSERT(sh->bucket_.count("") == 1u);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Rate against the time elapsed, whatever the timer does
+//
+static void tu_shaper_rate()
+{
+    struct shaper *sh;
+    uint64_t begin;
+    uint64_t end;
+    double expected;
+
+    // A bucket holds more than the tokens earned while the loop sleeps
+    sh = tu_shaper_add(SHAPER_DROP);
+    sh->rate_ = 1000u;
+    sh->burst_ = 100u;
+    sh->tick_us_ = 100;
+    sh->limits_update();
+
+    // The loop is busy or blocked for several ticks in a row, the timer does not run
+    begin = buffer_now_ns();
+    end = begin;
+    for (int i = 0; i < 20; ++i)
+    {
+        for (int j = 0; j < 50; ++j)
+        {
+            tu_block_send(sh, {"A"});
+        }
+        end = buffer_now_ns();
+        usleep(5 * 1000);
+    }
+
+    // Tokens of the bucket, and the ones earned between the first and the last burst
+    expected = static_cast<double>(sh->burst_) + static_cast<double>(sh->rate_) * static_cast<double>(end - begin) / 1e9;
+    ASSERT(static_cast<double>(sh->pass_) <= expected + 1.0);
+    ASSERT(static_cast<double>(sh->pass_) >= expected * 0.9);
+    ASSERT(sh->pass_ + sh->drop_ == 1000u);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Timer of a started block
+//
+static void tu_shaper_timer()
+{
+    struct shaper *sh;
+
+    sh = tu_shaper_add(SHAPER_DROP);
+    sh->tick_us_ = 1000;
+    sh->limits_update();
+    ASSERT(mgr_.block_start(1) == true);
+    ASSERT(mgr_.tm_list_.empty() == false);
+
+    usleep(2 * 1000);
+    mgr_.timer_check_exp();
+    ASSERT(sh->tick_ >= 2u);
+    ASSERT(mgr_.tm_list_.empty() == false);
+
+    ASSERT(mgr_.block_stop(1) == true);
+    ASSERT(mgr_.tm_list_.empty() == true);
+
+    // Errors
+    ASSERT(sh->data_(nullptr) == false);
+    sh->bind_(2, nullptr);
+    sh->burst_ = 0u;
+    sh->tick_us_ = 0;
+    sh->limits_update();
+    ASSERT(sh->burst_ == 1u);
+    ASSERT(sh->tick_us_ > 0);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Replaced shaper keeps the limits, the buckets and the queued messages
+//
+static void tu_shaper_replace()
+{
+    struct shaper *sh;
+
+    sh = tu_shaper_add(SHAPER_QUEUE);
+    ASSERT(mgr_.block_start(1) == true);
+    for (int i = 0; i < 4; ++i)
+    {
+        tu_block_send(sh, {"A"});
+    }
+    ASSERT(tu_block_count(mgr_, 2) == 2u);
+    ASSERT(sh->queue_.size() == 2u);
+
+    ASSERT(mgr_.block_replace(1, "shaper") == true);
+    sh = static_cast<struct shaper *>(mgr_.block_get(1));
+    ASSERT(sh->is_started_ == true);
+    ASSERT(sh->policy_ == SHAPER_QUEUE);
+    ASSERT(sh->rate_ == 1u);
+    ASSERT(sh->delay_ == 2u);
+    ASSERT(sh->drop_ == 0u);
+    ASSERT(sh->queue_.size() == 2u);
+    ASSERT(sh->bucket_["A"].queued == 2u);
+    ASSERT(mgr_.tm_list_.front().bk == sh);
+
+    // Queued messages leave the new block, on its ports
+    tu_shaper_tick(sh);
+    tu_shaper_tick(sh);
+    ASSERT(tu_block_count(mgr_, 2) == 4u);
+    ASSERT(sh->queue_.empty() == true);
+
+    ASSERT(mgr_.block_stop(1) == true);
+    mgr_.block_clear();
+}
+
+int main(int, char **)
+{
+    struct shaper_factory shaper_f;
+    struct hello_factory hello_f;
+
+    LOGGER_OPEN("tu_shaper");
+
+    mgr_.block_factory_register("shaper", &shaper_f);
+    mgr_.block_factory_register("hello", &hello_f);
+
+    tu_shaper_drop();
+    tu_shaper_queue();
+    tu_shaper_mark();
+    tu_shaper_rate();
+    tu_shaper_timer();
+    tu_shaper_replace();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
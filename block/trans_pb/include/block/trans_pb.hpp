@@ -4,6 +4,9 @@
 // Project headers
 #include "engine/block.hpp"
 
+// Generated protobuf command
+#include "conf.pb-c.h"
+
 struct trans_pb : block
 {
     explicit trans_pb(struct manager *mgr);
@@ -11,8 +14,33 @@ struct trans_pb : block
 
     virtual bool data_(void *vdata) override final;
 
-    bool proto_command_parse(const uint8_t *data, size_t size);
-    void proto_command_reply(bool is_ok);
+    virtual void on_signal_(int signo) override final;
+
+    bool proto_command_parse(const uint8_t *data, size_t size, uint64_t &id, const char *&error);
+    void proto_command_reply(uint64_t id, bool is_ok, const char *error);
+
+    //
+    // Answer to the queries, reused from one query to the other
+    //
+    std::vector<BlockInfo> query_block_;
+    std::vector<BlockInfo *> query_block_ptr_;
+    std::vector<BlockBind> query_bind_;
+    std::vector<BlockBind *> query_bind_ptr_;
+    std::vector<ShaperInfo> query_shaper_;   // Details of the shapers, in the order of the blocks
+    std::vector<CodecInfo> query_codec_;     // Details of the codecs, in the order of the blocks
+    std::vector<CacheInfo> query_cache_;     // Details of the caches, in the order of the blocks
+    std::vector<DedupInfo> query_dedup_;     // Details of the dedups, in the order of the blocks
+    std::vector<CaptureInfo> query_capture_; // Details of the captures, in the order of the blocks
+    std::vector<uint8_t> payload_; // Payload of the next reply
+
+    void proto_query_add(const struct block *bk, bool with_binds);
+    void proto_query_pack();
+
+    //
+    // Snapshot of the graph of blocks
+    //
+    bool snapshot_save(const char *path);
+    bool snapshot_load(const char *path);
 };
 
 struct trans_pb_factory : block_factory
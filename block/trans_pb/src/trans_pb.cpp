@@ -1,10 +1,19 @@
 
 
 // Project headers
+#include "block/aggregator.hpp"
+#include "block/balancer.hpp"
+#include "block/cache.hpp"
+#include "block/capture.hpp"
+#include "block/codec.hpp"
+#include "block/dedup.hpp"
 #include "block/hook_zmq.hpp"
+#include "block/router.hpp"
+#include "block/shaper.hpp"
 #include "block/trans_pb.hpp"
 #include "engine/manager.hpp"
 #include "utils/buffer.hpp"
+#include "utils/sched.hpp"
 
 // Generated protobuf command
 #include "conf.pb-c.h"
@@ -12,78 +21,642 @@
 trans_pb::trans_pb(struct manager *mgr) : block(mgr) {}
 trans_pb::~trans_pb() {}
 
+//
+// @brief Describe a block in the answer to a query
+//
+// @param with_binds : Describe the bindings of the block too
+//
+void trans_pb::proto_query_add(const struct block *bk, bool with_binds)
+{
+    BlockInfo info;
+
+    block_info__init(&info);
+    info.id = bk->id_;
+    info.type = const_cast<char *>(bk->type_.c_str());
+    info.started = bk->is_started_;
+    info.sink = (bk->sink_ != nullptr) ? bk->sink_->id_ : 0;
+    info.data_rx = bk->data_rx_;
+    info.data_tx = bk->data_tx_;
+    info.ctrl_rx = bk->ctrl_rx_;
+    info.data_expired = bk->data_expired_;
+    info.credit_max = bk->credit_max_;
+    info.credit = bk->credit_;
+    info.credit_out = bk->credit_out_;
+    info.flow_paused = bk->flow_paused_;
+    query_block_.push_back(info);
+
+    if (bk->type_ == "shaper")
+    {
+        const struct shaper *sh = static_cast<const struct shaper *>(bk);
+        ShaperInfo shaper;
+
+        shaper_info__init(&shaper);
+        shaper.policy = static_cast<ConfShaper__Policy>(sh->policy_);
+        shaper.key_part = static_cast<uint32_t>(sh->key_part_);
+        shaper.rate = sh->rate_;
+        shaper.burst = sh->burst_;
+        shaper.queue_max = static_cast<uint32_t>(sh->queue_max_);
+        shaper.tick_us = sh->tick_us_;
+        shaper.pass = sh->pass_;
+        shaper.delay = sh->delay_;
+        shaper.marked = sh->marked_;
+        shaper.drop = sh->drop_;
+        shaper.keys = sh->bucket_.size();
+        shaper.queued = sh->queue_.size();
+        query_shaper_.push_back(shaper);
+    }
+    else if (bk->type_ == "codec")
+    {
+        const struct codec *cd = static_cast<const struct codec *>(bk);
+        CodecInfo codec;
+
+        codec_info__init(&codec);
+        codec.msg = cd->msg_;
+        codec.bytes_in = cd->bytes_in_;
+        codec.bytes_out = cd->bytes_out_;
+        codec.skip = cd->skip_;
+        codec.error = cd->error_;
+        codec.cpu_ns = cd->cpu_ns_;
+        query_codec_.push_back(codec);
+    }
+    else if (bk->type_ == "cache")
+    {
+        const struct cache *ca = static_cast<const struct cache *>(bk);
+        CacheInfo cache;
+
+        cache_info__init(&cache);
+        cache.hit = ca->hit_;
+        cache.miss = ca->miss_;
+        cache.fill = ca->fill_;
+        cache.evict = ca->evict_;
+        cache.expire = ca->expire_;
+        cache.entries = ca->count_;
+        cache.bytes = ca->bytes_;
+        cache.max_bytes = ca->max_bytes_;
+        query_cache_.push_back(cache);
+    }
+    else if (bk->type_ == "dedup")
+    {
+        const struct dedup *dd = static_cast<const struct dedup *>(bk);
+        DedupInfo dedup;
+
+        dedup_info__init(&dedup);
+        dedup.msg = dd->msg_;
+        dedup.pass = dd->pass_;
+        dedup.dup = dd->dup_;
+        dedup.rotate = dd->rotate_;
+        dedup.rotate_full = dd->rotate_full_;
+        dedup.bits = dd->bits_;
+        dedup.hashes = dd->hashes_;
+        dedup.capacity = dd->capacity_;
+        query_dedup_.push_back(dedup);
+    }
+    else if (bk->type_ == "capture")
+    {
+        const struct capture *cap = static_cast<const struct capture *>(bk);
+        CaptureInfo capture;
+
+        capture_info__init(&capture);
+        capture.record = cap->record_;
+        capture.bytes = cap->bytes_;
+        capture.drop = cap->drop_;
+        capture.rotate = cap->rotate_;
+        capture.error = cap->error_;
+        capture.file = cap->seq_;
+        capture.path = const_cast<char *>(cap->path_.c_str());
+        query_capture_.push_back(capture);
+    }
+
+    if (with_binds == false)
+    {
+        return;
+    }
+
+    for (const auto &it : bk->binds_)
+    {
+        BlockBind bind;
+
+        block_bind__init(&bind);
+        bind.id = bk->id_;
+        bind.port = it.first;
+        bind.dest = it.second;
+
+        const auto &eg = bk->edge_.find(it.first);
+        if (eg != bk->edge_.cend())
+        {
+            bind.queue = eg->second->ring_.capacity();
+            bind.queued = eg->second->ring_.size();
+            bind.drop = eg->second->drop_full_ + eg->second->drop_unbound_;
+        }
+        query_bind_.push_back(bind);
+    }
+}
+
+//
+// @brief Pack the answer to a query in the payload of the reply
+//
+// Entries point to the blocks and to vectors kept from one query to the
+// other: no allocation is done per entry once the vectors are large enough
+//
+void trans_pb::proto_query_pack()
+{
+    BlockList list;
+
+    // Vectors are complete, addresses are stable
+    auto shaper = query_shaper_.begin();
+    auto codec = query_codec_.begin();
+    auto cache = query_cache_.begin();
+    auto dedup = query_dedup_.begin();
+    auto capture = query_capture_.begin();
+    for (auto &info : query_block_)
+    {
+        if (strcmp(info.type, "shaper") == 0)
+        {
+            info.shaper = &(*shaper);
+            ++shaper;
+        }
+        else if (strcmp(info.type, "codec") == 0)
+        {
+            info.codec = &(*codec);
+            ++codec;
+        }
+        else if (strcmp(info.type, "cache") == 0)
+        {
+            info.cache = &(*cache);
+            ++cache;
+        }
+        else if (strcmp(info.type, "dedup") == 0)
+        {
+            info.dedup = &(*dedup);
+            ++dedup;
+        }
+        else if (strcmp(info.type, "capture") == 0)
+        {
+            info.capture = &(*capture);
+            ++capture;
+        }
+        query_block_ptr_.push_back(&info);
+    }
+    for (auto &bind : query_bind_)
+    {
+        query_bind_ptr_.push_back(&bind);
+    }
+
+    block_list__init(&list);
+    list.n_block = query_block_ptr_.size();
+    list.block = query_block_ptr_.data();
+    list.n_bind = query_bind_ptr_.size();
+    list.bind = query_bind_ptr_.data();
+
+    payload_.resize(block_list__get_packed_size(&list));
+    block_list__pack(&list, payload_.data());
+
+    query_block_.clear();
+    query_block_ptr_.clear();
+    query_bind_.clear();
+    query_bind_ptr_.clear();
+    query_shaper_.clear();
+    query_codec_.clear();
+    query_cache_.clear();
+    query_dedup_.clear();
+    query_capture_.clear();
+}
+
 //
 // @brief Parse and execute a protobuf configuration command
 //
-bool trans_pb::proto_command_parse(const uint8_t *data, size_t size)
+// @param id    : Identifier of the command, to echo in the reply
+// @param error : Reason of the failure, if any
+//
+bool trans_pb::proto_command_parse(const uint8_t *data, size_t size, uint64_t &id, const char *&error)
 {
     Command *cmd;
     bool is_ok;
 
+    id = 0u;
+    error = "";
+
     cmd = command__unpack(nullptr, size, data);
     if (cmd == nullptr)
     {
         LOGGER_ERR("Failed to unpack protobuf command: unknown reason [size=%zu]", size);
+        error = "malformed command";
         return false;
     }
+    id = cmd->id;
 
     switch (cmd->type_case)
     {
     case COMMAND__TYPE_ADD:
         is_ok = mgr_->block_add(cmd->add->id, cmd->add->type);
+        error = (is_ok == true) ? "" : "failed to add block";
         break;
 
     case COMMAND__TYPE_START:
         is_ok = mgr_->block_start(cmd->start->id);
+        error = (is_ok == true) ? "" : "failed to start block";
         break;
 
     case COMMAND__TYPE_STOP:
         is_ok = mgr_->block_stop(cmd->stop->id);
+        error = (is_ok == true) ? "" : "failed to stop block";
         break;
 
     case COMMAND__TYPE_DEL:
         is_ok = mgr_->block_del(cmd->del->id);
+        error = (is_ok == true) ? "" : "failed to delete block";
         break;
 
     case COMMAND__TYPE_BIND:
-        is_ok = mgr_->block_bind(cmd->bind->id, cmd->bind->port, cmd->bind->dest);
+    {
+        struct bind_opt opt;
+
+        opt.queue = cmd->bind->queue;
+        is_ok = mgr_->block_bind(cmd->bind->id, cmd->bind->port, cmd->bind->dest, opt);
+        error = (is_ok == true) ? "" : "failed to bind blocks";
+    }
+    break;
+
+    case COMMAND__TYPE_REPLACE:
+        is_ok = mgr_->block_replace(cmd->replace->id, cmd->replace->type);
+        error = (is_ok == true) ? "" : "failed to replace block";
         break;
 
     case COMMAND__TYPE_HOOK_ZMQ:
     {
-        struct hook_zmq *hook;
-        hook = static_cast<struct hook_zmq *>(mgr_->block_get(cmd->hook_zmq->id));
-        if (hook == nullptr)
+        struct block *bk;
+        bk = mgr_->block_get(cmd->hook_zmq->id);
+        if ((bk == nullptr) || (bk->type_ != "hook_zmq"))
         {
             LOGGER_ERR("Failed to configure ZMQ hook: unknown block [bk_id=%d]", cmd->hook_zmq->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else if (cmd->hook_zmq->credit < 0)
+        {
+            LOGGER_ERR("Failed to configure ZMQ hook: negative credit [bk_id=%d ; credit=%ld]", bk->id_, static_cast<long>(cmd->hook_zmq->credit));
+            error = "negative credit";
             is_ok = false;
         }
         else
         {
+            struct hook_zmq *hook = static_cast<struct hook_zmq *>(bk);
+
             hook->client_ = cmd->hook_zmq->client;
             hook->type_ = cmd->hook_zmq->type;
             hook->name_ = std::string(cmd->hook_zmq->name);
             hook->addr_ = std::string(cmd->hook_zmq->addr);
+            hook->io_cpu_.assign(cmd->hook_zmq->io_cpu, cmd->hook_zmq->io_cpu + cmd->hook_zmq->n_io_cpu);
+            hook->io_priority_ = cmd->hook_zmq->io_priority;
+            hook->deadline_us_ = cmd->hook_zmq->deadline_us;
+            hook->credit_set_(cmd->hook_zmq->credit);
 
-            LOGGER_INFO("Configured ZMQ hook [bk_id=%d ; client=%s ; type=%d ; name=%s ; addr=%s]",
+            LOGGER_INFO("Configured ZMQ hook [bk_id=%d ; client=%s ; type=%d ; name=%s ; addr=%s ; io_cpu_count=%zu ; io_priority=%d ; deadline_us=%ld ; credit=%ld]",
                         hook->id_,
                         hook->client_ ? "true" : "false",
                         hook->type_,
                         hook->name_.c_str(),
-                        hook->addr_.c_str());
+                        hook->addr_.c_str(),
+                        hook->io_cpu_.size(),
+                        hook->io_priority_,
+                        hook->deadline_us_,
+                        hook->credit_max_);
+            is_ok = true;
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_ROUTER:
+    {
+        struct router *rt;
+        rt = static_cast<struct router *>(mgr_->block_get(cmd->router->id));
+        if ((rt == nullptr) || (rt->type_ != "router"))
+        {
+            LOGGER_ERR("Failed to configure router: unknown block [bk_id=%d]", cmd->router->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else
+        {
+            std::vector<struct router_rule> rules;
+
+            for (size_t i = 0u; i < cmd->router->n_rule; ++i)
+            {
+                const RouterRule *rule = cmd->router->rule[i];
+
+                rules.push_back({std::string(reinterpret_cast<const char *>(rule->topic.data), rule->topic.len),
+                                 rule->prefix != 0,
+                                 rule->port});
+            }
+
+            is_ok = rt->rules_set(rules);
+            if (is_ok == true)
+            {
+                rt->default_port_ = cmd->router->default_port;
+                rt->topic_part_ = cmd->router->topic_part;
+            }
+            error = (is_ok == true) ? "" : "failed to set routing rules";
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_BALANCER:
+    {
+        struct balancer *bl;
+        bl = static_cast<struct balancer *>(mgr_->block_get(cmd->balancer->id));
+        if ((bl == nullptr) || (bl->type_ != "balancer"))
+        {
+            LOGGER_ERR("Failed to configure balancer: unknown block [bk_id=%d]", cmd->balancer->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else
+        {
+            bl->policy_ = static_cast<enum balancer_policy>(cmd->balancer->policy);
+            bl->hash_part_ = cmd->balancer->hash_part;
+
+            LOGGER_INFO("Configured balancer [bk_id=%d ; policy=%d ; hash_part=%zu]", bl->id_, bl->policy_, bl->hash_part_);
+            is_ok = true;
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_AGGREGATOR:
+    {
+        struct aggregator *agg;
+        agg = static_cast<struct aggregator *>(mgr_->block_get(cmd->aggregator->id));
+        if ((agg == nullptr) || (agg->type_ != "aggregator"))
+        {
+            LOGGER_ERR("Failed to configure aggregator: unknown block [bk_id=%d]", cmd->aggregator->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else if (cmd->aggregator->latency_us < 0)
+        {
+            LOGGER_ERR("Failed to configure aggregator: negative latency [bk_id=%d ; latency_us=%ld]",
+                       agg->id_, static_cast<long>(cmd->aggregator->latency_us));
+            error = "negative latency";
+            is_ok = false;
+        }
+        else
+        {
+            agg->max_bytes_ = cmd->aggregator->max_bytes;
+            agg->max_count_ = cmd->aggregator->max_count;
+            agg->latency_us_ = static_cast<long>(cmd->aggregator->latency_us);
+
+            // The new thresholds apply to the next batch
+            agg->flush();
+
+            LOGGER_INFO("Configured aggregator [bk_id=%d ; max_bytes=%zu ; max_count=%zu ; latency_us=%ld]",
+                        agg->id_, agg->max_bytes_, agg->max_count_, agg->latency_us_);
+            is_ok = true;
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_SHAPER:
+    {
+        struct shaper *sh;
+        sh = static_cast<struct shaper *>(mgr_->block_get(cmd->shaper->id));
+        if ((sh == nullptr) || (sh->type_ != "shaper"))
+        {
+            LOGGER_ERR("Failed to configure shaper: unknown block [bk_id=%d]", cmd->shaper->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else
+        {
+            sh->policy_ = static_cast<enum shaper_policy>(cmd->shaper->policy);
+            sh->key_part_ = cmd->shaper->key_part;
+            sh->rate_ = cmd->shaper->rate;
+            sh->burst_ = cmd->shaper->burst;
+            sh->queue_max_ = cmd->shaper->queue_max;
+            sh->tick_us_ = static_cast<long>(cmd->shaper->tick_us);
+            sh->limits_update();
+
+            // The new period applies from now on
+            if (sh->is_started_ == true)
+            {
+                sh->timer_arm();
+            }
+
+            LOGGER_INFO("Configured shaper [bk_id=%d ; policy=%d ; rate=%lu ; burst=%lu]",
+                        sh->id_, sh->policy_, static_cast<unsigned long>(sh->rate_), static_cast<unsigned long>(sh->burst_));
             is_ok = true;
         }
     }
     break;
 
+    case COMMAND__TYPE_CODEC:
+    {
+        struct codec *cd;
+        cd = static_cast<struct codec *>(mgr_->block_get(cmd->codec->id));
+        if ((cd == nullptr) || (cd->type_ != "codec"))
+        {
+            LOGGER_ERR("Failed to configure codec: unknown block [bk_id=%d]", cmd->codec->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else if ((cmd->codec->level < Z_BEST_SPEED) || (cmd->codec->level > Z_BEST_COMPRESSION))
+        {
+            LOGGER_ERR("Failed to configure codec: wrong level [bk_id=%d ; level=%d]", cd->id_, cmd->codec->level);
+            error = "wrong level";
+            is_ok = false;
+        }
+        else if ((cmd->codec->mode != CONF_CODEC__MODE__COMPRESS) && (cmd->codec->mode != CONF_CODEC__MODE__DECOMPRESS))
+        {
+            LOGGER_ERR("Failed to configure codec: wrong mode [bk_id=%d ; mode=%u]", cd->id_, static_cast<unsigned int>(cmd->codec->mode));
+            error = "wrong mode";
+            is_ok = false;
+        }
+        else
+        {
+            cd->mode_ = static_cast<enum codec_mode>(cmd->codec->mode);
+            cd->level_ = cmd->codec->level;
+            cd->min_size_ = cmd->codec->min_size;
+            cd->part_mask_ = cmd->codec->part_mask;
+
+            // Streams first: the dictionary is set on them for each message
+            if (cd->stream_init() == false)
+            {
+                error = "failed to initialize streams";
+                is_ok = false;
+            }
+            else if (cd->dict_load(cmd->codec->dict_path) == false)
+            {
+                error = "failed to load dictionary";
+                is_ok = false;
+            }
+            else
+            {
+                LOGGER_INFO("Configured codec [bk_id=%d ; mode=%d ; level=%d ; min_size=%zu ; part_mask=%08x]",
+                            cd->id_, cd->mode_, cd->level_, cd->min_size_, cd->part_mask_);
+                is_ok = true;
+            }
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_CACHE:
+    {
+        struct block *bk;
+        bk = mgr_->block_get(cmd->cache->id);
+        if ((bk != nullptr) && (bk->type_ == "cache"))
+        {
+            struct cache *ca = static_cast<struct cache *>(bk);
+
+            // Entries of the previous keys are not valid anymore
+            ca->flush();
+            ca->key_mask_ = cmd->cache->key_mask;
+            ca->ttl_ms_ = cmd->cache->ttl_ms;
+            ca->max_bytes_ = cmd->cache->max_bytes;
+
+            LOGGER_INFO("Configured cache [bk_id=%d ; key_mask=%08x ; ttl_ms=%ld ; max_bytes=%zu]",
+                        ca->id_, ca->key_mask_, ca->ttl_ms_, ca->max_bytes_);
+            is_ok = true;
+        }
+        else if ((bk != nullptr) && (bk->type_ == "cache_return"))
+        {
+            struct cache_return *ret = static_cast<struct cache_return *>(bk);
+
+            ret->key_mask_ = cmd->cache->key_mask;
+
+            LOGGER_INFO("Configured cache return [bk_id=%d ; key_mask=%08x]", ret->id_, ret->key_mask_);
+            is_ok = true;
+        }
+        else
+        {
+            LOGGER_ERR("Failed to configure cache: unknown block [bk_id=%d]", cmd->cache->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_DEDUP:
+    {
+        struct dedup *dd;
+        dd = static_cast<struct dedup *>(mgr_->block_get(cmd->dedup->id));
+        if ((dd == nullptr) || (dd->type_ != "dedup"))
+        {
+            LOGGER_ERR("Failed to configure dedup: unknown block [bk_id=%d]", cmd->dedup->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else if ((cmd->dedup->fp_rate <= 0.0) || (cmd->dedup->fp_rate >= 1.0))
+        {
+            LOGGER_ERR("Failed to configure dedup: wrong false positive rate [bk_id=%d ; fp_rate=%f]", dd->id_, cmd->dedup->fp_rate);
+            error = "wrong false positive rate";
+            is_ok = false;
+        }
+        else if (cmd->dedup->max_bytes < DEDUP_MIN_BYTES)
+        {
+            LOGGER_ERR("Failed to configure dedup: memory too small [bk_id=%d ; max_bytes=%zu ; min_bytes=%u]",
+                       dd->id_, static_cast<size_t>(cmd->dedup->max_bytes), DEDUP_MIN_BYTES);
+            error = "memory too small";
+            is_ok = false;
+        }
+        else
+        {
+            dd->part_mask_ = cmd->dedup->part_mask;
+            dd->window_ms_ = cmd->dedup->window_ms;
+            dd->fp_rate_ = cmd->dedup->fp_rate;
+            dd->max_bytes_ = cmd->dedup->max_bytes;
+            dd->limits_update();
+
+            LOGGER_INFO("Configured dedup [bk_id=%d ; window_ms=%ld ; fp_rate=%f ; bits=%zu ; hashes=%zu ; capacity=%zu]",
+                        dd->id_, dd->window_ms_, dd->fp_rate_, dd->bits_, dd->hashes_, dd->capacity_);
+            is_ok = true;
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_CAPTURE:
+    {
+        struct capture *cap;
+        cap = static_cast<struct capture *>(mgr_->block_get(cmd->capture->id));
+        if ((cap == nullptr) || (cap->type_ != "capture"))
+        {
+            LOGGER_ERR("Failed to configure capture: unknown block [bk_id=%d]", cmd->capture->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else if ((cmd->capture->path == nullptr) || (cmd->capture->path[0] == '\0'))
+        {
+            LOGGER_ERR("Failed to configure capture: no path [bk_id=%d]", cap->id_);
+            error = "no path";
+            is_ok = false;
+        }
+        else
+        {
+            // Files already opened keep their path and size
+            cap->path_ = cmd->capture->path;
+            cap->file_size_ = cmd->capture->file_size;
+
+            LOGGER_INFO("Configured capture [bk_id=%d ; path=%s ; file_size=%zu]", cap->id_, cap->path_.c_str(), cap->file_size_);
+            is_ok = true;
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_LIST_BLOCKS:
+    case COMMAND__TYPE_GET_GRAPH:
+        for (const auto &it : mgr_->bk_map_)
+        {
+            proto_query_add(it.second, cmd->type_case == COMMAND__TYPE_GET_GRAPH);
+        }
+        proto_query_pack();
+        is_ok = true;
+        break;
+
+    case COMMAND__TYPE_GET_BLOCK:
+    {
+        const struct block *bk;
+
+        bk = mgr_->block_get(cmd->get_block->id);
+        if (bk == nullptr)
+        {
+            LOGGER_ERR("Failed to query block: unknown block [bk_id=%d]", cmd->get_block->id);
+            error = "unknown block";
+            is_ok = false;
+        }
+        else
+        {
+            proto_query_add(bk, true);
+            proto_query_pack();
+            is_ok = true;
+        }
+    }
+    break;
+
+    case COMMAND__TYPE_SNAPSHOT_SAVE:
+        is_ok = snapshot_save(cmd->snapshot_save->path);
+        error = (is_ok == true) ? "" : "failed to save snapshot";
+        break;
+
     case COMMAND__TYPE_TERM:
         is_ok = true;
         mgr_->stop_();
         break;
 
+    case COMMAND__TYPE_SCHED:
+    {
+        struct sched_conf conf;
+
+        conf.cpu_.assign(cmd->sched->cpu, cmd->sched->cpu + cmd->sched->n_cpu);
+        conf.priority_ = cmd->sched->priority;
+        conf.mlock_ = cmd->sched->mlock;
+
+        // The command is executed from the main loop
+        is_ok = conf.apply(nullptr);
+        error = (is_ok == true) ? "" : "failed to apply scheduling";
+    }
+    break;
+
     case COMMAND__TYPE__NOT_SET:
     default:
         LOGGER_ERR("Failed to execute protobuf command: unknown command type [type=%d]", cmd->type_case);
+        error = "unknown command type";
         is_ok = false;
         break;
     }
@@ -95,12 +668,18 @@ bool trans_pb::proto_command_parse(const uint8_t *data, size_t size)
 
 //
 // @brief Reply to a protobuf configuration command
+//          - topic "PROTO.CMD.REP"
+//          - status "OK" or "KO", for simple clients
+//          - packed Reply with the identifier of the command
 //
-void trans_pb::proto_command_reply(bool is_ok)
+void trans_pb::proto_command_reply(uint64_t id, bool is_ok, const char *error)
 {
     struct buffer buf;
     const char *topic;
     const char *status;
+    Reply reply;
+    uint8_t *packed;
+    size_t size;
 
     topic = "PROTO.CMD.REP";
     buf.push_back(topic, strlen(topic));
@@ -108,6 +687,20 @@ void trans_pb::proto_command_reply(bool is_ok)
     status = is_ok ? "OK" : "KO";
     buf.push_back(status, strlen(status));
 
+    reply__init(&reply);
+    reply.id = id;
+    reply.status = is_ok ? REPLY__STATUS__OK : REPLY__STATUS__KO;
+    reply.error = const_cast<char *>(error);
+    reply.payload.data = payload_.data();
+    reply.payload.len = payload_.size();
+
+    size = reply__get_packed_size(&reply);
+    packed = new uint8_t[size];
+    reply__pack(&reply, packed);
+    buf.push_back(packed, size);
+    delete[] packed;
+    payload_.clear();
+
     process_data_(&buf);
 
     buf.clear();
@@ -131,9 +724,12 @@ bool trans_pb::data_(void *vdata)
     // Action to take upon topic value
     if (memcmp("PROTO.CMD", buf.parts_[0].data, buf.parts_[0].len) == 0)
     {
+        const char *error;
+        uint64_t id;
         bool is_ok;
-        is_ok = proto_command_parse(static_cast<uint8_t *>(buf.parts_[1].data), buf.parts_[1].len);
-        proto_command_reply(is_ok);
+
+        is_ok = proto_command_parse(static_cast<uint8_t *>(buf.parts_[1].data), buf.parts_[1].len, id, error);
+        proto_command_reply(id, is_ok, error);
     }
     else
     {
@@ -145,6 +741,76 @@ bool trans_pb::data_(void *vdata)
     return false;
 }
 
+//
+// @brief Management of the application upon signal reception
+//          - SIGINT, SIGTERM : terminate the application
+//          - SIGUSR1         : dump the blocks
+//          - SIGUSR2         : toggle the traces
+//
+void trans_pb::on_signal_(int signo)
+{
+    switch (signo)
+    {
+    case SIGINT:
+    case SIGTERM:
+        LOGGER_INFO("Terminating on signal [signo=%d]", signo);
+        mgr_->stop_();
+        break;
+
+    case SIGUSR1:
+        LOGGER_INFO("Dump blocks [count=%zu ; fd_count=%zu]", mgr_->bk_map_.size(), mgr_->fd_.size());
+        LOGGER_INFO("Dump polls [spin=%lu ; spin_hit=%lu ; sleep=%lu ; sleep_hit=%lu]",
+                    mgr_->spin_count_,
+                    mgr_->spin_hit_,
+                    mgr_->sleep_count_,
+                    mgr_->sleep_hit_);
+        LOGGER_INFO("Dump workers [count=%zu ; submit=%lu ; complete=%lu ; depth_max=%lu ; utilization=%lu%% ; latency_avg_ns=%lu ; latency_max_ns=%lu]",
+                    mgr_->wk_thread_.size(),
+                    mgr_->wk_submit_,
+                    mgr_->wk_complete_,
+                    mgr_->wk_depth_max_,
+                    mgr_->work_utilization(),
+                    (mgr_->wk_complete_ != 0u) ? mgr_->wk_latency_ns_ / mgr_->wk_complete_ : 0u,
+                    mgr_->wk_latency_max_ns_);
+        for (const auto &it : mgr_->bk_map_)
+        {
+            const struct block *bk = it.second;
+
+            LOGGER_INFO("Dump block [bk_id=%d ; bk_type=%s ; started=%s ; sink=%d ; data_rx=%lu ; data_tx=%lu ; ctrl_rx=%lu ; data_expired=%lu ; credit=%ld/%ld ; credit_out=%lu ; flow_paused=%lu]",
+                        bk->id_,
+                        bk->type_.c_str(),
+                        bk->is_started_ ? "true" : "false",
+                        (bk->sink_ != nullptr) ? bk->sink_->id_ : 0,
+                        bk->data_rx_,
+                        bk->data_tx_,
+                        bk->ctrl_rx_,
+                        bk->data_expired_,
+                        bk->credit_,
+                        bk->credit_max_,
+                        bk->credit_out_,
+                        bk->flow_paused_);
+        }
+        break;
+
+    case SIGUSR2:
+        if (logger_enabled == true)
+        {
+            LOGGER_INFO("Disabling traces on signal [signo=%d]", signo);
+            LOGGER_DISABLE();
+        }
+        else
+        {
+            LOGGER_ENABLE();
+            LOGGER_INFO("Enabled traces on signal [signo=%d]", signo);
+        }
+        break;
+
+    default:
+        LOGGER_ERR("Failed to handle signal: unexpected signal [signo=%d]", signo);
+        break;
+    }
+}
+
 //
 // Implementation of the factory interface
 //
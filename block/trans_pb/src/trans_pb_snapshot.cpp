@@ -0,0 +1,477 @@
+//
+// @brief Snapshot of the graph of blocks
+//
+// The snapshot is the sequence of commands rebuilding the graph:
+//   - magic "C3QOSNP1"
+//   - records: length of the packed command (uint32_t, native byte order), packed command
+//
+// Commands are ordered so that a single pass restores the graph: blocks are
+// added and configured, then bound, then started. Management blocks, with a
+// negative identifier, are created by c3qo itself and only their bindings are saved.
+// The port giving the sink of a block is bound last, as it was
+//
+
+// Project headers
+#include "block/aggregator.hpp"
+#include "block/balancer.hpp"
+#include "block/cache.hpp"
+#include "block/capture.hpp"
+#include "block/codec.hpp"
+#include "block/dedup.hpp"
+#include "block/hook_zmq.hpp"
+#include "block/router.hpp"
+#include "block/shaper.hpp"
+#include "block/trans_pb.hpp"
+#include "engine/manager.hpp"
+
+// C headers
+extern "C"
+{
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+#define SNAPSHOT_MAGIC "C3QOSNP1"
+#define SNAPSHOT_MAGIC_LEN 8u
+
+//
+// @brief Append a command to a snapshot
+//
+static void snapshot_append(std::vector<uint8_t> &out, const Command *cmd)
+{
+    uint32_t len;
+    size_t offset;
+
+    len = static_cast<uint32_t>(command__get_packed_size(cmd));
+    offset = out.size();
+
+    out.resize(offset + sizeof(len) + len);
+    memcpy(&out[offset], &len, sizeof(len));
+    command__pack(cmd, &out[offset + sizeof(len)]);
+}
+
+//
+// @brief Append the configuration of a block, for the types having one
+//
+static void snapshot_append_conf(std::vector<uint8_t> &out, struct block *bk)
+{
+    Command cmd;
+
+    command__init(&cmd);
+
+    if (bk->type_ == "hook_zmq")
+    {
+        const struct hook_zmq *hook = static_cast<const struct hook_zmq *>(bk);
+        std::vector<int32_t> io_cpu(hook->io_cpu_.cbegin(), hook->io_cpu_.cend());
+        ConfHookZmq conf;
+
+        conf_hook_zmq__init(&conf);
+        conf.id = hook->id_;
+        conf.client = hook->client_;
+        conf.type = hook->type_;
+        conf.name = const_cast<char *>(hook->name_.c_str());
+        conf.addr = const_cast<char *>(hook->addr_.c_str());
+        conf.n_io_cpu = io_cpu.size();
+        conf.io_cpu = io_cpu.data();
+        conf.io_priority = hook->io_priority_;
+        conf.deadline_us = hook->deadline_us_;
+        conf.credit = hook->credit_max_;
+
+        cmd.type_case = COMMAND__TYPE_HOOK_ZMQ;
+        cmd.hook_zmq = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "router")
+    {
+        const struct router *rt = static_cast<const struct router *>(bk);
+        std::vector<RouterRule> rules(rt->rule_.size());
+        std::vector<RouterRule *> rules_ptr;
+        ConfRouter conf;
+
+        for (size_t i = 0u; i < rt->rule_.size(); ++i)
+        {
+            router_rule__init(&rules[i]);
+            rules[i].topic.data = reinterpret_cast<uint8_t *>(const_cast<char *>(rt->rule_[i].topic_.data()));
+            rules[i].topic.len = rt->rule_[i].topic_.size();
+            rules[i].prefix = rt->rule_[i].prefix_;
+            rules[i].port = rt->rule_[i].port_;
+            rules_ptr.push_back(&rules[i]);
+        }
+
+        conf_router__init(&conf);
+        conf.id = rt->id_;
+        conf.n_rule = rules_ptr.size();
+        conf.rule = rules_ptr.data();
+        conf.default_port = rt->default_port_;
+        conf.topic_part = static_cast<uint32_t>(rt->topic_part_);
+
+        cmd.type_case = COMMAND__TYPE_ROUTER;
+        cmd.router = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "balancer")
+    {
+        const struct balancer *bl = static_cast<const struct balancer *>(bk);
+        ConfBalancer conf;
+
+        conf_balancer__init(&conf);
+        conf.id = bl->id_;
+        conf.policy = static_cast<ConfBalancer__Policy>(bl->policy_);
+        conf.hash_part = static_cast<uint32_t>(bl->hash_part_);
+
+        cmd.type_case = COMMAND__TYPE_BALANCER;
+        cmd.balancer = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "aggregator")
+    {
+        const struct aggregator *agg = static_cast<const struct aggregator *>(bk);
+        ConfAggregator conf;
+
+        conf_aggregator__init(&conf);
+        conf.id = agg->id_;
+        conf.max_bytes = static_cast<uint32_t>(agg->max_bytes_);
+        conf.max_count = static_cast<uint32_t>(agg->max_count_);
+        conf.latency_us = agg->latency_us_;
+
+        cmd.type_case = COMMAND__TYPE_AGGREGATOR;
+        cmd.aggregator = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "shaper")
+    {
+        const struct shaper *sh = static_cast<const struct shaper *>(bk);
+        ConfShaper conf;
+
+        conf_shaper__init(&conf);
+        conf.id = sh->id_;
+        conf.policy = static_cast<ConfShaper__Policy>(sh->policy_);
+        conf.key_part = static_cast<uint32_t>(sh->key_part_);
+        conf.rate = sh->rate_;
+        conf.burst = sh->burst_;
+        conf.queue_max = static_cast<uint32_t>(sh->queue_max_);
+        conf.tick_us = sh->tick_us_;
+
+        cmd.type_case = COMMAND__TYPE_SHAPER;
+        cmd.shaper = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "codec")
+    {
+        const struct codec *cd = static_cast<const struct codec *>(bk);
+        ConfCodec conf;
+
+        conf_codec__init(&conf);
+        conf.id = cd->id_;
+        conf.mode = static_cast<ConfCodec__Mode>(cd->mode_);
+        conf.level = cd->level_;
+        conf.min_size = static_cast<uint32_t>(cd->min_size_);
+        conf.part_mask = cd->part_mask_;
+        conf.dict_path = const_cast<char *>(cd->dict_path_.c_str());
+
+        cmd.type_case = COMMAND__TYPE_CODEC;
+        cmd.codec = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "cache")
+    {
+        const struct cache *ca = static_cast<const struct cache *>(bk);
+        ConfCache conf;
+
+        conf_cache__init(&conf);
+        conf.id = ca->id_;
+        conf.key_mask = ca->key_mask_;
+        conf.ttl_ms = ca->ttl_ms_;
+        conf.max_bytes = ca->max_bytes_;
+
+        cmd.type_case = COMMAND__TYPE_CACHE;
+        cmd.cache = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "cache_return")
+    {
+        const struct cache_return *ret = static_cast<const struct cache_return *>(bk);
+        ConfCache conf;
+
+        conf_cache__init(&conf);
+        conf.id = ret->id_;
+        conf.key_mask = ret->key_mask_;
+
+        cmd.type_case = COMMAND__TYPE_CACHE;
+        cmd.cache = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "dedup")
+    {
+        const struct dedup *dd = static_cast<const struct dedup *>(bk);
+        ConfDedup conf;
+
+        conf_dedup__init(&conf);
+        conf.id = dd->id_;
+        conf.part_mask = dd->part_mask_;
+        conf.window_ms = dd->window_ms_;
+        conf.fp_rate = dd->fp_rate_;
+        conf.max_bytes = dd->max_bytes_;
+
+        cmd.type_case = COMMAND__TYPE_DEDUP;
+        cmd.dedup = &conf;
+        snapshot_append(out, &cmd);
+    }
+    else if (bk->type_ == "capture")
+    {
+        const struct capture *cap = static_cast<const struct capture *>(bk);
+        ConfCapture conf;
+
+        conf_capture__init(&conf);
+        conf.id = cap->id_;
+        conf.path = const_cast<char *>(cap->path_.c_str());
+        conf.file_size = cap->file_size_;
+
+        cmd.type_case = COMMAND__TYPE_CAPTURE;
+        cmd.capture = &conf;
+        snapshot_append(out, &cmd);
+    }
+}
+
+//
+// @brief Append the binding of a port
+//
+// Bindings to a block of another manager are not saved, that manager is not part of the snapshot
+//
+static void snapshot_append_bind(std::vector<uint8_t> &out, struct block *bk, int port, int dest)
+{
+    Command cmd;
+    BlockBind bind;
+
+    command__init(&cmd);
+    block_bind__init(&bind);
+    cmd.type_case = COMMAND__TYPE_BIND;
+    cmd.bind = &bind;
+    cmd.bind->id = bk->id_;
+    cmd.bind->port = port;
+    cmd.bind->dest = dest;
+
+    const auto &eg = bk->edge_.find(port);
+    if (eg != bk->edge_.cend())
+    {
+        if (eg->second->dst_mgr_ != bk->mgr_)
+        {
+            LOGGER_ERR("Failed to save binding: sink is in another manager [bk_id=%d ; port=%d ; bk_id_dest=%d]", bk->id_, port, dest);
+            return;
+        }
+        cmd.bind->queue = eg->second->ring_.capacity();
+    }
+    snapshot_append(out, &cmd);
+}
+
+//
+// @brief Write the graph of blocks in a file
+//
+// The file is written aside then renamed: a snapshot is either complete or absent
+//
+bool trans_pb::snapshot_save(const char *path)
+{
+    std::vector<uint8_t> out;
+    std::string tmp;
+    Command cmd;
+    FILE *file;
+
+    out.insert(out.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + SNAPSHOT_MAGIC_LEN);
+
+    // Blocks and their configuration
+    for (const auto &it : mgr_->bk_map_)
+    {
+        BlockAdd add;
+
+        if (it.first < 0)
+        {
+            continue;
+        }
+
+        command__init(&cmd);
+        block_add__init(&add);
+        cmd.type_case = COMMAND__TYPE_ADD;
+        cmd.add = &add;
+        cmd.add->id = it.first;
+        cmd.add->type = const_cast<char *>(it.second->type_.c_str());
+        snapshot_append(out, &cmd);
+
+        snapshot_append_conf(out, it.second);
+    }
+
+    // Bindings, once every block exists
+    for (const auto &it : mgr_->bk_map_)
+    {
+        int sink_port;
+
+        // The last port bound gives the sink of the block, it is restored last
+        sink_port = -1;
+        for (const auto &bind_it : it.second->binds_)
+        {
+            const auto &eg = it.second->edge_.find(bind_it.first);
+            if (eg != it.second->edge_.cend())
+            {
+                if (eg->second == it.second->sink_)
+                {
+                    sink_port = bind_it.first;
+                }
+            }
+            else if ((it.second->sink_ != nullptr) && (bind_it.second == it.second->sink_->id_) && (sink_port == -1))
+            {
+                sink_port = bind_it.first;
+            }
+        }
+
+        for (const auto &bind_it : it.second->binds_)
+        {
+            if (bind_it.first != sink_port)
+            {
+                snapshot_append_bind(out, it.second, bind_it.first, bind_it.second);
+            }
+        }
+        if (sink_port != -1)
+        {
+            snapshot_append_bind(out, it.second, sink_port, it.second->binds_.at(sink_port));
+        }
+    }
+
+    // Started blocks, once bound
+    for (const auto &it : mgr_->bk_map_)
+    {
+        BlockStart start;
+
+        if ((it.first < 0) || (it.second->is_started_ == false))
+        {
+            continue;
+        }
+
+        command__init(&cmd);
+        block_start__init(&start);
+        cmd.type_case = COMMAND__TYPE_START;
+        cmd.start = &start;
+        cmd.start->id = it.first;
+        snapshot_append(out, &cmd);
+    }
+
+    tmp = std::string(path) + ".tmp";
+    file = fopen(tmp.c_str(), "w");
+    if (file == nullptr)
+    {
+        LOGGER_ERR("Failed to open snapshot: %s [errno=%d ; path=%s]", strerror(errno), errno, tmp.c_str());
+        return false;
+    }
+    if (fwrite(out.data(), 1u, out.size(), file) != out.size())
+    {
+        LOGGER_ERR("Failed to write snapshot: %s [errno=%d ; path=%s]", strerror(errno), errno, tmp.c_str());
+        fclose(file);
+        unlink(tmp.c_str());
+        return false;
+    }
+    if (fclose(file) != 0)
+    {
+        LOGGER_ERR("Failed to close snapshot: %s [errno=%d ; path=%s]", strerror(errno), errno, tmp.c_str());
+        unlink(tmp.c_str());
+        return false;
+    }
+    if (rename(tmp.c_str(), path) != 0)
+    {
+        LOGGER_ERR("Failed to rename snapshot: %s [errno=%d ; path=%s]", strerror(errno), errno, path);
+        unlink(tmp.c_str());
+        return false;
+    }
+
+    LOGGER_INFO("Saved snapshot [path=%s ; size=%zu ; block_count=%zu]", path, out.size(), mgr_->bk_map_.size());
+
+    return true;
+}
+
+//
+// @brief Rebuild the graph of blocks from a file, in one pass
+//
+// Every command is executed even if one fails, to restore as much as possible
+//
+bool trans_pb::snapshot_load(const char *path)
+{
+    struct stat st;
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+    unsigned long count;
+    unsigned long failed;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        LOGGER_ERR("Failed to open snapshot: %s [errno=%d ; path=%s]", strerror(errno), errno, path);
+        return false;
+    }
+    if (fstat(fd, &st) == -1)
+    {
+        LOGGER_ERR("Failed to stat snapshot: %s [errno=%d ; path=%s]", strerror(errno), errno, path);
+        close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size < SNAPSHOT_MAGIC_LEN)
+    {
+        LOGGER_ERR("Failed to load snapshot: file too short [path=%s ; size=%zu]", path, size);
+        close(fd);
+        return false;
+    }
+
+    data = static_cast<const uint8_t *>(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        LOGGER_ERR("Failed to map snapshot: %s [errno=%d ; path=%s]", strerror(errno), errno, path);
+        return false;
+    }
+    if (memcmp(data, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN) != 0)
+    {
+        LOGGER_ERR("Failed to load snapshot: wrong magic [path=%s]", path);
+        munmap(const_cast<uint8_t *>(data), size);
+        return false;
+    }
+
+    count = 0u;
+    failed = 0u;
+    offset = SNAPSHOT_MAGIC_LEN;
+    while (offset < size)
+    {
+        const char *error;
+        uint64_t id;
+        uint32_t len;
+
+        if (size - offset < sizeof(len))
+        {
+            LOGGER_ERR("Failed to load snapshot: truncated record [path=%s ; offset=%zu]", path, offset);
+            ++failed;
+            break;
+        }
+        memcpy(&len, &data[offset], sizeof(len));
+        offset += sizeof(len);
+        if (size - offset < len)
+        {
+            LOGGER_ERR("Failed to load snapshot: truncated record [path=%s ; offset=%zu ; len=%u]", path, offset, len);
+            ++failed;
+            break;
+        }
+
+        if (proto_command_parse(&data[offset], len, id, error) == false)
+        {
+            LOGGER_ERR("Failed to restore snapshot command: %s [path=%s ; offset=%zu]", error, path, offset);
+            ++failed;
+        }
+        offset += len;
+        ++count;
+    }
+
+    munmap(const_cast<uint8_t *>(data), size);
+
+    LOGGER_INFO("Loaded snapshot [path=%s ; command_count=%lu ; failed=%lu]", path, count, failed);
+
+    return (failed == 0u);
+}
@@ -3,6 +3,13 @@
 //
 
 // Project headers
+#include "block/aggregator.hpp"
+#include "block/cache.hpp"
+#include "block/capture.hpp"
+#include "block/codec.hpp"
+#include "block/dedup.hpp"
+#include "block/router.hpp"
+#include "block/shaper.hpp"
 #include "block/trans_pb.hpp"
 #include "engine/tu.hpp"
 
@@ -177,12 +184,340 @@ static void tu_trans_pb_pbc_conf()
     ASSERT(test.mgr_.block_get(bk_id) == nullptr);
 }
 
+//
+// @brief Queries of the blocks and of their bindings
+//
+static void tu_trans_pb_query()
+{
+    struct tu_trans_pb test;
+    Command cmd;
+    BlockGet get;
+    BlockList *list;
+    uint8_t packed[64];
+    size_t size;
+    uint64_t id;
+    const char *error;
+
+    ASSERT(test.mgr_.block_add(1, "trans_pb") == true);
+    ASSERT(test.mgr_.block_add(2, "trans_pb") == true);
+    ASSERT(test.mgr_.block_bind(1, 3, 2) == true);
+
+    // Graph: every block and every binding
+    command__init(&cmd);
+    cmd.id = 42u;
+    cmd.type_case = COMMAND__TYPE_GET_GRAPH;
+    cmd.get_graph = true;
+    size = command__pack(&cmd, packed);
+    ASSERT(test.block_.proto_command_parse(packed, size, id, error) == true);
+    ASSERT(id == 42u);
+
+    list = block_list__unpack(nullptr, test.block_.payload_.size(), test.block_.payload_.data());
+    ASSERT(list != nullptr);
+    ASSERT(list->n_block == 2u);
+    ASSERT(list->block[0]->id == 1);
+    ASSERT(strcmp(list->block[0]->type, "trans_pb") == 0);
+    ASSERT(list->block[0]->sink == 2);
+    ASSERT(list->n_bind == 1u);
+    ASSERT(list->bind[0]->id == 1);
+    ASSERT(list->bind[0]->port == 3);
+    ASSERT(list->bind[0]->dest == 2);
+    block_list__free_unpacked(list, nullptr);
+    test.block_.payload_.clear();
+
+    // Unknown block
+    command__init(&cmd);
+    block_get__init(&get);
+    cmd.type_case = COMMAND__TYPE_GET_BLOCK;
+    cmd.get_block = &get;
+    cmd.get_block->id = 7;
+    size = command__pack(&cmd, packed);
+    ASSERT(test.block_.proto_command_parse(packed, size, id, error) == false);
+    ASSERT(strcmp(error, "unknown block") == 0);
+    ASSERT(test.block_.payload_.empty() == true);
+
+    test.mgr_.block_clear();
+}
+
+//
+// @brief Save a graph and restore it in another manager
+//
+static void tu_trans_pb_snapshot()
+{
+    const char *path = "/tmp/tu_trans_pb.snapshot";
+    struct router_factory router_factory;
+    struct aggregator_factory aggregator_factory;
+    struct shaper_factory shaper_factory;
+    struct codec_factory codec_factory;
+    struct cache_factory cache_factory;
+    struct cache_return_factory cache_return_factory;
+    struct dedup_factory dedup_factory;
+    struct capture_factory capture_factory;
+
+    {
+        struct manager other;
+        struct tu_trans_pb test;
+        struct router *rt;
+        struct aggregator *agg;
+        struct shaper *sh;
+        struct codec *cd;
+        struct cache *ca;
+        struct cache_return *ret;
+        struct dedup *dd;
+        struct capture *cap;
+
+        test.mgr_.block_factory_register("router", &router_factory);
+        test.mgr_.block_factory_register("aggregator", &aggregator_factory);
+        test.mgr_.block_factory_register("shaper", &shaper_factory);
+        test.mgr_.block_factory_register("codec", &codec_factory);
+        test.mgr_.block_factory_register("cache", &cache_factory);
+        test.mgr_.block_factory_register("cache_return", &cache_return_factory);
+        test.mgr_.block_factory_register("dedup", &dedup_factory);
+        test.mgr_.block_factory_register("capture", &capture_factory);
+
+        ASSERT(test.mgr_.block_add(1, "trans_pb") == true);
+        ASSERT(test.mgr_.block_add(2, "router") == true);
+        ASSERT(test.mgr_.block_add(3, "trans_pb") == true);
+        ASSERT(test.mgr_.block_add(4, "aggregator") == true);
+        ASSERT(test.mgr_.block_add(5, "shaper") == true);
+        ASSERT(test.mgr_.block_add(6, "codec") == true);
+        ASSERT(test.mgr_.block_add(7, "cache") == true);
+        ASSERT(test.mgr_.block_add(8, "cache_return") == true);
+        ASSERT(test.mgr_.block_add(9, "dedup") == true);
+        ASSERT(test.mgr_.block_add(10, "capture") == true);
+        ASSERT(test.mgr_.block_bind(8, 1, 7) == true);
+        ASSERT(test.mgr_.block_bind(1, 0, 2) == true);
+        ASSERT(test.mgr_.block_bind(2, 4, 3) == true);
+        ASSERT(test.mgr_.block_bind(2, 0, 5) == true);
+        {
+            struct bind_opt opt;
+
+            opt.queue = 16u;
+            ASSERT(test.mgr_.block_bind(9, 0, 10, opt) == true);
+
+            // Blocks of another manager are not part of the snapshot
+            other.block_factory_register("router", &router_factory);
+            ASSERT(other.block_add(1, "router") == true);
+            ASSERT(other.queue_start() == true);
+            opt.mgr = &other;
+            ASSERT(test.mgr_.block_bind(3, 0, 1, opt) == true);
+        }
+        ASSERT(test.mgr_.block_start(1) == true);
+        ASSERT(test.mgr_.block_start(2) == true);
+        ASSERT(test.mgr_.block_start(10) == true);
+
+        rt = static_cast<struct router *>(test.mgr_.block_get(2));
+        ASSERT(rt->rules_set({{"A", false, 4}}) == true);
+        rt->default_port_ = 4;
+
+        agg = static_cast<struct aggregator *>(test.mgr_.block_get(4));
+        agg->max_count_ = 16u;
+        agg->latency_us_ = 500;
+
+        sh = static_cast<struct shaper *>(test.mgr_.block_get(5));
+        sh->policy_ = SHAPER_QUEUE;
+        sh->rate_ = 10u;
+        sh->limits_update();
+
+        cd = static_cast<struct codec *>(test.mgr_.block_get(6));
+        cd->mode_ = CODEC_DECOMPRESS;
+        cd->level_ = 6;
+
+        ca = static_cast<struct cache *>(test.mgr_.block_get(7));
+        ca->ttl_ms_ = 250;
+        ca->max_bytes_ = 4096u;
+        ret = static_cast<struct cache_return *>(test.mgr_.block_get(8));
+        ret->key_mask_ = 0x3u;
+
+        dd = static_cast<struct dedup *>(test.mgr_.block_get(9));
+        dd->fp_rate_ = 0.01;
+        dd->max_bytes_ = 64u * 1024u;
+        dd->limits_update();
+
+        cap = static_cast<struct capture *>(test.mgr_.block_get(10));
+        cap->path_ = "/tmp/tu_trans_pb.cap";
+        cap->file_size_ = 1u << 20;
+
+        ASSERT(test.block_.snapshot_save(path) == true);
+
+        test.mgr_.block_clear();
+    }
+
+    {
+        struct tu_trans_pb test;
+        struct router *rt;
+        struct aggregator *agg;
+        struct shaper *sh;
+        struct codec *cd;
+        struct cache *ca;
+        struct cache_return *ret;
+        struct dedup *dd;
+        struct capture *cap;
+
+        test.mgr_.block_factory_register("router", &router_factory);
+        test.mgr_.block_factory_register("aggregator", &aggregator_factory);
+        test.mgr_.block_factory_register("shaper", &shaper_factory);
+        test.mgr_.block_factory_register("codec", &codec_factory);
+        test.mgr_.block_factory_register("cache", &cache_factory);
+        test.mgr_.block_factory_register("cache_return", &cache_return_factory);
+        test.mgr_.block_factory_register("dedup", &dedup_factory);
+        test.mgr_.block_factory_register("capture", &capture_factory);
+
+        // Workers run before the graph is restored, as in the application
+        ASSERT(test.mgr_.work_start(1u) == true);
+        ASSERT(test.block_.snapshot_load(path) == true);
+        ASSERT(test.mgr_.bk_map_.size() == 10u);
+        ASSERT(test.mgr_.block_get(1)->is_started_ == true);
+        ASSERT(test.mgr_.block_get(1)->sink_ == test.mgr_.block_get(2));
+        ASSERT(test.mgr_.block_get(2)->sink_ == test.mgr_.block_get(5));
+        ASSERT(test.mgr_.block_get(3)->is_started_ == false);
+        ASSERT(test.mgr_.block_get(3)->binds_.empty() == true);
+        ASSERT(test.mgr_.block_get(9)->edge_.at(0)->ring_.capacity() == 16u);
+        ASSERT(test.mgr_.block_get(9)->sink_ == test.mgr_.block_get(9)->edge_.at(0));
+
+        rt = static_cast<struct router *>(test.mgr_.block_get(2));
+        ASSERT(rt->type_ == "router");
+        ASSERT(rt->is_started_ == true);
+        ASSERT(rt->rule_.size() == 1u);
+        ASSERT(rt->default_port_ == 4);
+        ASSERT(rt->port_.size() == 5u);
+        ASSERT(rt->port_[4] == test.mgr_.block_get(3));
+
+        agg = static_cast<struct aggregator *>(test.mgr_.block_get(4));
+        ASSERT(agg->type_ == "aggregator");
+        ASSERT(agg->max_count_ == 16u);
+        ASSERT(agg->latency_us_ == 500);
+
+        sh = static_cast<struct shaper *>(test.mgr_.block_get(5));
+        ASSERT(sh->policy_ == SHAPER_QUEUE);
+        ASSERT(sh->rate_ == 10u);
+        ASSERT(sh->tick_fill_ == 10u * static_cast<uint64_t>(sh->tick_us_));
+
+        // Limits are readable
+        test.block_.proto_query_add(sh, false);
+        ASSERT(test.block_.query_shaper_.size() == 1u);
+        ASSERT(test.block_.query_shaper_[0].rate == 10u);
+
+        cd = static_cast<struct codec *>(test.mgr_.block_get(6));
+        ASSERT(cd->mode_ == CODEC_DECOMPRESS);
+        ASSERT(cd->level_ == 6);
+        ASSERT(cd->is_init_ == true);
+        test.block_.proto_query_add(cd, false);
+        ASSERT(test.block_.query_codec_.size() == 1u);
+
+        ca = static_cast<struct cache *>(test.mgr_.block_get(7));
+        ASSERT(ca->ttl_ms_ == 250);
+        ASSERT(ca->max_bytes_ == 4096u);
+        ret = static_cast<struct cache_return *>(test.mgr_.block_get(8));
+        ASSERT(ret->key_mask_ == 0x3u);
+        ASSERT(ret->cache_ == ca);
+        test.block_.proto_query_add(ca, false);
+        ASSERT(test.block_.query_cache_.size() == 1u);
+
+        dd = static_cast<struct dedup *>(test.mgr_.block_get(9));
+        ASSERT(dd->fp_rate_ == 0.01);
+        ASSERT(dd->hashes_ == 9u);
+        ASSERT(dd->filter_.size() * sizeof(uint64_t) <= 64u * 1024u);
+        test.block_.proto_query_add(dd, false);
+        ASSERT(test.block_.query_dedup_.size() == 1u);
+
+        cap = static_cast<struct capture *>(test.mgr_.block_get(10));
+        ASSERT(cap->path_ == "/tmp/tu_trans_pb.cap");
+        ASSERT(cap->file_size_ == 1u << 20);
+        test.block_.proto_query_add(cap, false);
+        ASSERT(test.block_.query_capture_.size() == 1u);
+        test.block_.proto_query_pack();
+        ASSERT(test.block_.payload_.empty() == false);
+
+        // Restored capture records in the files opened by the workers
+        ASSERT(cap->is_started_ == true);
+        for (int i = 0; (i < 1000) && (cap->next_ == nullptr); ++i)
+        {
+            test.mgr_.fd_poll();
+        }
+        ASSERT(cap->cur_ != nullptr);
+        ASSERT(cap->next_ != nullptr);
+        ASSERT(cap->error_ == 0u);
+
+        // Blocks exist already
+        ASSERT(test.block_.snapshot_load(path) == false);
+
+        ASSERT(test.mgr_.block_stop(10) == true);
+        for (int i = 0; (i < 1000) && (cap->busy_.empty() == false); ++i)
+        {
+            test.mgr_.fd_poll();
+        }
+        ASSERT(cap->busy_.empty() == true);
+        unlink("/tmp/tu_trans_pb.cap.000000");
+
+        test.mgr_.work_stop();
+        test.mgr_.block_clear();
+    }
+
+    // Errors
+    {
+        struct tu_trans_pb test;
+        FILE *file;
+
+        ASSERT(test.block_.snapshot_load("/tmp/tu_trans_pb.nonexistent") == false);
+        ASSERT(test.block_.snapshot_save("/nonexistent/tu_trans_pb.snapshot") == false);
+
+        file = fopen(path, "w");
+        ASSERT(file != nullptr);
+        fprintf(file, "C3QO");
+        fclose(file);
+        ASSERT(test.block_.snapshot_load(path) == false);
+
+        file = fopen(path, "w");
+        ASSERT(file != nullptr);
+        fprintf(file, "C3QOSNAPSHOT");
+        fclose(file);
+        ASSERT(test.block_.snapshot_load(path) == false);
+
+        // Truncated record
+        file = fopen(path, "w");
+        ASSERT(file != nullptr);
+        fprintf(file, "C3QOSNP1");
+        fputc(0x10, file);
+        fclose(file);
+        ASSERT(test.block_.snapshot_load(path) == false);
+    }
+
+    remove(path);
+}
+
+//
+// @brief Application management on signal reception
+//
+static void tu_trans_pb_signal()
+{
+    struct tu_trans_pb test;
+
+    // Dump blocks and toggle traces
+    test.block_.on_signal_(SIGUSR1);
+    test.block_.on_signal_(SIGUSR2);
+    ASSERT(logger_enabled == false);
+    test.block_.on_signal_(SIGUSR2);
+    ASSERT(logger_enabled == true);
+
+    // Unexpected signal
+    test.block_.on_signal_(SIGALRM);
+
+    // Terminate the manager
+    test.mgr_.start_();
+    ASSERT(test.mgr_.is_term_ == false);
+    test.block_.on_signal_(SIGTERM);
+    ASSERT(test.mgr_.is_term_ == true);
+}
+
 int main(int, char **)
 {
     LOGGER_OPEN("tu_trans_pb");
 
     tu_trans_pb_errors();
     tu_trans_pb_pbc_conf();
+    tu_trans_pb_query();
+    tu_trans_pb_snapshot();
+    tu_trans_pb_signal();
 
     LOGGER_CLOSE();
     return 0;
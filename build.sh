@@ -18,6 +18,7 @@ c3qo_generate_path $DIR_SCRIPT
 #
 # C3QO customization parameters
 #
+C3QO_BENCH="OFF"
 C3QO_COVERAGE="OFF"
 C3QO_LOG="OFF"
 C3QO_TEST="OFF"
@@ -29,12 +30,18 @@ CMAKE_TOOLCHAIN_FILE=$C3QO_DIR_SOURCE/toolchain_linux_x86_64_gcc.cmake
 # MAKE customization
 MAKE_JOBS=4
 
+# Benchmark customization
+BENCH_RUNS=5
+
 # Action to do, specified from command line options
+ACTION_BENCH_COMPARE="false"
+ACTION_BENCH_UPDATE="false"
 ACTION_BUILD="false"
 ACTION_CLEAN="false"
 ACTION_INSTALL="false"
 ACTION_LCOV="false"
 ACTION_PACK="false"
+ACTION_RUN_BENCH="false"
 ACTION_SETUP="false"
 ACTION_TEST="false"
 
@@ -171,6 +178,66 @@ function action_test
     make -C $C3QO_DIR_BUILD test
 }
 
+#
+# Verify that the benchmarks are built
+#
+function bench_verify
+{
+    if [ ! -x $C3QO_DIR_BUILD/bench/bench_c3qo ]
+    then
+        echo "FAILED: benchmarks are not built. Did you build with -E?"
+        exit 1
+    fi
+}
+
+#
+# Run the benchmarks
+#
+function action_bench
+{
+    bench_verify
+
+    $C3QO_DIR_BUILD/bench/bench_c3qo -o $C3QO_DIR_BUILD/bench.json
+
+    echo "JSON report available at: $C3QO_DIR_BUILD/bench.json"
+}
+
+#
+# Run the benchmarks several times to smooth out the noise between runs
+#
+function bench_runs
+{
+    local run=
+
+    bench_verify
+
+    rm -f $C3QO_DIR_BUILD/bench/run_*.json
+    for run in $(seq 1 $BENCH_RUNS)
+    do
+        $C3QO_DIR_BUILD/bench/bench_c3qo -o $C3QO_DIR_BUILD/bench/run_$run.json
+    done
+}
+
+#
+# Compare the benchmarks against the baseline of this machine class
+#
+function action_bench_compare
+{
+    bench_runs
+
+    $C3QO_DIR_SOURCE/bench/bench_compare.py compare $C3QO_DIR_BUILD/bench/run_*.json
+}
+
+#
+# Record the benchmarks as the baseline of this machine class
+#
+function action_bench_update
+{
+    bench_runs
+
+    $C3QO_DIR_SOURCE/bench/bench_compare.py update $C3QO_DIR_BUILD/bench/run_*.json
+}
+
 #
 # Gather coverage report
 #
@@ -232,7 +299,7 @@ function action_lcov
 #
 # Retrieve command line options
 #
-while getopts "bchilpstAB:C:GJ:LT" opt
+while getopts "bchiklprstAB:C:D:EGJ:KLN:T" opt
 do
     case "${opt}" in
         b)
@@ -247,12 +314,18 @@ do
         i)
             ACTION_INSTALL="true"
             ;;
+        k)
+            ACTION_BENCH_COMPARE="true"
+            ;;
         l)
             ACTION_LCOV="true"
             ;;
         p)
             ACTION_PACK="true"
             ;;
+        r)
+            ACTION_RUN_BENCH="true"
+            ;;
         s)
             ACTION_SETUP="true"
             ;;
@@ -269,15 +342,28 @@ do
         C)
             CMAKE_TOOLCHAIN_FILE=$OPTARG
             ;;
+        D)
+            C3QO_DIR_BUILD=$(readlink -m $OPTARG)
+            C3QO_DIR_LCOV=$(readlink -m $C3QO_DIR_BUILD/lcov)
+            ;;
+        E)
+            C3QO_BENCH="ON"
+            ;;
         G)
             C3QO_COVERAGE="ON"
             ;;
         J)
             MAKE_JOBS=$OPTARG
             ;;
+        K)
+            ACTION_BENCH_UPDATE="true"
+            ;;
         L)
             C3QO_LOG="ON"
             ;;
+        N)
+            BENCH_RUNS=$OPTARG
+            ;;
         T)
             C3QO_TEST="ON"
             ;;
@@ -293,6 +379,7 @@ done
 CMAKE_OPTIONS=
 CMAKE_OPTIONS="$CMAKE_OPTIONS -DCMAKE_BUILD_TYPE:STRING=$CMAKE_BUILD_TYPE"
 CMAKE_OPTIONS="$CMAKE_OPTIONS -DCMAKE_TOOLCHAIN_FILE:STRING=$CMAKE_TOOLCHAIN_FILE"
+CMAKE_OPTIONS="$CMAKE_OPTIONS -DC3QO_BENCH:BOOL=$C3QO_BENCH"
 CMAKE_OPTIONS="$CMAKE_OPTIONS -DC3QO_COVERAGE:BOOL=$C3QO_COVERAGE"
 CMAKE_OPTIONS="$CMAKE_OPTIONS -DC3QO_LOG:BOOL=$C3QO_LOG"
 CMAKE_OPTIONS="$CMAKE_OPTIONS -DC3QO_PROTOBUF:STRING=$C3QO_DIR_TOOLS/protobuf-c-1.3.1"
@@ -323,6 +410,21 @@ then
     action_test
 fi
 
+if [ $ACTION_RUN_BENCH = "true" ]
+then
+    action_bench
+fi
+
+if [ $ACTION_BENCH_COMPARE = "true" ]
+then
+    action_bench_compare
+fi
+
+if [ $ACTION_BENCH_UPDATE = "true" ]
+then
+    action_bench_update
+fi
+
 if [ $ACTION_PACK = "true" ]
 then
     action_package
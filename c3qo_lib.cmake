@@ -103,6 +103,19 @@ function (c3qo_add_test target_name target_sources)
     add_test(NAME ${target_name} COMMAND ${target_name})
 endfunction()
 
+#
+# Add a benchmark
+#
+function (c3qo_add_bench target_name target_sources)
+    add_executable(${target_name} ${target_sources})
+
+    c3qo_target_compile_flags(${target_name})
+    c3qo_target_link_flags(${target_name})
+
+    target_link_libraries(${target_name} logger)
+    target_link_libraries(${target_name} bench)
+endfunction()
+
 install(FILES ${C3QO_PROTOBUF}/protobuf-c/.libs/libprotobuf-c.so DESTINATION lib)
 install(FILES ${C3QO_PROTOBUF}/protobuf-c/.libs/libprotobuf-c.so.1 DESTINATION lib)
 install(FILES ${C3QO_PROTOBUF}/protobuf-c/.libs/libprotobuf-c.so.1.0.0 DESTINATION lib)
@@ -2,8 +2,14 @@
 #define BLOCK_HPP
 
 // Project headers
+#include "engine/mpsc.hpp"
+#include "utils/buffer.hpp"
 #include "utils/logger.hpp"
 
+// C++ headers
+#include <map>
+#include <vector>
+
 //
 // @struct timer
 //
@@ -27,6 +33,22 @@ struct file_desc
     bool write;       // Look for write events
 };
 
+//
+// @struct work
+//
+// @brief Work item offloaded to a worker thread
+//
+struct work : mpsc_node
+{
+    struct block *bk;     // Block to be notified on completion
+    struct buffer buf;    // Buffer to process
+    void *arg;            // Generic argument to forward on completion
+    bool forward;         // Result of the processing
+    struct timespec date; // Submission date
+};
+
+struct edge;
+
 //
 // @struct block
 //
@@ -34,10 +56,33 @@ struct file_desc
 //
 struct block
 {
-    int id_;             // Block ID
-    std::string type_;   // Block type
-    bool is_started_;    // Block state
-    struct block *sink_; // Block bindings
+    int id_;                            // Block ID
+    std::string type_;                  // Block type
+    bool is_started_;                   // Block state
+    struct block *sink_;                // Block bindings
+    std::map<int, int> binds_;          // Destination block of each bound port
+    std::map<int, struct edge *> edge_; // Queue of each port bound with one
+
+    //
+    // Statistics
+    //
+    unsigned long data_rx_;      // Data received
+    unsigned long data_tx_;      // Data sent or forwarded to a sink
+    unsigned long ctrl_rx_;      // Notifications received
+    unsigned long data_expired_; // Data dropped past their deadline, instead of being received
+
+    unsigned long wk_pending_; // Work submitted, not completed yet
+
+    //
+    // Flow control: a sink holding data grants credits to the blocks sending to it
+    //
+    long credit_max_;                // Data the block can hold, 0 without flow control
+    long credit_;                    // Credits left: data the block can still hold
+    bool credit_empty_;              // Out of credits, the blocks sending to it are paused
+    std::vector<int> credit_paused_; // Blocks paused while the block is out of credits
+    unsigned long credit_out_;       // Times the block ran out of credits
+    unsigned long flow_hold_;        // Sinks out of credits downstream, the block is paused while not 0
+    unsigned long flow_paused_;      // Times the block was paused
 
     struct manager *mgr_; // Manager of this block
 
@@ -49,18 +94,37 @@ struct block
     virtual void start_();
     virtual void stop_();
 
+    // Replacement callback: take over the configuration and the data held by the replaced block
+    virtual void transfer_(struct block *old_bk);
+
     // Timer callback
     virtual void on_timer_(struct timer &tm);
 
     // File descriptor callback
     virtual void on_fd_(struct file_desc &fd);
 
+    // Signal callback
+    virtual void on_signal_(int signo);
+
+    // Work callbacks: processing is done by a worker thread, completion in the loop
+    virtual bool work_(struct work &wk);
+    virtual void on_work_(struct work &wk);
+
+    // Flow control callback: stop or resume producing data
+    virtual void on_flow_(bool is_paused);
+
     // Data callbacks
     virtual bool data_(void *data);
     virtual void ctrl_(void *notif);
 
-    // Flow methods
+    // Flow control methods, for the blocks holding data
+    void credit_set_(long count);
+    bool credit_take_();
+    void credit_give_(long count);
+
+    // Flow methods: data is a buffer, or nullptr
     void process_data_(void *data);
+    void process_data_(struct block *sink, void *data);
     void process_ctrl_(int bk_id, void *notif);
 };
 
@@ -3,23 +3,104 @@
 
 // Project headers
 #include "engine/block.hpp"
+#include "engine/spsc.hpp"
 #include "utils/logger.hpp"
 #include "utils/buffer.hpp"
 
 // C++ headers
+#include <condition_variable>
+#include <deque>
 #include <forward_list>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 // C headers
 extern "C"
 {
+#include <signal.h>
 #include <zmq.h>
 }
 
 bool operator<(const struct timespec &a, const struct timespec &b);
+long elapsed_ns(const struct timespec &from, const struct timespec &to);
 
 bool operator==(const struct timer &a, const struct timer &b);
 bool operator<(const struct timer &a, const struct timer &b);
 
+//
+// @struct mail
+//
+// @brief Data or notification posted to a block by another thread
+//
+struct mail : mpsc_node
+{
+    int bk_id;         // Block to deliver the mail to
+    bool is_data;      // Either data or notification
+    struct buffer buf; // Data
+    void *notif;       // Notification
+};
+
+//
+// @struct bind_opt
+//
+// @brief Options of a binding
+//
+struct bind_opt
+{
+    size_t queue;        // Capacity of the ring queueing the data of the binding, 0 to call the sink directly
+    struct manager *mgr; // Manager of the sink, running in another thread, nullptr for the same manager
+
+    bind_opt() : queue(0u), mgr(nullptr) {}
+};
+
+//
+// @struct edge
+//
+// @brief Binding queueing the data in a ring, run by the manager of the sink
+//
+// The edge takes the place of the sink for the block bound: data pushed into
+// the ring stops the flow of the source. The manager of the sink runs the
+// edges with pending data from its loop, each one for a burst of data,
+// so that the blocks downstream process them back to back.
+//
+// Within a manager, the edge grants as many credits as the ring has slots.
+// Between managers, data is dropped while the ring is full.
+//
+// An edge is retired when its port is bound again or its source is deleted
+//
+struct edge : block, mpsc_node
+{
+    struct block *dst_;              // Sink, nullptr once deleted
+    struct manager *dst_mgr_;        // Manager of the sink, running the edge
+    struct spsc_ring ring_;          // Data waiting for the sink
+    std::atomic<bool> is_scheduled_; // Edge is waiting to be run by the manager of the sink
+    bool is_retired_;                // No source anymore, deleted once its data is delivered
+
+    unsigned long drop_full_;    // Data dropped by the source: ring full
+    unsigned long drop_unbound_; // Data dropped by the sink: sink deleted
+
+    edge(struct manager *mgr, struct manager *dst_mgr, struct block *dst, size_t size);
+    virtual ~edge() override final;
+
+    void run();
+
+    virtual bool data_(void *vdata) override final;
+};
+
+//
+// @struct manager_block
+//
+// @brief Block owned by the manager to register its own file descriptors
+//
+struct manager_block : block
+{
+    explicit manager_block(struct manager *mgr);
+    virtual ~manager_block() override final;
+
+    virtual void on_fd_(struct file_desc &fd) override final;
+};
+
 //
 // @struct manager
 //
@@ -33,6 +114,8 @@ struct manager
 
     bool is_term_;
 
+    struct manager_block bk_mgr_; // Block receiving the manager's own events
+
     void start_();
     void stop_();
 
@@ -41,12 +124,21 @@ struct manager
     //
     std::unordered_map<std::string, struct block_factory *> bk_factory_;
     std::unordered_map<int, struct block *> bk_map_;
+    std::vector<struct block *> bk_retired_;                           // Replaced or deleted blocks, deleted once their work is completed
+    std::unordered_map<int, std::vector<std::pair<int, int>>> bk_up_; // Blocks of this manager bound to each block, with their port
 
     bool block_add(int id, const char *type);
     bool block_start(int id);
     bool block_stop(int id);
     bool block_del(int id);
     bool block_bind(int id, int port, int bk_id);
+    bool block_bind(int id, int port, int bk_id, const struct bind_opt &opt);
+    bool block_replace(int id, const char *type);
+    void block_replace_upstream(struct block *up, int port, struct block *old_bk, struct block *bk);
+    bool block_release(struct block *bk);
+    void block_work_done(struct block *bk);
+    void block_up_add(int id, int port, int bk_id);
+    void block_up_del(int id, int port, int bk_id);
 
     struct block *block_get(int id);
     void block_clear();
@@ -71,10 +163,95 @@ struct manager
     std::vector<struct file_desc> callback_; // Callbacks for read and write events
     std::vector<zmq_pollitem_t> fd_;         // File descriptors or socket registered
 
+    // Busy polling: spin on non-blocking polls until idle for a while
+    long spin_ns_;              // Idle period before blocking, 0 to always block
+    struct timespec spin_last_; // Date of the last event while spinning
+    unsigned long spin_count_;  // Number of non-blocking polls
+    unsigned long spin_hit_;    // Number of non-blocking polls with events
+    unsigned long sleep_count_; // Number of blocking polls
+    unsigned long sleep_hit_;   // Number of blocking polls with events
+
     int fd_find(int fd, void *socket) const;
     bool fd_add(const struct file_desc &fd);
     void fd_remove(const struct file_desc &fd);
+    void fd_spin(long idle_us);
     int fd_poll();
+
+    //
+    // Signals management
+    //
+    std::unordered_map<int, struct block *> sg_map_; // Blocks to notify per signal
+    sigset_t sg_mask_;                               // Signals redirected to the file descriptor
+    int sg_fd_;                                      // Signal file descriptor
+
+    bool signal_add(int signo, struct block *bk);
+    void signal_del(int signo);
+    void signal_read();
+    void signal_clear();
+
+    //
+    // Work offload to a pool of worker threads
+    //
+    std::vector<std::thread> wk_thread_;    // Worker threads
+    std::mutex wk_mutex_;                   // Protects the submission queue
+    std::condition_variable wk_cond_;       // Wakes up workers
+    std::deque<struct work *> wk_queue_;    // Work submitted, not yet processed
+    bool wk_stop_;                          // Workers should exit once the queue is empty
+    struct mpsc_queue wk_done_;             // Work processed, not yet completed
+    int wk_fd_;                             // Event file descriptor to wake up the loop
+    struct timespec wk_start_;              // Start date of the workers
+    unsigned long wk_submit_;               // Number of submitted work
+    unsigned long wk_complete_;             // Number of completed work
+    unsigned long wk_depth_max_;            // Maximum number of work in flight
+    std::atomic<unsigned long> wk_busy_ns_; // Time spent by workers processing
+    unsigned long wk_latency_ns_;           // Sum of the submission to completion latencies
+    unsigned long wk_latency_max_ns_;       // Maximum submission to completion latency
+
+    bool work_start(size_t count);
+    void work_stop();
+    bool work_submit(struct block *bk, struct buffer &buf, void *arg);
+    void work_run();
+    void work_complete();
+    unsigned long work_utilization() const;
+
+    //
+    // Flow control between blocks
+    //
+    void flow_update(struct block *sink);
+    void flow_pause(struct block *sink);
+    void flow_resume(struct block *sink);
+    void flow_upstream(const struct block *sink, std::vector<int> &ids);
+
+    //
+    // Queued bindings, run by the manager of their sink
+    //
+    std::vector<struct edge *> qu_edge_; // Edges to the blocks of this manager
+    struct mpsc_queue qu_ready_;         // Edges with pending data, not yet run
+    int qu_fd_;                          // Event file descriptor to wake up the loop
+    unsigned long qu_run_;               // Number of edges run
+    unsigned long qu_count_;             // Number of data delivered by the edges
+
+    bool queue_start();
+    void queue_stop();
+    void queue_schedule(struct edge *eg);
+    void queue_read();
+    void queue_retire(struct edge *eg);
+    void queue_release(struct edge *eg);
+    void queue_clear();
+
+    //
+    // Mailbox for other threads to post data and notifications
+    //
+    struct mpsc_queue mb_queue_; // Mails posted, not yet delivered
+    int mb_fd_;                  // Event file descriptor to wake up the loop
+    unsigned long mb_count_;     // Number of delivered mails
+    unsigned long mb_wakeup_;    // Number of wake ups to deliver mails
+
+    bool mailbox_start();
+    void mailbox_stop();
+    bool post_data(int bk_id, struct buffer &buf);
+    bool post_ctrl(int bk_id, void *notif);
+    void mailbox_read();
 };
 
 #endif // MANAGER_HPP
@@ -0,0 +1,122 @@
+#ifndef MPSC_HPP
+#define MPSC_HPP
+
+// C++ headers
+#include <atomic>
+
+//
+// @struct mpsc_node
+//
+// @brief Node to embed in an element of a MPSC queue
+//
+struct mpsc_node
+{
+    std::atomic<struct mpsc_node *> next_;
+};
+
+//
+// @struct mpsc_queue
+//
+// @brief Intrusive lock-free queue with multiple producers and a single consumer
+//
+// Producers never wait: a push is an atomic exchange followed by a store.
+// The consumer can see an empty queue while a push is in progress, the count
+// of pending nodes tells it that it should come back later
+//
+struct mpsc_queue
+{
+    std::atomic<struct mpsc_node *> head_; // Last pushed node, shared by producers
+    struct mpsc_node *tail_;               // Next node to pop, owned by the consumer
+    struct mpsc_node stub_;                // Sentinel to never have an empty list
+    std::atomic<unsigned long> pending_;   // Count of pushed nodes not yet popped
+
+    mpsc_queue() : head_(&stub_), tail_(&stub_), pending_(0u)
+    {
+        stub_.next_.store(nullptr, std::memory_order_relaxed);
+    }
+
+    //
+    // @brief Link a node at the end of the list
+    //
+    void link(struct mpsc_node *node)
+    {
+        struct mpsc_node *prev;
+
+        node->next_.store(nullptr, std::memory_order_relaxed);
+        prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next_.store(node, std::memory_order_release);
+    }
+
+    //
+    // @brief Push a node, can be called from any thread
+    //
+    // @return true if the queue was empty and the consumer should be woken up
+    //
+    bool push(struct mpsc_node *node)
+    {
+        link(node);
+        return (pending_.fetch_add(1u, std::memory_order_acq_rel) == 0u);
+    }
+
+    //
+    // @brief Pop a node, must be called from the consumer thread only
+    //
+    // @return The oldest node, nullptr if none is available yet
+    //
+    struct mpsc_node *pop()
+    {
+        struct mpsc_node *tail;
+        struct mpsc_node *next;
+
+        tail = tail_;
+        next = tail->next_.load(std::memory_order_acquire);
+
+        // Skip the sentinel
+        if (tail == &stub_)
+        {
+            if (next == nullptr)
+            {
+                return nullptr;
+            }
+            tail_ = next;
+            tail = next;
+            next = next->next_.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr)
+        {
+            tail_ = next;
+            return tail;
+        }
+
+        // A producer is in the middle of a push
+        if (tail != head_.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        // Last node: put back the sentinel behind it to release it
+        link(&stub_);
+
+        next = tail->next_.load(std::memory_order_acquire);
+        if (next != nullptr)
+        {
+            tail_ = next;
+            return tail;
+        }
+
+        return nullptr;
+    }
+
+    //
+    // @brief Acknowledge popped nodes
+    //
+    // @return true if nodes are still pending
+    //
+    bool done(unsigned long count)
+    {
+        return (pending_.fetch_sub(count, std::memory_order_acq_rel) != count);
+    }
+};
+
+#endif // MPSC_HPP
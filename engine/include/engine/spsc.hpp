@@ -0,0 +1,113 @@
+#ifndef SPSC_HPP
+#define SPSC_HPP
+
+// Project headers
+#include "utils/buffer.hpp"
+
+// C++ headers
+#include <atomic>
+#include <vector>
+
+#define SPSC_CACHE_LINE 64u // Indexes are kept on their own cache line
+
+//
+// @struct spsc_ring
+//
+// @brief Bounded ring of buffers with a single producer and a single consumer
+//
+// Buffers are moved in and out of the slots: a push or a pop is a swap
+// followed by a store of an index, without allocation. Each index is written
+// by one side only and lives on its own cache line
+//
+struct spsc_ring
+{
+    std::vector<struct buffer> slot_; // Slots, a power of 2
+    size_t mask_;                     // Size of the ring minus 1
+
+    char pad_head_[SPSC_CACHE_LINE];
+    std::atomic<size_t> head_; // Next slot to pop, written by the consumer
+    char pad_tail_[SPSC_CACHE_LINE - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail_; // Next slot to push, written by the producer
+    char pad_end_[SPSC_CACHE_LINE - sizeof(std::atomic<size_t>)];
+
+    //
+    // @param size : Capacity of the ring, rounded up to a power of 2
+    //
+    explicit spsc_ring(size_t size) : mask_(0u), head_(0u), tail_(0u)
+    {
+        size_t capacity;
+
+        for (capacity = 1u; capacity < size; capacity <<= 1u)
+        {
+        }
+        slot_.resize(capacity);
+        mask_ = capacity - 1u;
+    }
+
+    ~spsc_ring()
+    {
+        for (auto &buf : slot_)
+        {
+            buf.clear();
+        }
+    }
+
+    size_t capacity() const
+    {
+        return mask_ + 1u;
+    }
+
+    //
+    // @brief Number of buffers in the ring, exact from either side only
+    //
+    size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    //
+    // @brief Move a buffer into the ring, must be called from the producer thread only
+    //
+    // @return false if the ring is full, the buffer is left untouched
+    //
+    bool push(struct buffer &buf)
+    {
+        size_t tail;
+
+        tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_)
+        {
+            return false;
+        }
+
+        slot_[tail & mask_].swap(buf);
+        tail_.store(tail + 1u, std::memory_order_release);
+
+        return true;
+    }
+
+    //
+    // @brief Move the oldest buffer out of the ring, must be called from the consumer thread only
+    //
+    // @param buf : Empty buffer receiving the data
+    //
+    // @return false if the ring is empty
+    //
+    bool pop(struct buffer &buf)
+    {
+        size_t head;
+
+        head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        buf.swap(slot_[head & mask_]);
+        head_.store(head + 1u, std::memory_order_release);
+
+        return true;
+    }
+};
+
+#endif // SPSC_HPP
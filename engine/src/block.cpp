@@ -7,17 +7,104 @@
 //
 // @brief Block constructor and destructor
 //
-block::block(struct manager *mgr) : id_(0), is_started_(false), sink_(nullptr), mgr_(mgr) {}
+block::block(struct manager *mgr) : id_(0),
+                                    is_started_(false),
+                                    sink_(nullptr),
+                                    data_rx_(0u),
+                                    data_tx_(0u),
+                                    ctrl_rx_(0u),
+                                    data_expired_(0u),
+                                    wk_pending_(0u),
+                                    credit_max_(0),
+                                    credit_(0),
+                                    credit_empty_(false),
+                                    credit_out_(0u),
+                                    flow_hold_(0u),
+                                    flow_paused_(0u),
+                                    mgr_(mgr)
+{
+}
 block::~block() {}
 
 // Block interface default implementation
 void block::bind_(int, struct block *) {}
 void block::start_() {}
 void block::stop_() {}
+void block::transfer_(struct block *) {}
 bool block::data_(void *) { return false; }
 void block::ctrl_(void *) {}
 void block::on_timer_(struct timer &) {}
 void block::on_fd_(struct file_desc &) {}
+void block::on_signal_(int) {}
+void block::on_flow_(bool) {}
+bool block::work_(struct work &) { return false; }
+
+//
+// @brief Resume the data flow once the work is done
+//
+void block::on_work_(struct work &wk)
+{
+    if (wk.forward == true)
+    {
+        process_data_(&wk.buf);
+    }
+}
+
+//
+// @brief Set the data the block can hold, 0 to disable flow control
+//
+// Data already held keeps its credits
+//
+void block::credit_set_(long count)
+{
+    // Verify user input
+    if (count < 0)
+    {
+        LOGGER_ERR("Failed to set credits: negative count [bk_id=%d ; count=%ld]", id_, count);
+        return;
+    }
+
+    credit_ += count - credit_max_;
+    credit_max_ = count;
+    mgr_->flow_update(this);
+}
+
+//
+// @brief Take a credit to hold data
+//
+// @return false if the block is out of credits, true without flow control
+//
+bool block::credit_take_()
+{
+    if (credit_max_ == 0)
+    {
+        return true;
+    }
+    if (credit_ <= 0)
+    {
+        return false;
+    }
+
+    --credit_;
+    if (credit_ == 0)
+    {
+        mgr_->flow_update(this);
+    }
+
+    return true;
+}
+
+//
+// @brief Give back the credits of the data released
+//
+void block::credit_give_(long count)
+{
+    credit_ += count;
+    if (credit_empty_ == true)
+    {
+        mgr_->flow_update(this);
+    }
+}
 
 //
 // @brief Send a notification to a block
@@ -32,6 +119,7 @@ void block::process_ctrl_(int bk_id, void *notif)
         LOGGER_ERR("Failed to notify block: unknown block [bk_id=%d]", bk_id);
         return;
     }
+    ++bk->ctrl_rx_;
     bk->ctrl_(notif);
 }
 
@@ -40,30 +128,58 @@ void block::process_ctrl_(int bk_id, void *notif)
 //
 void block::process_data_(void *data)
 {
+    process_data_(sink_, data);
+}
+
+//
+// @brief Start a data flow from this block to a given sink, for blocks with several outputs
+//
+void block::process_data_(struct block *sink, void *data)
+{
+    const struct buffer *buf;
     struct block *current;
 
     LOGGER_DEBUG("Started data flow [bk_id_src=%d]", id_);
 
+    // Messages without deadline do not read the clock
+    buf = static_cast<const struct buffer *>(data);
+    if ((buf != nullptr) && (buf->deadline_ns_ == 0u))
+    {
+        buf = nullptr;
+    }
+
     // Process the data from one block to the other
-    current = this;
+    ++data_tx_;
+    current = sink;
     while (true)
     {
-        // Get the sink in which to send data
-        current = current->sink_;
         if (current == nullptr)
         {
             LOGGER_ERR("Failed to forward data flow: no block bound");
             return;
         }
 
+        // Nobody waits for the data anymore
+        if ((buf != nullptr) && (buf->is_expired(buffer_now_ns()) == true))
+        {
+            LOGGER_DEBUG("Drop data: deadline expired [bk_id_src=%d ; bk_id_sink=%d]", id_, current->id_);
+            ++current->data_expired_;
+            break;
+        }
+
         LOGGER_DEBUG("Forwarding data [bk_id=%d]", current->id_);
 
         // The destination block is the new source of the data flow
+        ++current->data_rx_;
         bool forward = current->data_(data);
         if (forward == false)
         {
             LOGGER_DEBUG("Stopped data flow [bk_id_src=%d ; bk_id_sink=%d]", id_, current->id_);
             break;
         }
+        ++current->data_tx_;
+
+        // Get the sink in which to send data
+        current = current->sink_;
     }
 }
@@ -3,11 +3,44 @@
 // Project headers
 #include "engine/manager.hpp"
 
-manager::manager() : is_term_(true) {}
+manager::manager() : is_term_(true),
+                     bk_mgr_(this),
+                     spin_ns_(0),
+                     spin_count_(0u),
+                     spin_hit_(0u),
+                     sleep_count_(0u),
+                     sleep_hit_(0u),
+                     sg_fd_(-1),
+                     wk_stop_(false),
+                     wk_fd_(-1),
+                     wk_submit_(0u),
+                     wk_complete_(0u),
+                     wk_depth_max_(0u),
+                     wk_busy_ns_(0u),
+                     wk_latency_ns_(0u),
+                     wk_latency_max_ns_(0u),
+                     qu_fd_(-1),
+                     qu_run_(0u),
+                     qu_count_(0u),
+                     mb_fd_(-1),
+                     mb_count_(0u),
+                     mb_wakeup_(0u)
+{
+    spin_last_.tv_sec = 0;
+    spin_last_.tv_nsec = 0;
+    sigemptyset(&sg_mask_);
+    wk_start_.tv_sec = 0;
+    wk_start_.tv_nsec = 0;
+}
 manager::~manager()
 {
+    mailbox_stop();
+    work_stop();
+    signal_clear();
     timer_clear();
+    queue_stop();
     block_clear();
+    queue_clear();
     block_factory_clear();
 }
 
@@ -22,3 +55,29 @@ void manager::stop_()
     is_term_ = true;
     LOGGER_INFO("Stopped manager");
 }
+
+//
+// @brief Block to receive events on the manager's own file descriptors
+//
+manager_block::manager_block(struct manager *mgr) : block(mgr) {}
+manager_block::~manager_block() {}
+
+void manager_block::on_fd_(struct file_desc &fd)
+{
+    if (fd.fd == mgr_->sg_fd_)
+    {
+        mgr_->signal_read();
+    }
+    else if (fd.fd == mgr_->wk_fd_)
+    {
+        mgr_->work_complete();
+    }
+    else if (fd.fd == mgr_->mb_fd_)
+    {
+        mgr_->mailbox_read();
+    }
+    else if (fd.fd == mgr_->qu_fd_)
+    {
+        mgr_->queue_read();
+    }
+}
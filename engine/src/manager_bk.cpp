@@ -3,8 +3,11 @@
 // Project headers
 #include "engine/manager.hpp"
 
+// C++ headers
+#include <algorithm>
+
 //
-// @brief Add or replace a block
+// @brief Add a block
 //
 // @param id    : Identifier to give to the block
 // @param type  : Type of block to create
@@ -126,6 +129,51 @@ bool manager::block_del(int id)
         return false;
     }
 
+    LOGGER_INFO("Deleting block [bk_id=%d ; bk_type=%s ; work_pending=%lu]", bk->id_, bk->type_.c_str(), bk->wk_pending_);
+
+    // Blocks paused by this one would never resume
+    if (bk->credit_empty_ == true)
+    {
+        flow_resume(bk);
+    }
+
+    // Blocks bound to it are no longer upstream of a block with its identifier
+    for (const auto &it : bk->binds_)
+    {
+        block_up_del(bk->id_, it.first, it.second);
+    }
+    bk_up_.erase(id);
+
+    // Data still queued for the block is dropped
+    for (struct edge *eg : qu_edge_)
+    {
+        if (eg->dst_ == bk)
+        {
+            eg->dst_ = nullptr;
+        }
+    }
+
+    // Work in flight completes on the block, it is deleted afterwards
+    if (bk->wk_pending_ != 0u)
+    {
+        bk_retired_.push_back(bk);
+    }
+    else if (block_release(bk) == false)
+    {
+        return false;
+    }
+    bk_map_.erase(id);
+
+    return true;
+}
+
+//
+// @brief Destroy a block with the factory of its type
+//
+// Its edges deliver their data queued, then they are deleted
+//
+bool manager::block_release(struct block *bk)
+{
     const auto &factory = bk_factory_.find(bk->type_);
     if (factory == bk_factory_.cend())
     {
@@ -133,33 +181,275 @@ bool manager::block_del(int id)
         return false;
     }
 
-    LOGGER_INFO("Deleting block [bk_id=%d ; bk_type=%s]", bk->id_, bk->type_.c_str());
+    for (const auto &it : bk->edge_)
+    {
+        it.second->dst_mgr_->queue_retire(it.second);
+    }
+    bk->edge_.clear();
 
     factory->second->destructor(bk);
-    bk_map_.erase(id);
 
     return true;
 }
 
+//
+// @brief Replace a block by a new instance, possibly of another type
+//
+// @param id    : Identifier of the block to replace
+// @param type  : Type of the new block
+//
+// The replacement is done at once from the main loop, no data can reach the
+// block in between:
+//   - the new block gets the bindings, the statistics and the state of the old one
+//   - the new block takes over the configuration and the data held by the old one, if it knows its type
+//   - blocks bound to the old block are bound to the new one
+//   - signals go to the new block, timers and file descriptors left by the old one are removed
+//   - the new block stays paused by the sinks out of credits, blocks paused by the old one resume
+//   - data queued for the old block goes to the new one
+//   - work in flight completes on the old block, it is deleted afterwards
+//
+bool manager::block_replace(int id, const char *type)
+{
+    struct block *old_bk;
+    struct block *bk;
+    bool is_started;
+
+    old_bk = block_get(id);
+    if (old_bk == nullptr)
+    {
+        LOGGER_ERR("Failed to replace block: unknown block [bk_id=%d]", id);
+        return false;
+    }
+
+    const auto &factory = bk_factory_.find(type);
+    if (factory == bk_factory_.cend())
+    {
+        LOGGER_ERR("Failed to replace block: no factory found [bk_id=%d ; type=%s]", id, type);
+        return false;
+    }
+
+    bk = factory->second->constructor(this);
+    if (bk == nullptr)
+    {
+        LOGGER_ERR("Failed to replace block: construction failed [bk_id=%d ; type=%s]", id, type);
+        return false;
+    }
+
+    bk->id_ = id;
+    bk->type_ = type;
+    bk->is_started_ = false;
+    bk->data_rx_ = old_bk->data_rx_;
+    bk->data_tx_ = old_bk->data_tx_;
+    bk->ctrl_rx_ = old_bk->ctrl_rx_;
+    bk->data_expired_ = old_bk->data_expired_;
+    bk->credit_out_ = old_bk->credit_out_;
+    bk->flow_hold_ = old_bk->flow_hold_;
+    bk->flow_paused_ = old_bk->flow_paused_;
+
+    // Downstream bindings, ports bound with a queue keep their edge
+    bk->edge_.swap(old_bk->edge_);
+    for (const auto &it : old_bk->binds_)
+    {
+        struct block *dest;
+
+        const auto &eg = bk->edge_.find(it.first);
+        if (eg != bk->edge_.cend())
+        {
+            dest = eg->second;
+        }
+        else
+        {
+            dest = (it.second == id) ? bk : block_get(it.second);
+        }
+        if (dest != nullptr)
+        {
+            bk->bind_(it.first, dest);
+        }
+    }
+    bk->binds_ = old_bk->binds_;
+    bk->sink_ = (old_bk->sink_ == old_bk) ? bk : old_bk->sink_;
+
+    // The new block takes the data held before the old one drops it on stop
+    bk->transfer_(old_bk);
+
+    // The old block releases its resources before the new one takes them
+    is_started = old_bk->is_started_;
+    if (is_started == true)
+    {
+        old_bk->is_started_ = false;
+        old_bk->stop_();
+    }
+    tm_list_.remove_if([old_bk](const struct timer &tm) { return tm.bk == old_bk; });
+    for (size_t i = callback_.size(); i > 0u; --i)
+    {
+        if (callback_[i - 1u].bk == old_bk)
+        {
+            callback_.erase(callback_.begin() + static_cast<long>(i - 1u));
+            fd_.erase(fd_.begin() + static_cast<long>(i - 1u));
+        }
+    }
+    for (auto &it : sg_map_)
+    {
+        if (it.second == old_bk)
+        {
+            it.second = bk;
+        }
+    }
+
+    // Upstream bindings, of the blocks and of the replaced ones still working
+    bk_map_[id] = bk;
+    const auto &up_list = bk_up_.find(id);
+    if (up_list != bk_up_.cend())
+    {
+        for (const auto &bind : up_list->second)
+        {
+            block_replace_upstream(block_get(bind.first), bind.second, old_bk, bk);
+        }
+    }
+    for (struct block *retired : bk_retired_)
+    {
+        for (const auto &bind : retired->binds_)
+        {
+            if (bind.second == id)
+            {
+                block_replace_upstream(retired, bind.first, old_bk, bk);
+            }
+        }
+    }
+    for (struct edge *eg : qu_edge_)
+    {
+        if (eg->dst_ == old_bk)
+        {
+            eg->dst_ = bk;
+        }
+    }
+
+    // The new block grants its own credits, the data it took over keeps them
+    if (old_bk->credit_empty_ == true)
+    {
+        flow_resume(old_bk);
+    }
+    flow_update(bk);
+
+    // The new block takes over the traffic
+    if (is_started == true)
+    {
+        bk->is_started_ = true;
+        bk->start_();
+    }
+
+    LOGGER_INFO("Replaced block [bk_id=%d ; bk_type=%s ; old_bk_type=%s ; work_pending=%lu]",
+                id, type, old_bk->type_.c_str(), old_bk->wk_pending_);
+
+    if (old_bk->wk_pending_ == 0u)
+    {
+        block_release(old_bk);
+    }
+    else
+    {
+        bk_retired_.push_back(old_bk);
+    }
+
+    return true;
+}
+
+//
+// @brief Bind the port of a block bound to a replaced block to the new one
+//
+// Ports bound with a queue keep their edge, it delivers to the new block
+//
+void manager::block_replace_upstream(struct block *up, int port, struct block *old_bk, struct block *bk)
+{
+    if (up->sink_ == old_bk)
+    {
+        up->sink_ = bk;
+    }
+    if (up->edge_.count(port) == 0u)
+    {
+        up->bind_(port, bk);
+    }
+}
+
 //
 // @brief Bind a block
 //
 bool manager::block_bind(int bk_id_src, int port, int bk_id_dst)
 {
+    struct bind_opt opt;
+
+    return block_bind(bk_id_src, port, bk_id_dst, opt);
+}
+
+//
+// @brief Bind a block, with a queue or to a block of another manager
+//
+// @param opt   : Options of the binding
+//
+// The source is given an edge in place of the sink when bound with a queue.
+// Blocks of another manager are bound with a queue only, before the thread
+// of the other manager starts its loop
+//
+bool manager::block_bind(int bk_id_src, int port, int bk_id_dst, const struct bind_opt &opt)
+{
+    struct manager *dst_mgr;
+    struct block *sink;
+
     // Find the block concerned by the command
+    dst_mgr = (opt.mgr != nullptr) ? opt.mgr : this;
     const auto &src = bk_map_.find(bk_id_src);
-    const auto &dst = bk_map_.find(bk_id_dst);
-    const auto &end = bk_map_.cend();
-    if ((src == end) || (dst == end))
+    const auto &dst = dst_mgr->bk_map_.find(bk_id_dst);
+    if ((src == bk_map_.cend()) || (dst == dst_mgr->bk_map_.cend()))
     {
         LOGGER_ERR("Failed to bind block: unknown block [bk_id_src=%d ; bk_id_dst=%d]", bk_id_src, bk_id_dst);
         return false;
     }
+    if ((dst_mgr != this) && (opt.queue == 0u))
+    {
+        LOGGER_ERR("Failed to bind block: blocks of another manager need a queue [bk_id_src=%d ; bk_id_dst=%d]", bk_id_src, bk_id_dst);
+        return false;
+    }
+
+    // The edge previously bound on the port delivers its data queued, then it is deleted
+    const auto &old_bind = src->second->binds_.find(port);
+    if (old_bind != src->second->binds_.cend())
+    {
+        block_up_del(bk_id_src, port, old_bind->second);
+    }
+    const auto &old_eg = src->second->edge_.find(port);
+    if (old_eg != src->second->edge_.cend())
+    {
+        struct edge *eg = old_eg->second;
+
+        src->second->edge_.erase(old_eg);
+        eg->dst_mgr_->queue_retire(eg);
+    }
+
+    sink = dst->second;
+    if (opt.queue != 0u)
+    {
+        struct edge *eg;
+
+        if ((dst_mgr->qu_fd_ == -1) && ((dst_mgr != this) || (queue_start() == false)))
+        {
+            LOGGER_ERR("Failed to bind block: queues not started [bk_id_src=%d ; bk_id_dst=%d]", bk_id_src, bk_id_dst);
+            return false;
+        }
+
+        eg = new struct edge(this, dst_mgr, dst->second, opt.queue);
+        dst_mgr->qu_edge_.push_back(eg);
+        src->second->edge_[port] = eg;
+        sink = eg;
+    }
 
     // Save this block as the new sink
-    src->second->sink_ = dst->second;
+    src->second->sink_ = sink;
+    src->second->binds_[port] = bk_id_dst;
+    if (dst_mgr == this)
+    {
+        block_up_add(bk_id_src, port, bk_id_dst);
+    }
 
-    LOGGER_INFO("Bound block [bk_id_src=%d ; port=%d ; bk_id_dest=%d]", bk_id_src, port, bk_id_dst);
+    LOGGER_INFO("Bound block [bk_id_src=%d ; port=%d ; bk_id_dest=%d ; queue=%zu]", bk_id_src, port, bk_id_dst, opt.queue);
 
     //
     // Notify the block that it has been bound. It could
@@ -167,7 +457,7 @@ bool manager::block_bind(int bk_id_src, int port, int bk_id_dst)
     // to make packets flow as in a graph. This routing job is
     // not done by the framework itself
     //
-    src->second->bind_(port, dst->second);
+    src->second->bind_(port, sink);
 
     return true;
 }
@@ -185,6 +475,56 @@ struct block *manager::block_get(int id)
     return it->second;
 }
 
+//
+// @brief Index a binding within this manager, for the flow control to find the blocks upstream
+//
+void manager::block_up_add(int id, int port, int bk_id)
+{
+    bk_up_[bk_id].push_back(std::make_pair(id, port));
+}
+
+//
+// @brief Remove a binding from the index, if it is there
+//
+void manager::block_up_del(int id, int port, int bk_id)
+{
+    const auto &it = bk_up_.find(bk_id);
+    if (it == bk_up_.end())
+    {
+        return;
+    }
+
+    std::vector<std::pair<int, int>> &up = it->second;
+    up.erase(std::remove(up.begin(), up.end(), std::make_pair(id, port)), up.end());
+    if (up.empty() == true)
+    {
+        bk_up_.erase(it);
+    }
+}
+
+//
+// @brief Account for a completed or dropped work, delete the replaced or deleted block once idle
+//
+void manager::block_work_done(struct block *bk)
+{
+    --bk->wk_pending_;
+    if (bk->wk_pending_ != 0u)
+    {
+        return;
+    }
+
+    for (auto it = bk_retired_.begin(); it != bk_retired_.end(); ++it)
+    {
+        if (*it == bk)
+        {
+            LOGGER_INFO("Deleting retired block [bk_id=%d ; bk_type=%s]", bk->id_, bk->type_.c_str());
+            bk_retired_.erase(it);
+            block_release(bk);
+            return;
+        }
+    }
+}
+
 //
 // @brief Clear all blocks
 //
@@ -196,6 +536,13 @@ void manager::block_clear()
         block_stop(it->first);
         block_del(it->first);
     }
+
+    // Work of the replaced blocks will never complete
+    for (struct block *bk : bk_retired_)
+    {
+        block_release(bk);
+    }
+    bk_retired_.clear();
 }
 
 //
@@ -0,0 +1,136 @@
+//
+// @brief Flow control between blocks
+//          - a block holding data (queue, congested peer...) grants credits,
+//            one per data it can still hold
+//          - once out of credits, the blocks upstream of it are paused:
+//            sources stop producing, for example by no longer reading
+//          - they resume once half of the credits are given back
+//
+// The credits of a sink are shared by the blocks sending to it. Blocks bound
+// while a sink is out of credits are paused the next time it runs out
+//
+
+// Project headers
+#include "engine/manager.hpp"
+
+// C++ headers
+#include <algorithm>
+
+//
+// @brief Pause or resume the blocks upstream of a sink, after its credits changed
+//
+void manager::flow_update(struct block *sink)
+{
+    if ((sink->credit_empty_ == false) && (sink->credit_max_ > 0) && (sink->credit_ <= 0))
+    {
+        flow_pause(sink);
+    }
+    else if ((sink->credit_empty_ == true) &&
+             ((sink->credit_max_ == 0) || (sink->credit_ >= (sink->credit_max_ + 1) / 2)))
+    {
+        flow_resume(sink);
+    }
+}
+
+//
+// @brief Pause the blocks upstream of a sink out of credits
+//
+void manager::flow_pause(struct block *sink)
+{
+    sink->credit_empty_ = true;
+    ++sink->credit_out_;
+    flow_upstream(sink, sink->credit_paused_);
+
+    LOGGER_DEBUG("Sink out of credits, pausing upstream [bk_id=%d ; paused_count=%zu]", sink->id_, sink->credit_paused_.size());
+
+    for (int id : sink->credit_paused_)
+    {
+        struct block *bk = block_get(id);
+
+        ++bk->flow_hold_;
+        if (bk->flow_hold_ == 1u)
+        {
+            ++bk->flow_paused_;
+            bk->on_flow_(true);
+        }
+    }
+}
+
+//
+// @brief Resume the blocks paused by a sink
+//
+// Blocks deleted in the meantime are skipped, replaced ones are resumed
+//
+void manager::flow_resume(struct block *sink)
+{
+    std::vector<int> ids;
+
+    sink->credit_empty_ = false;
+    ids.swap(sink->credit_paused_);
+
+    LOGGER_DEBUG("Sink has credits again, resuming upstream [bk_id=%d ; paused_count=%zu]", sink->id_, ids.size());
+
+    for (int id : ids)
+    {
+        struct block *bk = block_get(id);
+        if ((bk == nullptr) || (bk->flow_hold_ == 0u))
+        {
+            continue;
+        }
+
+        --bk->flow_hold_;
+        if (bk->flow_hold_ == 0u)
+        {
+            bk->on_flow_(false);
+        }
+    }
+}
+
+//
+// @brief List the blocks sending data to a sink, directly or through other blocks
+//
+// @param sink  : Block to start from
+// @param ids   : Identifiers of the blocks found, the sink is listed if it is on a loop
+//
+// Blocks are found from the index of the bindings within this manager. A block
+// bound with a queue sends to the sink through its edge
+//
+void manager::flow_upstream(const struct block *sink, std::vector<int> &ids)
+{
+    std::vector<const struct block *> todo;
+
+    todo.push_back(sink);
+    while (todo.empty() == false)
+    {
+        const struct block *down = todo.back();
+        bool is_block;
+
+        todo.pop_back();
+        const auto &up_list = bk_up_.find(down->id_);
+        if (up_list == bk_up_.cend())
+        {
+            continue;
+        }
+
+        // Edges share the identifier of their sink
+        is_block = (block_get(down->id_) == down);
+
+        for (const auto &bind : up_list->second)
+        {
+            const struct block *up = block_get(bind.first);
+
+            // Only the block bound with it is upstream of an edge
+            const auto &eg = up->edge_.find(bind.second);
+            if ((is_block == false) && ((eg == up->edge_.cend()) || (eg->second != down)))
+            {
+                continue;
+            }
+
+            if (std::find(ids.cbegin(), ids.cend(), up->id_) == ids.cend())
+            {
+                ids.push_back(up->id_);
+                todo.push_back(up);
+            }
+        }
+    }
+}
@@ -12,6 +12,20 @@
 // Project headers
 #include "engine/manager.hpp"
 
+//
+// @brief Hint the CPU that it is in a spin loop
+//
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
 //
 // @brief Find index of an entry
 //
@@ -114,6 +128,21 @@ void manager::fd_remove(const struct file_desc &fd)
     fd_.erase(fd_.begin() + index);
 }
 
+//
+// @brief Configure busy polling
+//
+// @param idle_us : Idle period before falling back to a blocking poll, 0 to disable
+//
+// Once an event occurs, non-blocking polls are done again for this period
+//
+void manager::fd_spin(long idle_us)
+{
+    spin_ns_ = (idle_us > 0) ? idle_us * 1000 : 0;
+    clock_gettime(CLOCK_MONOTONIC, &spin_last_);
+
+    LOGGER_INFO("Configured busy polling [idle_us=%ld]", idle_us);
+}
+
 //
 // @brief Verify if a file descriptor is ready for reading
 //
@@ -123,10 +152,32 @@ int manager::fd_poll()
 {
     int ret;
     long timeout;
+    struct timespec now;
 
-    // Poll sockets for 10ms
+    // Poll sockets for 10ms, or without waiting while spinning
     timeout = 10;
+    if (spin_ns_ != 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (elapsed_ns(spin_last_, now) < spin_ns_)
+        {
+            timeout = 0;
+        }
+    }
+
     ret = zmq_poll(fd_.data(), static_cast<int>(fd_.size()), timeout);
+
+    if (timeout == 0)
+    {
+        ++spin_count_;
+        spin_hit_ += (ret > 0) ? 1u : 0u;
+    }
+    else
+    {
+        ++sleep_count_;
+        sleep_hit_ += (ret > 0) ? 1u : 0u;
+    }
+
     if (ret == -1)
     {
         LOGGER_ERR("Failed to poll socket: %s [errno=%d]", strerror(errno), errno);
@@ -135,6 +186,10 @@ int manager::fd_poll()
     else if (ret == 0)
     {
         // Timeout expired, nothing to do
+        if (timeout == 0)
+        {
+            cpu_relax();
+        }
     }
     else
     {
@@ -142,6 +197,12 @@ int manager::fd_poll()
 
         LOGGER_DEBUG("Sockets are ready for I/O [poll_size=%zu ; ready_count=%d]", fd_.size(), ret);
 
+        // Keep on spinning after an event
+        if (spin_ns_ != 0)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &spin_last_);
+        }
+
         // There are 'ret' file descriptors ready
         auto it_cb = callback_.begin();
         count = 0;
@@ -0,0 +1,229 @@
+//
+// @brief Mailbox to let other threads post to the blocks of a manager
+//          - any thread can post data or a notification to a block
+//          - mails are queued in a lock-free MPSC queue
+//          - the loop is woken up by an event file descriptor
+//            and delivers the mails in batches
+//
+
+// Project headers
+#include "engine/manager.hpp"
+
+// C headers
+extern "C"
+{
+#include <sys/eventfd.h>
+#include <unistd.h>
+}
+
+#define MAILBOX_BATCH 64 // Maximum number of mails delivered per wake up
+
+//
+// @brief Wake up the loop
+//
+static void mailbox_notify(int fd)
+{
+    uint64_t one = 1u;
+
+    if (write(fd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+    {
+        LOGGER_ERR("Failed to wake up the loop: %s [errno=%d]", strerror(errno), errno);
+    }
+}
+
+//
+// @brief Open the mailbox
+//
+// It has to be called from the loop thread, before any other thread posts
+//
+bool manager::mailbox_start()
+{
+    if (mb_fd_ != -1)
+    {
+        LOGGER_ERR("Failed to start mailbox: already started [fd=%d]", mb_fd_);
+        return false;
+    }
+
+    mb_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mb_fd_ == -1)
+    {
+        LOGGER_ERR("Failed to create event file descriptor: %s [errno=%d]", strerror(errno), errno);
+        return false;
+    }
+
+    // Register the file descriptor for reading
+    struct file_desc fd;
+    fd.bk = &bk_mgr_;
+    fd.fd = mb_fd_;
+    fd.socket = nullptr;
+    fd.read = true;
+    fd.write = false;
+    fd_add(fd);
+
+    LOGGER_INFO("Started mailbox");
+
+    return true;
+}
+
+//
+// @brief Close the mailbox, undelivered mails are dropped
+//
+// Other threads must have stopped posting
+//
+void manager::mailbox_stop()
+{
+    struct mpsc_node *node;
+    unsigned long count;
+
+    if (mb_fd_ == -1)
+    {
+        // Nothing to do
+        return;
+    }
+
+    count = 0u;
+    for (node = mb_queue_.pop(); node != nullptr; node = mb_queue_.pop())
+    {
+        struct mail *ml = static_cast<struct mail *>(node);
+
+        ml->buf.clear();
+        delete ml;
+        ++count;
+    }
+    if (count != 0u)
+    {
+        mb_queue_.done(count);
+    }
+
+    struct file_desc fd;
+    fd.fd = mb_fd_;
+    fd.socket = nullptr;
+    fd_remove(fd);
+
+    close(mb_fd_);
+    mb_fd_ = -1;
+
+    LOGGER_INFO("Stopped mailbox [dropped_count=%lu]", count);
+}
+
+//
+// @brief Post data to a block, can be called from any thread
+//
+// @param bk_id : Block to give the data to, as if it was its sink
+// @param buf   : Data to deliver, its parts and deadline are moved into the mail
+//
+bool manager::post_data(int bk_id, struct buffer &buf)
+{
+    struct mail *ml;
+
+    if (mb_fd_ == -1)
+    {
+        LOGGER_ERR("Failed to post data: mailbox not started [bk_id=%d]", bk_id);
+        return false;
+    }
+
+    ml = new struct mail;
+    ml->bk_id = bk_id;
+    ml->is_data = true;
+    ml->buf.swap(buf);
+    ml->notif = nullptr;
+
+    if (mb_queue_.push(ml) == true)
+    {
+        mailbox_notify(mb_fd_);
+    }
+
+    return true;
+}
+
+//
+// @brief Post a notification to a block, can be called from any thread
+//
+// @param bk_id : Block to notify
+// @param notif : Notification, it must be valid until it is delivered
+//
+bool manager::post_ctrl(int bk_id, void *notif)
+{
+    struct mail *ml;
+
+    if (mb_fd_ == -1)
+    {
+        LOGGER_ERR("Failed to post notification: mailbox not started [bk_id=%d]", bk_id);
+        return false;
+    }
+
+    ml = new struct mail;
+    ml->bk_id = bk_id;
+    ml->is_data = false;
+    ml->notif = notif;
+
+    if (mb_queue_.push(ml) == true)
+    {
+        mailbox_notify(mb_fd_);
+    }
+
+    return true;
+}
+
+//
+// @brief Deliver the posted mails
+//
+void manager::mailbox_read()
+{
+    struct mpsc_node *node;
+    uint64_t value;
+    unsigned long count;
+
+    // Acknowledge the wake up
+    if (read(mb_fd_, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+    {
+        LOGGER_DEBUG("No event to read [errno=%d]", errno);
+    }
+    ++mb_wakeup_;
+
+    count = 0u;
+    for (node = mb_queue_.pop(); node != nullptr; node = mb_queue_.pop())
+    {
+        struct mail *ml = static_cast<struct mail *>(node);
+        struct block *bk;
+
+        bk = block_get(ml->bk_id);
+        if (bk == nullptr)
+        {
+            LOGGER_ERR("Failed to deliver mail: unknown block [bk_id=%d]", ml->bk_id);
+        }
+        else if ((ml->is_data == true) && (ml->buf.deadline_ns_ != 0u) && (ml->buf.is_expired(buffer_now_ns()) == true))
+        {
+            LOGGER_DEBUG("Drop mail: deadline expired [bk_id=%d]", ml->bk_id);
+            ++bk->data_expired_;
+        }
+        else if (ml->is_data == true)
+        {
+            ++bk->data_rx_;
+            if (bk->data_(&ml->buf) == true)
+            {
+                bk->process_data_(&ml->buf);
+            }
+        }
+        else
+        {
+            ++bk->ctrl_rx_;
+            bk->ctrl_(ml->notif);
+        }
+
+        ml->buf.clear();
+        delete ml;
+
+        if (++count == MAILBOX_BATCH)
+        {
+            break;
+        }
+    }
+    mb_count_ += count;
+
+    // Come back later for mails still pending or being pushed
+    if (mb_queue_.done(count) == true)
+    {
+        mailbox_notify(mb_fd_);
+    }
+}
@@ -0,0 +1,312 @@
+//
+// @brief Queued bindings to pipeline the data flow
+//          - a binding with a queue is an edge: a ring between two blocks
+//          - the source pushes into the ring, its data flow stops there
+//          - the manager of the sink is woken up by an event file descriptor
+//            and runs the edges with pending data, a burst of data each
+//
+// Within a manager, the blocks downstream of an edge process its data back to
+// back. Between managers running in different threads, the stages of a
+// pipeline run in parallel
+//
+
+// Project headers
+#include "engine/manager.hpp"
+
+// C headers
+extern "C"
+{
+#include <sys/eventfd.h>
+#include <unistd.h>
+}
+
+#define QUEUE_BURST 32u // Maximum number of data delivered per edge run
+#define QUEUE_BATCH 64u // Maximum number of edges run per wake up
+
+//
+// @brief Wake up the loop
+//
+static void queue_notify(int fd)
+{
+    uint64_t one = 1u;
+
+    if (write(fd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+    {
+        LOGGER_ERR("Failed to wake up the loop: %s [errno=%d]", strerror(errno), errno);
+    }
+}
+
+//
+// @brief Edge constructor and destructor
+//
+// @param mgr       : Manager of the source
+// @param dst_mgr   : Manager of the sink
+// @param dst       : Sink
+// @param size      : Capacity of the ring
+//
+edge::edge(struct manager *mgr, struct manager *dst_mgr, struct block *dst, size_t size) : block(mgr),
+                                                                                            dst_(dst),
+                                                                                            dst_mgr_(dst_mgr),
+                                                                                            ring_(size),
+                                                                                            is_scheduled_(false),
+                                                                                            is_retired_(false),
+                                                                                            drop_full_(0u),
+                                                                                            drop_unbound_(0u)
+{
+    id_ = dst->id_;
+    type_ = "edge";
+    is_started_ = true;
+
+    // Credits are given back from the same thread only
+    if (dst_mgr == mgr)
+    {
+        credit_set_(static_cast<long>(ring_.capacity()));
+    }
+}
+edge::~edge() {}
+
+//
+// @brief Queue the data for the sink, called from the thread of the source
+//
+bool edge::data_(void *vdata)
+{
+    if (vdata == nullptr)
+    {
+        LOGGER_ERR("Failed to queue data: nullptr data [bk_id=%d]", id_);
+        return false;
+    }
+    struct buffer &buf = *(static_cast<struct buffer *>(vdata));
+
+    if ((credit_take_() == false) || (ring_.push(buf) == false))
+    {
+        LOGGER_DEBUG("Drop data: queue full [bk_id=%d ; size=%zu]", id_, ring_.capacity());
+        ++drop_full_;
+        return false;
+    }
+
+    if (is_scheduled_.exchange(true, std::memory_order_acq_rel) == false)
+    {
+        dst_mgr_->queue_schedule(this);
+    }
+
+    return false;
+}
+
+//
+// @brief Deliver a burst of data to the sink, called from the thread of the sink
+//
+void edge::run()
+{
+    struct buffer buf;
+    size_t count;
+
+    for (count = 0u; (count < QUEUE_BURST) && (ring_.pop(buf) == true); ++count)
+    {
+        if (dst_ == nullptr)
+        {
+            ++drop_unbound_;
+        }
+        else
+        {
+            process_data_(dst_, &buf);
+        }
+        buf.clear();
+    }
+    dst_mgr_->qu_count_ += count;
+    if (credit_max_ != 0)
+    {
+        credit_give_(static_cast<long>(count));
+    }
+
+    // Data pushed while running is seen here, or schedules the edge again
+    is_scheduled_.store(false, std::memory_order_seq_cst);
+    if ((ring_.size() != 0u) && (is_scheduled_.exchange(true, std::memory_order_acq_rel) == false))
+    {
+        dst_mgr_->queue_schedule(this);
+    }
+}
+
+//
+// @brief Open the queues to receive data from the edges
+//
+// It has to be called from the loop thread, before blocks of other managers
+// are bound to this one with a queue
+//
+bool manager::queue_start()
+{
+    if (qu_fd_ != -1)
+    {
+        LOGGER_ERR("Failed to start queues: already started [fd=%d]", qu_fd_);
+        return false;
+    }
+
+    qu_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (qu_fd_ == -1)
+    {
+        LOGGER_ERR("Failed to create event file descriptor: %s [errno=%d]", strerror(errno), errno);
+        return false;
+    }
+
+    // Register the file descriptor for reading
+    struct file_desc fd;
+    fd.bk = &bk_mgr_;
+    fd.fd = qu_fd_;
+    fd.socket = nullptr;
+    fd.read = true;
+    fd.write = false;
+    fd_add(fd);
+
+    LOGGER_INFO("Started queues");
+
+    return true;
+}
+
+//
+// @brief Close the queues, data still queued stays in the edges
+//
+// Blocks of other managers must have stopped sending
+//
+void manager::queue_stop()
+{
+    struct mpsc_node *node;
+    unsigned long count;
+
+    if (qu_fd_ == -1)
+    {
+        // Nothing to do
+        return;
+    }
+
+    count = 0u;
+    for (node = qu_ready_.pop(); node != nullptr; node = qu_ready_.pop())
+    {
+        static_cast<struct edge *>(node)->is_scheduled_.store(false, std::memory_order_relaxed);
+        ++count;
+    }
+    if (count != 0u)
+    {
+        qu_ready_.done(count);
+    }
+
+    struct file_desc fd;
+    fd.fd = qu_fd_;
+    fd.socket = nullptr;
+    fd_remove(fd);
+
+    close(qu_fd_);
+    qu_fd_ = -1;
+
+    LOGGER_INFO("Stopped queues [unscheduled_count=%lu]", count);
+}
+
+//
+// @brief Schedule an edge with pending data, can be called from any thread
+//
+void manager::queue_schedule(struct edge *eg)
+{
+    if (qu_ready_.push(eg) == true)
+    {
+        queue_notify(qu_fd_);
+    }
+}
+
+//
+// @brief Run the edges with pending data
+//
+void manager::queue_read()
+{
+    struct mpsc_node *node;
+    uint64_t value;
+    unsigned long count;
+
+    // Acknowledge the wake up
+    if (read(qu_fd_, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+    {
+        LOGGER_DEBUG("No event to read [errno=%d]", errno);
+    }
+
+    // Edges with more data go back to the end of the queue
+    count = 0u;
+    for (node = qu_ready_.pop(); node != nullptr; node = qu_ready_.pop())
+    {
+        struct edge *eg = static_cast<struct edge *>(node);
+
+        eg->run();
+        if ((eg->is_retired_ == true) && (eg->is_scheduled_.load() == false))
+        {
+            queue_release(eg);
+        }
+
+        if (++count == QUEUE_BATCH)
+        {
+            break;
+        }
+    }
+    qu_run_ += count;
+
+    // Come back later for edges still pending or being pushed
+    if (qu_ready_.done(count) == true)
+    {
+        queue_notify(qu_fd_);
+    }
+}
+
+//
+// @brief Retire an edge of this manager, once its source is bound elsewhere or deleted
+//
+// The edge is deleted once the data it holds is delivered. It has to be
+// called from the thread of the source, while the loop of this manager does
+// not run if it is another thread
+//
+void manager::queue_retire(struct edge *eg)
+{
+    eg->is_retired_ = true;
+
+    // Queued data schedules the edge until delivered, unless the queues are stopped
+    if (eg->is_scheduled_.load() == false)
+    {
+        queue_release(eg);
+    }
+}
+
+//
+// @brief Delete an edge of this manager, data still queued is dropped
+//
+void manager::queue_release(struct edge *eg)
+{
+    for (auto it = qu_edge_.begin(); it != qu_edge_.end(); ++it)
+    {
+        if (*it == eg)
+        {
+            qu_edge_.erase(it);
+            break;
+        }
+    }
+
+    // Blocks paused by the edge would never resume
+    if (eg->credit_empty_ == true)
+    {
+        flow_resume(eg);
+    }
+
+    LOGGER_DEBUG("Deleted edge [bk_id=%d ; dropped=%zu]", eg->id_, eg->ring_.size());
+
+    delete eg;
+}
+
+//
+// @brief Delete the edges to the blocks of this manager, data still queued is dropped
+//
+// Blocks bound to them, from this manager or another one, must be deleted or
+// bound again before
+//
+void manager::queue_clear()
+{
+    queue_stop();
+
+    for (struct edge *eg : qu_edge_)
+    {
+        delete eg;
+    }
+    qu_edge_.clear();
+}
@@ -0,0 +1,156 @@
+//
+// @brief Synchronous signal management
+//          - signals are blocked and redirected to a signal file descriptor
+//          - the file descriptor is polled with the others
+//          - a block is notified in the loop, out of any signal handler
+//
+
+// Project headers
+#include "engine/manager.hpp"
+
+// C headers
+extern "C"
+{
+#include <sys/signalfd.h>
+#include <unistd.h>
+}
+
+//
+// @brief Apply the signal mask and update the signal file descriptor
+//
+// @return true on success, false on failure
+//
+static bool signal_mask_apply(struct manager &mgr, int how, int signo)
+{
+    sigset_t mask;
+    int rc;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, signo);
+
+    // Blocked signals are only delivered through the file descriptor
+    rc = pthread_sigmask(how, &mask, nullptr);
+    if (rc != 0)
+    {
+        LOGGER_ERR("Failed to change signal mask: %s [signo=%d]", strerror(rc), signo);
+        return false;
+    }
+
+    rc = signalfd(mgr.sg_fd_, &mgr.sg_mask_, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (rc == -1)
+    {
+        LOGGER_ERR("Failed to update signal file descriptor: %s [errno=%d ; signo=%d]", strerror(errno), errno, signo);
+        return false;
+    }
+    mgr.sg_fd_ = rc;
+
+    return true;
+}
+
+//
+// @brief Register a block to be notified upon signal reception
+//
+// @param signo : Signal to catch
+// @param bk    : Block to notify, it replaces a previously registered one
+//
+// The signal is blocked for the calling thread and the threads it creates
+// afterwards. It should be called from the thread running the manager
+//
+bool manager::signal_add(int signo, struct block *bk)
+{
+    // Verify user input
+    if (bk == nullptr)
+    {
+        LOGGER_ERR("Failed to add signal: nullptr block [signo=%d]", signo);
+        return false;
+    }
+    if ((signo == SIGKILL) || (signo == SIGSTOP) || (sigaddset(&sg_mask_, signo) == -1))
+    {
+        LOGGER_ERR("Failed to add signal: invalid signal [signo=%d]", signo);
+        return false;
+    }
+
+    if (signal_mask_apply(*this, SIG_BLOCK, signo) == false)
+    {
+        sigdelset(&sg_mask_, signo);
+        return false;
+    }
+
+    // Register the file descriptor for reading
+    struct file_desc fd;
+    fd.bk = &bk_mgr_;
+    fd.fd = sg_fd_;
+    fd.socket = nullptr;
+    fd.read = true;
+    fd.write = false;
+    fd_add(fd);
+
+    sg_map_[signo] = bk;
+
+    LOGGER_INFO("Added signal [signo=%d ; bk_id=%d]", signo, bk->id_);
+
+    return true;
+}
+
+//
+// @brief Stop catching a signal, its default behavior is restored
+//
+void manager::signal_del(int signo)
+{
+    if (sg_map_.erase(signo) == 0u)
+    {
+        // Nothing to do
+        return;
+    }
+
+    sigdelset(&sg_mask_, signo);
+    signal_mask_apply(*this, SIG_UNBLOCK, signo);
+
+    LOGGER_INFO("Removed signal [signo=%d]", signo);
+
+    if (sg_map_.empty() == true)
+    {
+        struct file_desc fd;
+
+        fd.fd = sg_fd_;
+        fd.socket = nullptr;
+        fd_remove(fd);
+
+        close(sg_fd_);
+        sg_fd_ = -1;
+    }
+}
+
+//
+// @brief Read pending signals and notify the blocks
+//
+void manager::signal_read()
+{
+    struct signalfd_siginfo info;
+
+    while (read(sg_fd_, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info)))
+    {
+        int signo = static_cast<int>(info.ssi_signo);
+
+        LOGGER_DEBUG("Received signal [signo=%d ; pid=%u]", signo, info.ssi_pid);
+
+        const auto &it = sg_map_.find(signo);
+        if (it == sg_map_.cend())
+        {
+            LOGGER_ERR("Failed to notify signal: no block registered [signo=%d]", signo);
+            continue;
+        }
+        it->second->on_signal_(signo);
+    }
+}
+
+//
+// @brief Stop catching every signal
+//
+void manager::signal_clear()
+{
+    while (sg_map_.empty() == false)
+    {
+        signal_del(sg_map_.cbegin()->first);
+    }
+}
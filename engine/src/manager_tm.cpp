@@ -114,6 +114,12 @@ bool operator<(const struct timespec &a, const struct timespec &b)
     }
 }
 
+// Elapsed time between two dates in nanoseconds
+long elapsed_ns(const struct timespec &from, const struct timespec &to)
+{
+    return (to.tv_sec - from.tv_sec) * NSEC_MAX + (to.tv_nsec - from.tv_nsec);
+}
+
 // Operator for struct timer (necessary for the remove method)
 bool operator==(const struct timer &a, const struct timer &b)
 {
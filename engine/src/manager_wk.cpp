@@ -0,0 +1,292 @@
+//
+// @brief Offload of CPU-heavy processing to a pool of worker threads
+//          - the loop submits work with a buffer
+//          - a worker executes the block's work callback
+//          - the completion comes back to the loop through a MPSC queue
+//            and an event file descriptor
+//
+
+// Project headers
+#include "engine/manager.hpp"
+
+// C headers
+extern "C"
+{
+#include <sys/eventfd.h>
+#include <unistd.h>
+}
+
+#define WORK_BATCH 64 // Maximum number of completions processed per wake up
+
+//
+// @brief Start the worker threads
+//
+bool manager::work_start(size_t count)
+{
+    // Verify user input
+    if (count == 0u)
+    {
+        LOGGER_ERR("Failed to start workers: no worker requested");
+        return false;
+    }
+    if (wk_thread_.empty() == false)
+    {
+        LOGGER_ERR("Failed to start workers: already started [count=%zu]", wk_thread_.size());
+        return false;
+    }
+
+    wk_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wk_fd_ == -1)
+    {
+        LOGGER_ERR("Failed to create event file descriptor: %s [errno=%d]", strerror(errno), errno);
+        return false;
+    }
+
+    // Register the file descriptor for reading
+    struct file_desc fd;
+    fd.bk = &bk_mgr_;
+    fd.fd = wk_fd_;
+    fd.socket = nullptr;
+    fd.read = true;
+    fd.write = false;
+    fd_add(fd);
+
+    wk_stop_ = false;
+    clock_gettime(CLOCK_MONOTONIC, &wk_start_);
+    for (size_t i = 0u; i < count; ++i)
+    {
+        wk_thread_.push_back(std::thread(&manager::work_run, this));
+    }
+
+    LOGGER_INFO("Started workers [count=%zu]", count);
+
+    return true;
+}
+
+//
+// @brief Stop the worker threads
+//
+// Submitted work is processed but completions are dropped: there is
+// no guarantee that the blocks are still able to handle them
+//
+void manager::work_stop()
+{
+    struct mpsc_node *node;
+    unsigned long count;
+
+    if (wk_thread_.empty() == true)
+    {
+        // Nothing to do
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wk_mutex_);
+        wk_stop_ = true;
+    }
+    wk_cond_.notify_all();
+
+    for (auto &it : wk_thread_)
+    {
+        it.join();
+    }
+    wk_thread_.clear();
+
+    // Drop completions
+    count = 0u;
+    for (node = wk_done_.pop(); node != nullptr; node = wk_done_.pop())
+    {
+        struct work *wk = static_cast<struct work *>(node);
+
+        block_work_done(wk->bk);
+        wk->buf.clear();
+        delete wk;
+        ++count;
+    }
+    if (count != 0u)
+    {
+        wk_done_.done(count);
+    }
+
+    struct file_desc fd;
+    fd.fd = wk_fd_;
+    fd.socket = nullptr;
+    fd_remove(fd);
+
+    close(wk_fd_);
+    wk_fd_ = -1;
+
+    LOGGER_INFO("Stopped workers [dropped_count=%lu]", count);
+}
+
+//
+// @brief Submit work to the pool
+//
+// @param bk  : Block to process the work, it must not be deleted until completion (it may be replaced)
+// @param buf : Buffer to process, its parts and deadline are moved into the work
+// @param arg : Generic argument to forward
+//
+bool manager::work_submit(struct block *bk, struct buffer &buf, void *arg)
+{
+    struct work *wk;
+    unsigned long depth;
+
+    // Verify user input
+    if (bk == nullptr)
+    {
+        LOGGER_ERR("Failed to submit work: nullptr block");
+        return false;
+    }
+    if (wk_thread_.empty() == true)
+    {
+        LOGGER_ERR("Failed to submit work: no worker [bk_id=%d]", bk->id_);
+        return false;
+    }
+
+    wk = new struct work;
+    wk->bk = bk;
+    wk->buf.swap(buf);
+    wk->arg = arg;
+    wk->forward = false;
+    clock_gettime(CLOCK_MONOTONIC, &wk->date);
+
+    {
+        std::lock_guard<std::mutex> lock(wk_mutex_);
+        wk_queue_.push_back(wk);
+    }
+    wk_cond_.notify_one();
+
+    ++bk->wk_pending_;
+    ++wk_submit_;
+    depth = wk_submit_ - wk_complete_;
+    if (depth > wk_depth_max_)
+    {
+        wk_depth_max_ = depth;
+    }
+
+    return true;
+}
+
+//
+// @brief Worker thread: process work until asked to stop
+//
+void manager::work_run()
+{
+    while (true)
+    {
+        struct work *wk;
+        struct timespec begin;
+        struct timespec end;
+
+        {
+            std::unique_lock<std::mutex> lock(wk_mutex_);
+
+            wk_cond_.wait(lock, [this] { return (wk_stop_ == true) || (wk_queue_.empty() == false); });
+            if (wk_queue_.empty() == true)
+            {
+                return;
+            }
+
+            wk = wk_queue_.front();
+            wk_queue_.pop_front();
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        wk->forward = wk->bk->work_(*wk);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        wk_busy_ns_.fetch_add(static_cast<unsigned long>(elapsed_ns(begin, end)), std::memory_order_relaxed);
+
+        // Wake up the loop if it does not know yet that completions are pending
+        if (wk_done_.push(wk) == true)
+        {
+            uint64_t one = 1u;
+
+            if (write(wk_fd_, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+            {
+                LOGGER_ERR("Failed to wake up the loop: %s [errno=%d]", strerror(errno), errno);
+            }
+        }
+    }
+}
+
+//
+// @brief Notify blocks of completed work
+//
+void manager::work_complete()
+{
+    struct mpsc_node *node;
+    struct timespec now;
+    uint64_t value;
+    unsigned long count;
+
+    // Acknowledge the wake up
+    if (read(wk_fd_, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value)))
+    {
+        LOGGER_DEBUG("No event to read [errno=%d]", errno);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    count = 0u;
+    for (node = wk_done_.pop(); node != nullptr; node = wk_done_.pop())
+    {
+        struct work *wk = static_cast<struct work *>(node);
+        unsigned long latency;
+
+        latency = static_cast<unsigned long>(elapsed_ns(wk->date, now));
+        wk_latency_ns_ += latency;
+        if (latency > wk_latency_max_ns_)
+        {
+            wk_latency_max_ns_ = latency;
+        }
+        ++wk_complete_;
+
+        wk->bk->on_work_(*wk);
+        block_work_done(wk->bk);
+
+        wk->buf.clear();
+        delete wk;
+
+        if (++count == WORK_BATCH)
+        {
+            break;
+        }
+    }
+
+    // Come back later for completions still pending or being pushed
+    if (wk_done_.done(count) == true)
+    {
+        uint64_t one = 1u;
+
+        if (write(wk_fd_, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+        {
+            LOGGER_ERR("Failed to wake up the loop: %s [errno=%d]", strerror(errno), errno);
+        }
+    }
+}
+
+//
+// @brief Utilization of the workers since their start
+//
+// @return Percentage of the time spent processing
+//
+unsigned long manager::work_utilization() const
+{
+    struct timespec now;
+    long elapsed;
+
+    if (wk_thread_.empty() == true)
+    {
+        return 0u;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = elapsed_ns(wk_start_, now) * static_cast<long>(wk_thread_.size());
+    if (elapsed <= 0)
+    {
+        return 0u;
+    }
+
+    return wk_busy_ns_.load(std::memory_order_relaxed) * 100u / static_cast<unsigned long>(elapsed);
+}
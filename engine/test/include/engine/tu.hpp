@@ -4,10 +4,56 @@
 // Project headers
 #include "engine/manager.hpp"
 
+// C++ headers
+#include <string>
+#include <vector>
+
 // C headers
 extern "C"
 {
 #include <unistd.h>
 }
 
+//
+// @brief Add a block, and sinks bound on its ports from port 0
+//
+// Sinks take the identifiers following the one of the block
+//
+// @return Block added
+//
+inline struct block *tu_block_add(struct manager &mgr, int id, const char *type, int sink_count, const char *sink_type = "hello")
+{
+    ASSERT(mgr.block_add(id, type) == true);
+    for (int i = 0; i < sink_count; ++i)
+    {
+        ASSERT(mgr.block_add(id + 1 + i, sink_type) == true);
+        ASSERT(mgr.block_bind(id, i, id + 1 + i) == true);
+    }
+
+    return mgr.block_get(id);
+}
+
+//
+// @brief Count the data received by a block
+//
+inline unsigned long tu_block_count(struct manager &mgr, int id)
+{
+    return mgr.block_get(id)->data_rx_;
+}
+
+//
+// @brief Send a message made of parts to a block, as a data flow started from it
+//
+inline void tu_block_send(struct block *bk, const std::vector<std::string> &parts)
+{
+    struct buffer buf;
+
+    for (const auto &part : parts)
+    {
+        buf.push_back(part.data(), part.size());
+    }
+    bk->process_data_(bk, &buf);
+    buf.clear();
+}
+
 #endif // TU_HPP
@@ -73,10 +73,89 @@ static void tu_block_flow()
     ASSERT(bk_1->count_ == 1);
     ASSERT(bk_2->count_ == 2);
 
+    // Generate flow to a given sink
+    bk_2->process_data_(bk_1, nullptr);
+    ASSERT(bk_1->count_ == 2);
+    ASSERT(bk_2->count_ == 3);
+
+    // Statistics of the flows
+    ASSERT(bk_1->data_rx_ == 1u);
+    ASSERT(bk_1->data_tx_ == 2u);
+    ASSERT(bk_1->ctrl_rx_ == 1u);
+    ASSERT(bk_2->data_rx_ == 2u);
+    ASSERT(bk_2->data_tx_ == 3u);
+    ASSERT(bk_2->ctrl_rx_ == 1u);
+    ASSERT(bk_1->binds_.size() == 1u);
+    ASSERT(bk_1->binds_.at(0) == 2);
+    ASSERT(bk_2->binds_.empty() == true);
+
     // Clear blocks
     mgr_.block_clear();
 }
 
+//
+// @brief Data past their deadline are dropped at the next hop
+//
+static void tu_block_deadline()
+{
+    struct hello *bk_1;
+    struct hello *bk_2;
+    struct buffer buf;
+    uint64_t deadline_ns;
+
+    ASSERT(mgr_.block_add(1, "hello") == true);
+    ASSERT(mgr_.block_add(2, "hello") == true);
+    ASSERT(mgr_.block_bind(1, 0, 2) == true);
+    bk_1 = static_cast<struct hello *>(mgr_.block_get(1));
+    bk_2 = static_cast<struct hello *>(mgr_.block_get(2));
+
+    // Deadline ahead
+    buf.push_back("hello", strlen("hello"));
+    buf.deadline_set(1000000);
+    bk_1->process_data_(&buf);
+    ASSERT(bk_2->count_ == 1);
+    ASSERT(bk_2->data_expired_ == 0u);
+
+    // Deadline may be tightened, never extended
+    deadline_ns = buf.deadline_ns_;
+    buf.deadline_tighten(2000000);
+    ASSERT(buf.deadline_ns_ == deadline_ns);
+    buf.deadline_tighten(1000);
+    ASSERT(buf.deadline_ns_ < deadline_ns);
+
+    // Deadline passed
+    usleep(2 * 1000);
+    ASSERT(buf.is_expired(buffer_now_ns()) == true);
+    bk_1->process_data_(&buf);
+    ASSERT(bk_2->count_ == 1);
+    ASSERT(bk_2->data_rx_ == 1u);
+    ASSERT(bk_2->data_expired_ == 1u);
+
+    // Deadline extended, or removed
+    buf.deadline_set(1000000);
+    ASSERT(buf.is_expired(buffer_now_ns()) == false);
+    buf.deadline_set(0);
+    ASSERT(buf.deadline_ns_ == 0u);
+    bk_1->process_data_(&buf);
+    ASSERT(bk_2->count_ == 2);
+
+    // Deadline moves with the parts
+    {
+        struct buffer other;
+
+        buf.deadline_set(1000000);
+        deadline_ns = buf.deadline_ns_;
+        other.swap(buf);
+        ASSERT(other.deadline_ns_ == deadline_ns);
+        ASSERT(other.parts_.size() == 1u);
+        ASSERT(buf.deadline_ns_ == 0u);
+        other.clear();
+        ASSERT(other.deadline_ns_ == 0u);
+    }
+
+    mgr_.block_clear();
+}
+
 static void tu_block_errors()
 {
     struct hello *bk;
@@ -102,6 +181,7 @@ int main(int, char **)
 
     tu_block_interface();
     tu_block_flow();
+    tu_block_deadline();
     tu_block_errors();
 
     LOGGER_CLOSE();
@@ -92,11 +92,82 @@ static void tu_manager_bk_life_cycle()
     mgr_.block_factory_clear();
 }
 
+//
+// @brief Replace blocks keeping their bindings
+//
+static void tu_manager_bk_replace()
+{
+    struct factory_failure failure;
+    struct factory_success success;
+    struct block *bk_1;
+    struct block *bk_2;
+    struct block *bk_3;
+    struct block *old_bk;
+    struct timer tm;
+
+    mgr_.block_factory_register("block_derived", &success);
+    mgr_.block_factory_register("block_failure", &failure);
+
+    // Chain: 1 -> 2 -> 3 -> 3
+    ASSERT(mgr_.block_add(1, "block_derived") == true);
+    ASSERT(mgr_.block_add(2, "block_derived") == true);
+    ASSERT(mgr_.block_add(3, "block_derived") == true);
+    ASSERT(mgr_.block_bind(1, 0, 2) == true);
+    ASSERT(mgr_.block_bind(2, 4, 3) == true);
+    ASSERT(mgr_.block_bind(3, 0, 3) == true);
+    ASSERT(mgr_.block_start(2) == true);
+    bk_1 = mgr_.block_get(1);
+    old_bk = mgr_.block_get(2);
+    bk_3 = mgr_.block_get(3);
+
+    // Timers left by the replaced block are removed
+    tm.bk = old_bk;
+    tm.time.tv_sec = 10;
+    tm.time.tv_nsec = 0;
+    tm.arg = nullptr;
+    tm.tid = 0;
+    ASSERT(mgr_.timer_add(tm) == true);
+    ASSERT(mgr_.signal_add(SIGUSR1, old_bk) == true);
+
+    // Middle of the chain
+    ASSERT(mgr_.block_replace(2, "block_derived") == true);
+    bk_2 = mgr_.block_get(2);
+    ASSERT(bk_2 != old_bk);
+    ASSERT(bk_2->id_ == 2);
+    ASSERT(bk_2->is_started_ == true);
+    ASSERT(bk_1->sink_ == bk_2);
+    ASSERT(bk_2->sink_ == bk_3);
+    ASSERT(bk_2->binds_.size() == 1u);
+    ASSERT(bk_2->binds_.at(4) == 3);
+    ASSERT(mgr_.tm_list_.empty() == true);
+    ASSERT(mgr_.sg_map_.at(SIGUSR1) == bk_2);
+    ASSERT(mgr_.bk_retired_.empty() == true);
+
+    // Block bound to itself
+    ASSERT(mgr_.block_replace(3, "block_derived") == true);
+    ASSERT(mgr_.block_get(3) != bk_3);
+    bk_3 = mgr_.block_get(3);
+    ASSERT(bk_3->sink_ == bk_3);
+    ASSERT(bk_2->sink_ == bk_3);
+    ASSERT(bk_3->is_started_ == false);
+
+    // Errors
+    ASSERT(mgr_.block_replace(42, "block_derived") == false);
+    ASSERT(mgr_.block_replace(1, "dummy") == false);
+    ASSERT(mgr_.block_replace(1, "block_failure") == false);
+    ASSERT(mgr_.block_get(1) == bk_1);
+
+    mgr_.signal_clear();
+    mgr_.block_clear();
+    mgr_.block_factory_clear();
+}
+
 int main(int, char **)
 {
     LOGGER_OPEN("tu_manager_bk");
 
     tu_manager_bk_life_cycle();
+    tu_manager_bk_replace();
 
     LOGGER_CLOSE();
     return 0;
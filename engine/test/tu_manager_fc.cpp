@@ -0,0 +1,272 @@
+//
+// @brief Test file for the flow control between blocks
+//
+
+// Project headers
+#include "engine/tu.hpp"
+
+// C++ headers
+#include <algorithm>
+
+// Block producing data, paused by the sinks out of credits
+struct block_source : block
+{
+    bool is_paused_;
+    unsigned long flow_count_;
+
+    explicit block_source(struct manager *mgr) : block(mgr), is_paused_(false), flow_count_(0u) {}
+    virtual ~block_source() override final {}
+
+    virtual void on_flow_(bool is_paused) override final
+    {
+        is_paused_ = is_paused;
+        ++flow_count_;
+    }
+
+    virtual bool data_(void *) override final { return true; }
+};
+
+// Block holding the data it receives until released
+struct block_queue : block
+{
+    long held_;
+    unsigned long drop_;
+
+    explicit block_queue(struct manager *mgr) : block(mgr), held_(0), drop_(0u) {}
+    virtual ~block_queue() override final {}
+
+    virtual bool data_(void *) override final
+    {
+        if (credit_take_() == false)
+        {
+            ++drop_;
+            return false;
+        }
+        ++held_;
+        return false;
+    }
+
+    void release(long count)
+    {
+        held_ -= count;
+        credit_give_(count);
+    }
+};
+
+struct source_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final
+    {
+        return new struct block_source(mgr);
+    }
+    virtual void destructor(struct block *bk) override final
+    {
+        delete static_cast<struct block_source *>(bk);
+    }
+};
+
+struct queue_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final
+    {
+        return new struct block_queue(mgr);
+    }
+    virtual void destructor(struct block *bk) override final
+    {
+        delete static_cast<struct block_queue *>(bk);
+    }
+};
+
+struct manager mgr_;
+
+static struct block_source *tu_manager_fc_source(int id)
+{
+    return static_cast<struct block_source *>(mgr_.block_get(id));
+}
+
+static struct block_queue *tu_manager_fc_queue(int id)
+{
+    return static_cast<struct block_queue *>(mgr_.block_get(id));
+}
+
+//
+// @brief Send data from a block
+//
+static void tu_manager_fc_send(int id, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        mgr_.block_get(id)->process_data_(nullptr);
+    }
+}
+
+//
+// @brief Build the graph:
+//   1 -> 2 -> 3 (queue)
+//        2 -> 6 (queue, port 1)
+//   4 -> 3
+//   5 -> 6
+//
+static void tu_manager_fc_graph()
+{
+    ASSERT(mgr_.block_add(1, "source") == true);
+    ASSERT(mgr_.block_add(2, "source") == true);
+    ASSERT(mgr_.block_add(3, "queue") == true);
+    ASSERT(mgr_.block_add(4, "source") == true);
+    ASSERT(mgr_.block_add(5, "source") == true);
+    ASSERT(mgr_.block_add(6, "queue") == true);
+    ASSERT(mgr_.block_bind(1, 0, 2) == true);
+    ASSERT(mgr_.block_bind(2, 1, 6) == true);
+    ASSERT(mgr_.block_bind(2, 0, 3) == true);
+    ASSERT(mgr_.block_bind(4, 0, 3) == true);
+    ASSERT(mgr_.block_bind(5, 0, 6) == true);
+
+    tu_manager_fc_queue(3)->credit_set_(4);
+    tu_manager_fc_queue(6)->credit_set_(2);
+
+    ASSERT(mgr_.bk_up_[3].size() == 2u);
+    ASSERT(mgr_.bk_up_[6].size() == 2u);
+}
+
+//
+// @brief Sources are paused while a sink is out of credits
+//
+static void tu_manager_fc_credit()
+{
+    struct block_queue *queue;
+
+    tu_manager_fc_graph();
+    queue = tu_manager_fc_queue(3);
+
+    // Credits run out
+    tu_manager_fc_send(1, 3);
+    ASSERT(queue->credit_ == 1);
+    ASSERT(tu_manager_fc_source(1)->is_paused_ == false);
+    tu_manager_fc_send(4, 1);
+    ASSERT(queue->credit_ == 0);
+    ASSERT(queue->credit_empty_ == true);
+    ASSERT(queue->credit_out_ == 1u);
+    ASSERT(queue->credit_paused_.size() == 3u);
+
+    // Blocks upstream are paused, directly bound or not
+    ASSERT(tu_manager_fc_source(1)->is_paused_ == true);
+    ASSERT(tu_manager_fc_source(1)->flow_paused_ == 1u);
+    ASSERT(tu_manager_fc_source(2)->is_paused_ == true);
+    ASSERT(tu_manager_fc_source(4)->is_paused_ == true);
+    ASSERT(tu_manager_fc_source(5)->is_paused_ == false);
+
+    // Memory stays bounded: data that still comes is not held
+    tu_manager_fc_send(1, 2);
+    ASSERT(queue->held_ == 4);
+    ASSERT(queue->drop_ == 2u);
+
+    // Resume once half of the credits are back
+    queue->release(1);
+    ASSERT(tu_manager_fc_source(1)->is_paused_ == true);
+    queue->release(1);
+    ASSERT(queue->credit_empty_ == false);
+    ASSERT(queue->credit_paused_.empty() == true);
+    ASSERT(tu_manager_fc_source(1)->is_paused_ == false);
+    ASSERT(tu_manager_fc_source(1)->flow_count_ == 2u);
+    ASSERT(tu_manager_fc_source(4)->is_paused_ == false);
+
+    // A block is paused while any of its sinks is out of credits
+    tu_manager_fc_send(1, 2);
+    tu_manager_fc_send(5, 2);
+    ASSERT(tu_manager_fc_source(1)->flow_hold_ == 2u);
+    ASSERT(tu_manager_fc_source(5)->flow_hold_ == 1u);
+    queue->release(4);
+    ASSERT(tu_manager_fc_source(1)->is_paused_ == true);
+    ASSERT(tu_manager_fc_source(4)->is_paused_ == false);
+    tu_manager_fc_queue(6)->release(1);
+    ASSERT(tu_manager_fc_source(1)->is_paused_ == false);
+    ASSERT(tu_manager_fc_source(5)->is_paused_ == false);
+    ASSERT(tu_manager_fc_source(1)->flow_paused_ == 2u);
+
+    // Disabling the flow control resumes
+    tu_manager_fc_send(4, 4);
+    ASSERT(tu_manager_fc_source(4)->is_paused_ == true);
+    queue->credit_set_(0);
+    ASSERT(tu_manager_fc_source(4)->is_paused_ == false);
+    ASSERT(queue->credit_take_() == true);
+
+    // Negative count is ignored
+    queue->credit_set_(-1);
+    ASSERT(queue->credit_max_ == 0);
+
+    mgr_.block_clear();
+}
+
+//
+// @brief Paused blocks resume when the sink goes away
+//
+static void tu_manager_fc_life_cycle()
+{
+    std::vector<int> ids;
+
+    tu_manager_fc_graph();
+
+    // Deleted sink
+    tu_manager_fc_send(4, 4);
+    ASSERT(tu_manager_fc_source(4)->is_paused_ == true);
+    ASSERT(mgr_.block_del(3) == true);
+    ASSERT(tu_manager_fc_source(4)->is_paused_ == false);
+    ASSERT(tu_manager_fc_source(4)->flow_hold_ == 0u);
+    ASSERT(mgr_.bk_up_.count(3) == 0u);
+
+    // Replaced sink, the new block grants its own credits
+    tu_manager_fc_send(5, 2);
+    ASSERT(tu_manager_fc_source(5)->is_paused_ == true);
+    ASSERT(mgr_.block_replace(6, "queue") == true);
+    ASSERT(tu_manager_fc_source(5)->is_paused_ == false);
+    ASSERT(tu_manager_fc_queue(6)->credit_out_ == 1u);
+    ASSERT(tu_manager_fc_queue(6)->credit_max_ == 0);
+
+    // Replaced source stays paused, and resumes with the sink
+    tu_manager_fc_queue(6)->credit_set_(1);
+    tu_manager_fc_send(5, 1);
+    ASSERT(mgr_.block_replace(5, "source") == true);
+    ASSERT(tu_manager_fc_source(5)->flow_hold_ == 1u);
+    tu_manager_fc_queue(6)->release(1);
+    ASSERT(tu_manager_fc_source(5)->flow_hold_ == 0u);
+    ASSERT(tu_manager_fc_source(5)->flow_count_ == 1u);
+
+    // Sink on a loop pauses itself
+    ASSERT(mgr_.block_bind(6, 0, 5) == true);
+    tu_manager_fc_send(5, 1);
+    ASSERT(tu_manager_fc_queue(6)->flow_hold_ == 1u);
+    tu_manager_fc_queue(6)->release(1);
+    ASSERT(tu_manager_fc_queue(6)->flow_hold_ == 0u);
+
+    // Block bound again is upstream of its new sink only
+    mgr_.flow_upstream(tu_manager_fc_queue(6), ids);
+    ASSERT(ids.size() == 4u);
+    ASSERT(mgr_.block_bind(5, 0, 4) == true);
+    ASSERT(mgr_.bk_up_[6].size() == 1u);
+    ids.clear();
+    mgr_.flow_upstream(tu_manager_fc_queue(6), ids);
+    ASSERT(ids.size() == 2u);
+    ASSERT(std::find(ids.cbegin(), ids.cend(), 5) == ids.cend());
+
+    mgr_.block_clear();
+    ASSERT(mgr_.bk_up_.empty() == true);
+}
+
+int main(int, char **)
+{
+    struct source_factory source_f;
+    struct queue_factory queue_f;
+
+    LOGGER_OPEN("tu_manager_fc");
+
+    mgr_.block_factory_register("source", &source_f);
+    mgr_.block_factory_register("queue", &queue_f);
+
+    tu_manager_fc_credit();
+    tu_manager_fc_life_cycle();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
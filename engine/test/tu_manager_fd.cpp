@@ -59,6 +59,58 @@ static void tu_manager_fd_fd()
     fclose(file);
 }
 
+//
+// @brief Test busy polling and its fallback to blocking polls
+//
+static void tu_manager_fd_spin()
+{
+    struct block_fd bk_(&mgr_);
+    int pipe_fd[2];
+
+    ASSERT(pipe(pipe_fd) == 0);
+
+    struct file_desc file_d;
+    file_d.bk = &bk_;
+    file_d.fd = pipe_fd[0];
+    file_d.socket = nullptr;
+    file_d.read = true;
+    file_d.write = false;
+    ASSERT(mgr_.fd_add(file_d) == true);
+
+    // Spin for 100 ms before blocking
+    mgr_.fd_spin(100 * 1000);
+    mgr_.spin_count_ = 0u;
+    mgr_.sleep_count_ = 0u;
+    mgr_.sleep_hit_ = 0u;
+
+    ASSERT(mgr_.fd_poll() == 0);
+    ASSERT(mgr_.spin_count_ == 1u);
+    ASSERT(mgr_.spin_hit_ == 0u);
+    ASSERT(mgr_.sleep_count_ == 0u);
+
+    // An event is caught while spinning
+    ASSERT(write(pipe_fd[1], "x", 1) == 1);
+    ASSERT(mgr_.fd_poll() == 1);
+    ASSERT(bk_.boule_ == true);
+    ASSERT(mgr_.spin_count_ == 2u);
+    ASSERT(mgr_.spin_hit_ == 1u);
+
+    // Fall back to a blocking poll once idle
+    mgr_.fd_spin(1);
+    usleep(1000);
+    ASSERT(mgr_.fd_poll() == 1);
+    ASSERT(mgr_.sleep_count_ == 1u);
+    ASSERT(mgr_.sleep_hit_ == 1u);
+
+    // Disable busy polling
+    mgr_.fd_spin(0);
+    ASSERT(mgr_.spin_ns_ == 0);
+
+    mgr_.fd_remove(file_d);
+    close(pipe_fd[0]);
+    close(pipe_fd[1]);
+}
+
 static void tu_manager_fd_errors()
 {
     struct block_fd bk_(&mgr_);
@@ -83,6 +135,7 @@ int main(int, char **)
     LOGGER_OPEN("tu_manager_fd");
 
     tu_manager_fd_fd();
+    tu_manager_fd_spin();
     tu_manager_fd_errors();
 
     LOGGER_CLOSE();
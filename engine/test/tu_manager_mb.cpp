@@ -0,0 +1,109 @@
+//
+// @brief Test file for the block manager
+//
+
+// Project headers
+#include "block/hello.hpp"
+#include "engine/tu.hpp"
+
+struct hello_factory factory;
+struct manager mgr_;
+
+//
+// @brief Post data and notifications from other threads
+//
+static void tu_manager_mb_post()
+{
+    struct hello *bk_1;
+    struct hello *bk_2;
+    std::vector<std::thread> producers;
+    size_t thread_count = 4u;
+    size_t post_count = 1000u;
+
+    ASSERT(mgr_.block_add(1, "hello") == true);
+    ASSERT(mgr_.block_add(2, "hello") == true);
+    ASSERT(mgr_.block_bind(1, 0, 2) == true);
+    bk_1 = static_cast<struct hello *>(mgr_.block_get(1));
+    bk_2 = static_cast<struct hello *>(mgr_.block_get(2));
+
+    ASSERT(mgr_.mailbox_start() == true);
+
+    for (size_t i = 0u; i < thread_count; ++i)
+    {
+        producers.push_back(std::thread([post_count] {
+            for (size_t j = 0u; j < post_count; ++j)
+            {
+                struct buffer buf;
+
+                buf.push_back("hello", strlen("hello"));
+                ASSERT(mgr_.post_data(1, buf) == true);
+                ASSERT(buf.parts_.empty() == true);
+
+                ASSERT(mgr_.post_ctrl(2, nullptr) == true);
+            }
+        }));
+    }
+
+    // Mails are delivered by the loop
+    for (int i = 0; (i < 10 * 1000) && (mgr_.mb_count_ != 2u * thread_count * post_count); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    for (auto &it : producers)
+    {
+        it.join();
+    }
+    ASSERT(mgr_.mb_count_ == 2u * thread_count * post_count);
+    ASSERT(mgr_.mb_wakeup_ > 0u);
+
+    // Data went through block 1 to block 2
+    ASSERT(bk_1->count_ == static_cast<int>(thread_count * post_count));
+    ASSERT(bk_2->count_ == static_cast<int>(2u * thread_count * post_count));
+
+    mgr_.mailbox_stop();
+    ASSERT(mgr_.mb_fd_ == -1);
+    ASSERT(mgr_.fd_.size() == 0u);
+
+    mgr_.block_clear();
+}
+
+static void tu_manager_mb_errors()
+{
+    struct buffer buf;
+
+    // Post without a mailbox
+    ASSERT(mgr_.post_data(1, buf) == false);
+    ASSERT(mgr_.post_ctrl(1, nullptr) == false);
+
+    // Start twice
+    ASSERT(mgr_.mailbox_start() == true);
+    ASSERT(mgr_.mailbox_start() == false);
+
+    // Post to an unknown block
+    ASSERT(mgr_.post_ctrl(42, nullptr) == true);
+    ASSERT(mgr_.fd_poll() == 1);
+    ASSERT(mgr_.mb_count_ == 1u);
+
+    // Stop with mails pending
+    buf.push_back("dummy", strlen("dummy"));
+    ASSERT(mgr_.post_data(42, buf) == true);
+    mgr_.mailbox_stop();
+
+    // Stop twice
+    mgr_.mailbox_stop();
+}
+
+int main(int, char **)
+{
+    LOGGER_OPEN("tu_manager_mb");
+
+    mgr_.block_factory_register("hello", &factory);
+
+    tu_manager_mb_post();
+
+    mgr_.mb_count_ = 0u;
+    tu_manager_mb_errors();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -0,0 +1,238 @@
+//
+// @brief Test file for the queued bindings
+//
+
+// Project headers
+#include "engine/tu.hpp"
+
+// Block counting the data it receives
+struct block_count : block
+{
+    unsigned long count_;
+
+    explicit block_count(struct manager *mgr) : block(mgr), count_(0u) {}
+    virtual ~block_count() override final {}
+
+    virtual bool data_(void *) override final
+    {
+        ++count_;
+        return false;
+    }
+};
+
+struct count_factory : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final
+    {
+        return new struct block_count(mgr);
+    }
+    virtual void destructor(struct block *bk) override final
+    {
+        delete static_cast<struct block_count *>(bk);
+    }
+};
+
+struct count_factory factory;
+struct manager mgr_;
+
+static unsigned long tu_manager_qu_count(struct manager &mgr, int id)
+{
+    return static_cast<struct block_count *>(mgr.block_get(id))->count_;
+}
+
+//
+// @brief Send data from a block to its sink
+//
+static void tu_manager_qu_send(struct manager &mgr, int id, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        struct buffer buf;
+
+        buf.push_back("hello", strlen("hello"));
+        mgr.block_get(id)->process_data_(&buf);
+        buf.clear();
+    }
+}
+
+//
+// @brief Run the edges with pending data
+//
+static void tu_manager_qu_run()
+{
+    for (int i = 0; (i < 1000) && (mgr_.qu_ready_.pending_.load() != 0u); ++i)
+    {
+        mgr_.fd_poll();
+    }
+}
+
+//
+// @brief Queued binding within a manager
+//
+static void tu_manager_qu_local()
+{
+    struct bind_opt opt;
+    struct edge *eg;
+
+    ASSERT(mgr_.block_add(1, "count") == true);
+    ASSERT(mgr_.block_add(2, "count") == true);
+
+    // Queues are started with the first edge
+    opt.queue = 5u;
+    ASSERT(mgr_.block_bind(1, 0, 2, opt) == true);
+    ASSERT(mgr_.qu_fd_ != -1);
+    eg = mgr_.block_get(1)->edge_[0];
+    ASSERT(mgr_.block_get(1)->sink_ == eg);
+    ASSERT(eg->ring_.capacity() == 8u);
+    ASSERT(eg->credit_max_ == 8);
+
+    // Data waits in the ring for the loop
+    tu_manager_qu_send(mgr_, 1, 3);
+    ASSERT(tu_manager_qu_count(mgr_, 2) == 0u);
+    ASSERT(eg->ring_.size() == 3u);
+    ASSERT(eg->is_scheduled_.load() == true);
+    tu_manager_qu_run();
+    ASSERT(tu_manager_qu_count(mgr_, 2) == 3u);
+    ASSERT(eg->is_scheduled_.load() == false);
+    ASSERT(eg->data_rx_ == 3u);
+    ASSERT(eg->data_tx_ == 3u);
+    ASSERT(mgr_.qu_count_ == 3u);
+    ASSERT(mgr_.qu_run_ == 1u);
+
+    // Full ring pauses the source
+    tu_manager_qu_send(mgr_, 1, 9);
+    ASSERT(mgr_.block_get(1)->flow_hold_ == 1u);
+    ASSERT(eg->drop_full_ == 1u);
+    tu_manager_qu_run();
+    ASSERT(tu_manager_qu_count(mgr_, 2) == 11u);
+    ASSERT(mgr_.block_get(1)->flow_hold_ == 0u);
+
+    // Edge replaced by another binding delivers its data, then it is deleted
+    tu_manager_qu_send(mgr_, 1, 2);
+    opt.queue = 64u;
+    ASSERT(mgr_.block_bind(1, 0, 2, opt) == true);
+    ASSERT(mgr_.qu_edge_.size() == 2u);
+    ASSERT(eg->is_retired_ == true);
+    tu_manager_qu_run();
+    ASSERT(tu_manager_qu_count(mgr_, 2) == 13u);
+    ASSERT(mgr_.qu_edge_.size() == 1u);
+    ASSERT(mgr_.qu_run_ == 3u);
+
+    // Idle edge is deleted at once
+    eg = mgr_.block_get(1)->edge_[0];
+    ASSERT(mgr_.block_bind(1, 0, 2, opt) == true);
+    ASSERT(mgr_.qu_edge_.size() == 1u);
+    ASSERT(mgr_.qu_edge_[0] == mgr_.block_get(1)->edge_[0]);
+
+    // Data comes in bursts, the edge goes back to the end of the queue in between
+    eg = mgr_.block_get(1)->edge_[0];
+    tu_manager_qu_send(mgr_, 1, 40);
+    mgr_.fd_poll();
+    ASSERT(tu_manager_qu_count(mgr_, 2) == 53u);
+    ASSERT(mgr_.qu_run_ == 5u);
+
+    // Data queued for a replaced block goes to the new one
+    tu_manager_qu_send(mgr_, 1, 2);
+    ASSERT(mgr_.block_replace(2, "count") == true);
+    ASSERT(eg->dst_ == mgr_.block_get(2));
+    ASSERT(mgr_.block_get(1)->sink_ == eg);
+    tu_manager_qu_run();
+    ASSERT(tu_manager_qu_count(mgr_, 2) == 2u);
+
+    // Data queued for a deleted block is dropped
+    tu_manager_qu_send(mgr_, 1, 2);
+    ASSERT(mgr_.block_del(2) == true);
+    ASSERT(eg->dst_ == nullptr);
+    tu_manager_qu_run();
+    ASSERT(eg->drop_unbound_ == 2u);
+
+    // Edges of a deleted block are deleted
+    mgr_.block_clear();
+    ASSERT(mgr_.qu_edge_.empty() == true);
+    mgr_.queue_clear();
+    ASSERT(mgr_.qu_fd_ == -1);
+}
+
+//
+// @brief Pipeline between two managers running in their own thread
+//
+static void tu_manager_qu_pipeline()
+{
+    struct manager mgr_sink;
+    struct bind_opt opt;
+    std::atomic<bool> is_done(false);
+    unsigned long count;
+    struct edge *eg;
+
+    mgr_sink.block_factory_register("count", &factory);
+    ASSERT(mgr_sink.block_add(2, "count") == true);
+    ASSERT(mgr_.block_add(1, "count") == true);
+
+    // Queues of the other manager are started from its thread
+    opt.mgr = &mgr_sink;
+    ASSERT(mgr_.block_bind(1, 0, 2, opt) == false);
+    opt.queue = 1024u;
+    ASSERT(mgr_.block_bind(1, 0, 2, opt) == false);
+    ASSERT(mgr_sink.queue_start() == true);
+    ASSERT(mgr_.block_bind(1, 0, 2, opt) == true);
+    eg = mgr_.block_get(1)->edge_[0];
+    ASSERT(eg->credit_max_ == 0);
+
+    std::thread sink([&mgr_sink, &is_done, eg] {
+        while ((is_done.load() == false) || (eg->ring_.size() != 0u))
+        {
+            mgr_sink.fd_poll();
+        }
+    });
+
+    count = 100u * 1000u;
+    tu_manager_qu_send(mgr_, 1, static_cast<int>(count));
+    is_done.store(true);
+    sink.join();
+
+    // Data is delivered in order or dropped while the ring is full
+    ASSERT(tu_manager_qu_count(mgr_sink, 2) + eg->drop_full_ == count);
+    ASSERT(tu_manager_qu_count(mgr_sink, 2) > 0u);
+    ASSERT(mgr_sink.qu_count_ == tu_manager_qu_count(mgr_sink, 2));
+
+    // Blocks bound to the edges are deleted first
+    mgr_.block_clear();
+    mgr_sink.block_clear();
+    mgr_sink.queue_clear();
+}
+
+static void tu_manager_qu_errors()
+{
+    struct edge *eg;
+    struct bind_opt opt;
+
+    ASSERT(mgr_.block_add(1, "count") == true);
+    opt.queue = 1u;
+    ASSERT(mgr_.block_bind(1, 0, 1, opt) == true);
+    eg = mgr_.block_get(1)->edge_[0];
+    ASSERT(eg->data_(nullptr) == false);
+    ASSERT(mgr_.queue_start() == false);
+
+    // Unknown blocks
+    ASSERT(mgr_.block_bind(1, 0, 2, opt) == false);
+    ASSERT(mgr_.block_bind(2, 0, 1, opt) == false);
+
+    mgr_.block_clear();
+    mgr_.queue_clear();
+}
+
+int main(int, char **)
+{
+    LOGGER_OPEN("tu_manager_qu");
+
+    mgr_.block_factory_register("count", &factory);
+
+    tu_manager_qu_local();
+    tu_manager_qu_pipeline();
+    tu_manager_qu_errors();
+
+    mgr_.block_factory_clear();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -0,0 +1,84 @@
+//
+// @brief Test file for the block manager
+//
+
+// Project headers
+#include "engine/tu.hpp"
+
+struct block_signal : block
+{
+    std::vector<int> signo_;
+
+    explicit block_signal(struct manager *mgr) : block(mgr) {}
+
+    virtual void on_signal_(int signo) override final
+    {
+        signo_.push_back(signo);
+    }
+};
+
+struct manager mgr_;
+
+//
+// @brief Signal reception from the polling loop
+//
+static void tu_manager_sg_signal()
+{
+    struct block_signal bk_(&mgr_);
+
+    ASSERT(mgr_.signal_add(SIGUSR1, &bk_) == true);
+    ASSERT(mgr_.signal_add(SIGUSR2, &bk_) == true);
+
+    // Nothing is pending
+    ASSERT(mgr_.fd_poll() == 0);
+    ASSERT(bk_.signo_.size() == 0u);
+
+    // Signals are blocked and delivered during the poll
+    ASSERT(raise(SIGUSR1) == 0);
+    ASSERT(raise(SIGUSR2) == 0);
+    ASSERT(bk_.signo_.size() == 0u);
+
+    ASSERT(mgr_.fd_poll() == 1);
+    ASSERT(bk_.signo_.size() == 2u);
+    ASSERT(bk_.signo_[0] == SIGUSR1);
+    ASSERT(bk_.signo_[1] == SIGUSR2);
+    bk_.signo_.clear();
+
+    // Stop catching one signal
+    mgr_.signal_del(SIGUSR2);
+    ASSERT(raise(SIGUSR1) == 0);
+    ASSERT(mgr_.fd_poll() == 1);
+    ASSERT(bk_.signo_.size() == 1u);
+    ASSERT(bk_.signo_[0] == SIGUSR1);
+
+    // Release the signal file descriptor
+    mgr_.signal_clear();
+    ASSERT(mgr_.sg_fd_ == -1);
+    ASSERT(mgr_.fd_.size() == 0u);
+}
+
+static void tu_manager_sg_errors()
+{
+    struct block_signal bk_(&mgr_);
+
+    // Add a signal with no block
+    ASSERT(mgr_.signal_add(SIGUSR1, nullptr) == false);
+
+    // Add signals that can't be caught
+    ASSERT(mgr_.signal_add(SIGKILL, &bk_) == false);
+    ASSERT(mgr_.signal_add(4242, &bk_) == false);
+
+    // Remove an unknown signal
+    mgr_.signal_del(SIGUSR1);
+}
+
+int main(int, char **)
+{
+    LOGGER_OPEN("tu_manager_sg");
+
+    tu_manager_sg_signal();
+    tu_manager_sg_errors();
+
+    LOGGER_CLOSE();
+    return 0;
+}
@@ -0,0 +1,217 @@
+//
+// @brief Test file for the block manager
+//
+
+// Project headers
+#include "engine/tu.hpp"
+
+// C++ headers
+#include <cctype>
+
+// Block turning its buffer to upper case from a worker thread
+struct block_work : block
+{
+    explicit block_work(struct manager *mgr) : block(mgr) {}
+
+    virtual bool work_(struct work &wk) override final
+    {
+        for (const auto &part : wk.buf.parts_)
+        {
+            char *data = static_cast<char *>(part.data);
+
+            for (size_t i = 0u; i < part.len; ++i)
+            {
+                data[i] = static_cast<char>(toupper(data[i]));
+            }
+        }
+
+        // Forward only when asked to
+        return (wk.arg != nullptr);
+    }
+};
+
+// Block receiving the completed buffers
+struct block_sink : block
+{
+    std::vector<std::string> data_l_;
+
+    explicit block_sink(struct manager *mgr) : block(mgr) {}
+
+    virtual bool data_(void *vdata) override final
+    {
+        struct buffer &buf = *static_cast<struct buffer *>(vdata);
+
+        data_l_.push_back(std::string(static_cast<char *>(buf.parts_[0].data), buf.parts_[0].len));
+
+        return false;
+    }
+};
+
+template <typename T>
+struct factory_wk : block_factory
+{
+    virtual struct block *constructor(struct manager *mgr) override final { return new T(mgr); }
+    virtual void destructor(struct block *bk) override final { delete static_cast<T *>(bk); }
+};
+
+struct manager mgr_;
+
+//
+// @brief Offload work and resume the data flow on completion
+//
+static void tu_manager_wk_offload()
+{
+    struct block_work bk_work(&mgr_);
+    struct block_sink bk_sink(&mgr_);
+    size_t count = 1000u;
+    int forward = 1;
+
+    bk_work.sink_ = &bk_sink;
+
+    ASSERT(mgr_.work_start(4u) == true);
+
+    for (size_t i = 0u; i < count; ++i)
+    {
+        struct buffer buf;
+
+        buf.push_back("hello", strlen("hello"));
+
+        // Half of the work is not forwarded
+        ASSERT(mgr_.work_submit(&bk_work, buf, ((i & 1u) == 0u) ? &forward : nullptr) == true);
+        ASSERT(buf.parts_.empty() == true);
+    }
+    ASSERT(mgr_.wk_submit_ == count);
+
+    // Completions are delivered by the loop
+    for (int i = 0; (i < 1000) && (mgr_.wk_complete_ != count); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(mgr_.wk_complete_ == count);
+    ASSERT(mgr_.wk_depth_max_ > 0u);
+    ASSERT(mgr_.wk_depth_max_ <= count);
+    ASSERT(mgr_.wk_latency_max_ns_ > 0u);
+    ASSERT(mgr_.work_utilization() <= 100u);
+
+    ASSERT(bk_sink.data_l_.size() == count / 2u);
+    for (const auto &it : bk_sink.data_l_)
+    {
+        ASSERT(it == "HELLO");
+    }
+
+    mgr_.work_stop();
+    ASSERT(mgr_.wk_fd_ == -1);
+    ASSERT(mgr_.fd_.size() == 0u);
+}
+
+//
+// @brief Replace blocks while work is in flight: no data is lost
+//
+static void tu_manager_wk_replace()
+{
+    struct factory_wk<struct block_work> factory_work;
+    struct factory_wk<struct block_sink> factory_sink;
+    struct block_sink *bk_sink;
+    size_t count = 100u;
+    int forward = 1;
+
+    mgr_.block_factory_register("block_work", &factory_work);
+    mgr_.block_factory_register("block_sink", &factory_sink);
+    ASSERT(mgr_.block_add(1, "block_work") == true);
+    ASSERT(mgr_.block_add(2, "block_sink") == true);
+    ASSERT(mgr_.block_bind(1, 0, 2) == true);
+
+    ASSERT(mgr_.work_start(2u) == true);
+    for (size_t i = 0u; i < count; ++i)
+    {
+        struct buffer buf;
+
+        buf.push_back("hello", strlen("hello"));
+        ASSERT(mgr_.work_submit(mgr_.block_get(1), buf, &forward) == true);
+    }
+
+    // The worker block is kept until its work is completed, the sink is replaced at once
+    ASSERT(mgr_.block_replace(1, "block_work") == true);
+    ASSERT(mgr_.block_replace(2, "block_sink") == true);
+    bk_sink = static_cast<struct block_sink *>(mgr_.block_get(2));
+
+    for (int i = 0; (i < 1000) && (bk_sink->data_l_.size() != count); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(bk_sink->data_l_.size() == count);
+    ASSERT(mgr_.bk_retired_.empty() == true);
+
+    // Deleted block is kept until its work is completed
+    ASSERT(mgr_.block_add(3, "block_work") == true);
+    mgr_.block_get(3)->sink_ = bk_sink;
+    {
+        struct buffer buf;
+
+        buf.push_back("hello", strlen("hello"));
+        ASSERT(mgr_.work_submit(mgr_.block_get(3), buf, &forward) == true);
+    }
+    ASSERT(mgr_.block_del(3) == true);
+    ASSERT(mgr_.block_get(3) == nullptr);
+    ASSERT(mgr_.bk_retired_.size() == 1u);
+    for (int i = 0; (i < 1000) && (bk_sink->data_l_.size() != count + 1u); ++i)
+    {
+        mgr_.fd_poll();
+    }
+    ASSERT(bk_sink->data_l_.size() == count + 1u);
+    ASSERT(mgr_.bk_retired_.empty() == true);
+
+    // Replaced block with completions never delivered
+    {
+        struct buffer buf;
+
+        buf.push_back("hello", strlen("hello"));
+        ASSERT(mgr_.work_submit(mgr_.block_get(1), buf, &forward) == true);
+        ASSERT(mgr_.block_replace(1, "block_work") == true);
+        ASSERT(mgr_.bk_retired_.size() == 1u);
+    }
+    mgr_.work_stop();
+    ASSERT(mgr_.bk_retired_.empty() == true);
+
+    mgr_.block_clear();
+    mgr_.block_factory_clear();
+}
+
+static void tu_manager_wk_errors()
+{
+    struct block_work bk_work(&mgr_);
+    struct buffer buf;
+
+    // Submit without workers
+    ASSERT(mgr_.work_submit(&bk_work, buf, nullptr) == false);
+
+    // Start without workers
+    ASSERT(mgr_.work_start(0u) == false);
+
+    // Start twice
+    ASSERT(mgr_.work_start(1u) == true);
+    ASSERT(mgr_.work_start(1u) == false);
+
+    // Submit without block
+    ASSERT(mgr_.work_submit(nullptr, buf, nullptr) == false);
+
+    // Stop with completions pending
+    buf.push_back("dummy", strlen("dummy"));
+    ASSERT(mgr_.work_submit(&bk_work, buf, nullptr) == true);
+    mgr_.work_stop();
+
+    // Stop twice
+    mgr_.work_stop();
+}
+
+int main(int, char **)
+{
+    LOGGER_OPEN("tu_manager_wk");
+
+    tu_manager_wk_offload();
+    tu_manager_wk_replace();
+    tu_manager_wk_errors();
+
+    LOGGER_CLOSE();
+    return 0;
+}
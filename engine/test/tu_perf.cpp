@@ -54,6 +54,57 @@ static void tu_perf_commutation()
     mgr_.block_clear();
 }
 
+//
+// @brief Test the contention on the mailbox
+//
+static void tu_perf_mailbox(size_t nb_thread)
+{
+    size_t nb_post = 100 * 1000;
+    std::vector<std::thread> producers;
+    struct timespec begin;
+    struct timespec end;
+    struct hello *bk;
+
+    ASSERT(mgr_.block_add(1, "hello") == true);
+    bk = static_cast<struct hello *>(mgr_.block_get(1));
+    ASSERT(bk != nullptr);
+
+    ASSERT(mgr_.mailbox_start() == true);
+    mgr_.mb_count_ = 0u;
+    mgr_.mb_wakeup_ = 0u;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (size_t i = 0u; i < nb_thread; ++i)
+    {
+        producers.push_back(std::thread([nb_post] {
+            for (size_t j = 0u; j < nb_post; ++j)
+            {
+                mgr_.post_ctrl(1, nullptr);
+            }
+        }));
+    }
+    while (mgr_.mb_count_ != nb_thread * nb_post)
+    {
+        mgr_.fd_poll();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (auto &it : producers)
+    {
+        it.join();
+    }
+    ASSERT(bk->count_ == static_cast<int>(nb_thread * nb_post));
+
+    printf("mailbox: producers=%zu ; mails=%lu ; wakeups=%lu ; ns_per_mail=%ld\n",
+           nb_thread,
+           mgr_.mb_count_,
+           mgr_.mb_wakeup_,
+           elapsed_ns(begin, end) / static_cast<long>(mgr_.mb_count_));
+
+    mgr_.mailbox_stop();
+    mgr_.block_clear();
+}
+
 int main(int, char **)
 {
     LOGGER_OPEN("tu_perf");
@@ -62,6 +113,9 @@ int main(int, char **)
 
     LOGGER_DISABLE();
     tu_perf_commutation();
+    tu_perf_mailbox(1u);
+    tu_perf_mailbox(4u);
+    tu_perf_mailbox(16u);
     LOGGER_ENABLE();
 
     LOGGER_CLOSE();
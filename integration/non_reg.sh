@@ -6,6 +6,7 @@
 # - test units (TU)
 # - test functions (TF)
 # - coverage
+# - performance, if there is a baseline for this machine class
 #
 
 # No errors or undefined variables allowed
@@ -54,3 +55,16 @@ PYTHONDONTWRITEBYTECODE=1 robot --output NONE --report NONE --log NONE $C3QO_DIR
 #
 echo -e "$COLOR_BLUE\nMake a LCOV report\n$COLOR_NO\n"
 $C3QO_DIR_SOURCE/build.sh -l
+
+#
+# Performance
+#
+echo -e "$COLOR_BLUE\nCompare benchmarks to the baseline\n$COLOR_NO\n"
+BENCH_CLASS=$($C3QO_DIR_SOURCE/bench/bench_compare.py class)
+if [ -f $C3QO_DIR_SOURCE/bench/baseline/$BENCH_CLASS.json ]
+then
+    # Own build directory, not to change the configuration of the others
+    $C3QO_DIR_SOURCE/build.sh -D $C3QO_DIR_BUILD-bench -B Release -Ebk
+else
+    echo "No baseline for this machine class, skipped [class=$BENCH_CLASS]"
+fi
@@ -4,6 +4,9 @@
 // Project headers
 #include "utils/include.hpp"
 
+// C++ headers
+#include <cstdint>
+
 //
 // @struct buffer_part
 //
@@ -20,12 +23,28 @@ struct buffer_part
 //
 // @brief Buffer: a complete message, with several parts
 //
+// A message may carry a deadline, after which nobody waits for it anymore:
+// it is dropped instead of being processed
+//
 struct buffer
 {
     std::vector<struct buffer_part> parts_;
+    uint64_t deadline_ns_; // Monotonic date in nanoseconds, 0 for no deadline
+
+    buffer();
 
     void push_back(const void *data, size_t size);
     void clear();
+    void swap(struct buffer &other);
+
+    void deadline_set(long timeout_us);
+    void deadline_tighten(long timeout_us);
+    bool is_expired(uint64_t now_ns) const;
 };
 
+uint64_t buffer_now_ns();
+uint64_t buffer_mix(uint64_t value);
+uint64_t buffer_hash(const void *data, size_t len);
+uint64_t buffer_hash(const void *data, size_t len, uint64_t seed);
+
 #endif // BUFFER_HPP
@@ -5,6 +5,14 @@
 // Project headers
 #include "utils/buffer.hpp"
 
+// C headers
+extern "C"
+{
+#include <time.h>
+}
+
+buffer::buffer() : deadline_ns_(0u) {}
+
 //
 // Add a part to the buffer
 // A null byte is added but is not counted in the length
@@ -29,4 +37,104 @@ void buffer::clear()
     }
 
     parts_.clear();
+    deadline_ns_ = 0u;
+}
+
+//
+// Exchange the parts and the deadline of two buffers, without copy
+//
+void buffer::swap(struct buffer &other)
+{
+    uint64_t deadline_ns;
+
+    parts_.swap(other.parts_);
+    deadline_ns = deadline_ns_;
+    deadline_ns_ = other.deadline_ns_;
+    other.deadline_ns_ = deadline_ns;
+}
+
+//
+// Set the deadline from now, it may be extended or tightened
+// A timeout of 0 removes the deadline
+//
+void buffer::deadline_set(long timeout_us)
+{
+    deadline_ns_ = (timeout_us > 0) ? buffer_now_ns() + static_cast<uint64_t>(timeout_us) * 1000u : 0u;
+}
+
+//
+// Bring the deadline closer to now, never later than it is
+//
+void buffer::deadline_tighten(long timeout_us)
+{
+    uint64_t deadline_ns;
+
+    if (timeout_us <= 0)
+    {
+        return;
+    }
+
+    deadline_ns = buffer_now_ns() + static_cast<uint64_t>(timeout_us) * 1000u;
+    if ((deadline_ns_ == 0u) || (deadline_ns < deadline_ns_))
+    {
+        deadline_ns_ = deadline_ns;
+    }
+}
+
+bool buffer::is_expired(uint64_t now_ns) const
+{
+    return (deadline_ns_ != 0u) && (deadline_ns_ <= now_ns);
+}
+
+//
+// Monotonic date of the deadlines, in nanoseconds
+//
+uint64_t buffer_now_ns()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000u + static_cast<uint64_t>(now.tv_nsec);
+}
+
+//
+// Scramble the bits of a value: finalizer of splitmix64
+//
+uint64_t buffer_mix(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9u;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebu;
+    value ^= value >> 31;
+
+    return value;
+}
+
+//
+// Hash of a key, such as a part of a buffer: FNV-1a followed by the
+// finalizer of splitmix64, so that every bit of the hash depends on the key
+//
+uint64_t buffer_hash(const void *data, size_t len)
+{
+    return buffer_hash(data, len, 0u);
+}
+
+//
+// Hash of a key, seeded for example with the hash of the previous keys
+//
+uint64_t buffer_hash(const void *data, size_t len, uint64_t seed)
+{
+    const uint8_t *byte = static_cast<const uint8_t *>(data);
+    uint64_t hash;
+
+    hash = 0xcbf29ce484222325u ^ seed;
+    for (size_t i = 0u; i < len; ++i)
+    {
+        hash ^= byte[i];
+        hash *= 0x100000001b3u;
+    }
+
+    return buffer_mix(hash);
 }
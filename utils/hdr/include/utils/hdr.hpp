@@ -0,0 +1,55 @@
+#ifndef HDR_HPP
+#define HDR_HPP
+
+// Project headers
+#include "utils/include.hpp"
+
+//
+// @struct hdr_histogram
+//
+// @brief High dynamic range histogram: values are recorded with a fixed
+//        number of significant digits from the lowest to the highest value
+//
+// Buckets double in size, each one is split into linear sub-buckets, so the
+// memory does not depend on the number of recorded values
+//
+struct hdr_histogram
+{
+    // Configuration
+    long lowest_;  // Lowest value distinguishable from 0
+    long highest_; // Highest value to track
+    int digits_;   // Significant digits, from 1 to 5
+
+    // Layout of the counts
+    int unit_magnitude_;                  // Log2 of the lowest value
+    int sub_bucket_half_count_magnitude_; // Log2 of half the sub-buckets per bucket
+    long sub_bucket_count_;               // Sub-buckets per bucket
+    long sub_bucket_half_count_;          // Half of them: lower half overlaps the previous bucket
+    long sub_bucket_mask_;                // Bits of a value selecting a sub-bucket in the first bucket
+    int bucket_count_;                    // Number of buckets
+    std::vector<unsigned long> counts_;   // Count per sub-bucket
+
+    // Statistics
+    unsigned long total_;    // Number of recorded values
+    unsigned long overflow_; // Number of values above the highest value
+    long min_;
+    long max_;
+    double sum_;
+
+    hdr_histogram();
+
+    bool init(long lowest, long highest, int digits);
+    void reset();
+
+    bool record(long value, unsigned long count = 1u);
+    bool record_corrected(long value, long expected_interval);
+
+    long value_at_percentile(double percentile) const;
+    double mean() const;
+
+    size_t counts_index(long value) const;
+    long value_at_index(size_t index) const;
+    long highest_equivalent(long value) const;
+};
+
+#endif // HDR_HPP
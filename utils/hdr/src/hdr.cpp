@@ -0,0 +1,277 @@
+//
+// @brief High dynamic range histogram, after the HdrHistogram layout
+//
+
+// Project headers
+#include "utils/hdr.hpp"
+#include "utils/logger.hpp"
+
+// C++ headers
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+hdr_histogram::hdr_histogram() : lowest_(1),
+                                 highest_(1),
+                                 digits_(1),
+                                 unit_magnitude_(0),
+                                 sub_bucket_half_count_magnitude_(0),
+                                 sub_bucket_count_(0),
+                                 sub_bucket_half_count_(0),
+                                 sub_bucket_mask_(0),
+                                 bucket_count_(0),
+                                 total_(0u),
+                                 overflow_(0u),
+                                 min_(LONG_MAX),
+                                 max_(0),
+                                 sum_(0.0)
+{
+}
+
+//
+// @brief Log2 of a power of two, or of the power of two just below
+//
+static int hdr_log2(unsigned long value)
+{
+    return 63 - __builtin_clzl(value);
+}
+
+//
+// @brief Allocate the counts
+//
+// @param lowest  : Lowest value distinguishable from 0, at least 1
+// @param highest : Highest value to track, at least twice the lowest
+// @param digits  : Significant digits kept for every value
+//
+bool hdr_histogram::init(long lowest, long highest, int digits)
+{
+    long largest;
+    int sub_bucket_count_magnitude;
+
+    // Verify user input
+    if ((lowest < 1) || (highest < 2 * lowest) || (digits < 1) || (digits > 5))
+    {
+        LOGGER_ERR("Failed to initialize histogram: wrong range [lowest=%ld ; highest=%ld ; digits=%d]",
+                   lowest, highest, digits);
+        return false;
+    }
+
+    lowest_ = lowest;
+    highest_ = highest;
+    digits_ = digits;
+
+    // Sub-buckets resolve the significant digits: 2 * 10^digits values
+    largest = 2 * static_cast<long>(pow(10.0, digits));
+    sub_bucket_count_magnitude = static_cast<int>(ceil(log2(static_cast<double>(largest))));
+
+    unit_magnitude_ = hdr_log2(static_cast<unsigned long>(lowest));
+    sub_bucket_half_count_magnitude_ = sub_bucket_count_magnitude - 1;
+    sub_bucket_count_ = 1l << sub_bucket_count_magnitude;
+    sub_bucket_half_count_ = sub_bucket_count_ / 2;
+    sub_bucket_mask_ = (sub_bucket_count_ - 1) << unit_magnitude_;
+
+    // Buckets double until the highest value is covered
+    bucket_count_ = 1;
+    for (long untrackable = sub_bucket_count_ << unit_magnitude_; untrackable <= highest; untrackable <<= 1)
+    {
+        ++bucket_count_;
+        if (untrackable > LONG_MAX / 2)
+        {
+            break;
+        }
+    }
+
+    counts_.assign(static_cast<size_t>((bucket_count_ + 1) * sub_bucket_half_count_), 0u);
+    reset();
+
+    return true;
+}
+
+//
+// @brief Forget recorded values
+//
+void hdr_histogram::reset()
+{
+    std::fill(counts_.begin(), counts_.end(), 0u);
+    total_ = 0u;
+    overflow_ = 0u;
+    min_ = LONG_MAX;
+    max_ = 0;
+    sum_ = 0.0;
+}
+
+//
+// @brief Index of the sub-bucket counting a value
+//
+size_t hdr_histogram::counts_index(long value) const
+{
+    int pow2ceiling;
+    int bucket;
+    long sub_bucket;
+
+    pow2ceiling = 64 - __builtin_clzl(static_cast<unsigned long>(value | sub_bucket_mask_));
+    bucket = pow2ceiling - unit_magnitude_ - (sub_bucket_half_count_magnitude_ + 1);
+    sub_bucket = value >> (bucket + unit_magnitude_);
+
+    return static_cast<size_t>((static_cast<long>(bucket + 1) << sub_bucket_half_count_magnitude_) +
+                               (sub_bucket - sub_bucket_half_count_));
+}
+
+//
+// @brief Lowest value counted by a sub-bucket
+//
+long hdr_histogram::value_at_index(size_t index) const
+{
+    int bucket;
+    long sub_bucket;
+
+    bucket = static_cast<int>(static_cast<long>(index) >> sub_bucket_half_count_magnitude_) - 1;
+    sub_bucket = (static_cast<long>(index) & (sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+    if (bucket < 0)
+    {
+        sub_bucket -= sub_bucket_half_count_;
+        bucket = 0;
+    }
+
+    return sub_bucket << (bucket + unit_magnitude_);
+}
+
+//
+// @brief Highest value counted in the same sub-bucket as a value
+//
+long hdr_histogram::highest_equivalent(long value) const
+{
+    int pow2ceiling;
+    int bucket;
+    long sub_bucket;
+    long lowest;
+
+    pow2ceiling = 64 - __builtin_clzl(static_cast<unsigned long>(value | sub_bucket_mask_));
+    bucket = pow2ceiling - unit_magnitude_ - (sub_bucket_half_count_magnitude_ + 1);
+    sub_bucket = value >> (bucket + unit_magnitude_);
+    lowest = sub_bucket << (bucket + unit_magnitude_);
+
+    if (sub_bucket >= sub_bucket_count_)
+    {
+        ++bucket;
+    }
+
+    return lowest + (1l << (unit_magnitude_ + bucket)) - 1;
+}
+
+//
+// @brief Record a value
+//
+// @param count : Number of times the value was seen
+//
+bool hdr_histogram::record(long value, unsigned long count)
+{
+    if ((value < 0) || (counts_.empty() == true))
+    {
+        LOGGER_ERR("Failed to record value: out of range [value=%ld]", value);
+        return false;
+    }
+    if (value > highest_)
+    {
+        overflow_ += count;
+        return false;
+    }
+
+    counts_[counts_index(value)] += count;
+    total_ += count;
+    sum_ += static_cast<double>(value) * static_cast<double>(count);
+    if (value < min_)
+    {
+        min_ = value;
+    }
+    if (value > max_)
+    {
+        max_ = value;
+    }
+
+    return true;
+}
+
+//
+// @brief Record a value, corrected for coordinated omission
+//
+// A load generator waiting for a slow answer does not send the requests
+// it should have sent meanwhile: their latencies are missing from the
+// histogram. They are filled in with decreasing values, one per expected
+// interval elapsed during the slow answer.
+//
+// @param expected_interval : Expected interval between two values, 0 to not correct
+//
+bool hdr_histogram::record_corrected(long value, long expected_interval)
+{
+    if (record(value) == false)
+    {
+        return false;
+    }
+    if (expected_interval <= 0)
+    {
+        return true;
+    }
+
+    for (long missing = value - expected_interval; missing >= expected_interval; missing -= expected_interval)
+    {
+        record(missing);
+    }
+
+    return true;
+}
+
+//
+// @brief Value below which a percentage of the recorded values are
+//
+// @param percentile : From 0 to 100
+//
+long hdr_histogram::value_at_percentile(double percentile) const
+{
+    unsigned long rank;
+    unsigned long cumul;
+
+    if (total_ == 0u)
+    {
+        return 0;
+    }
+
+    if (percentile > 100.0)
+    {
+        percentile = 100.0;
+    }
+    rank = static_cast<unsigned long>(percentile / 100.0 * static_cast<double>(total_) + 0.5);
+    if (rank == 0u)
+    {
+        rank = 1u;
+    }
+
+    cumul = 0u;
+    for (size_t i = 0u; i < counts_.size(); ++i)
+    {
+        cumul += counts_[i];
+        if (cumul >= rank)
+        {
+            long value;
+
+            // Do not report beyond the exact maximum
+            value = highest_equivalent(value_at_index(i));
+            return (value < max_) ? value : max_;
+        }
+    }
+
+    return max_;
+}
+
+//
+// @brief Mean of the recorded values
+//
+double hdr_histogram::mean() const
+{
+    if (total_ == 0u)
+    {
+        return 0.0;
+    }
+
+    return sum_ / static_cast<double>(total_);
+}
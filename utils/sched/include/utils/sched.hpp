@@ -0,0 +1,31 @@
+#ifndef SCHED_HPP
+#define SCHED_HPP
+
+// Project headers
+#include "utils/include.hpp"
+
+//
+// @struct sched_conf
+//
+// @brief Scheduling configuration of a thread and of the ZMQ I/O threads
+//
+struct sched_conf
+{
+    std::vector<int> cpu_;    // CPUs to run the thread on, empty to keep the affinity
+    std::vector<int> io_cpu_; // CPUs to run the ZMQ I/O threads on
+    int priority_;            // SCHED_FIFO priority, 0 to keep the default policy
+    bool mlock_;              // Lock current and future memory pages
+
+    sched_conf();
+
+    bool apply(const char *name) const;
+};
+
+bool sched_cpu_parse(const char *list, std::vector<int> &cpu);
+bool sched_affinity(const std::vector<int> &cpu);
+bool sched_priority(int priority);
+bool sched_mlock();
+bool sched_name(const char *name);
+void sched_log();
+
+#endif // SCHED_HPP
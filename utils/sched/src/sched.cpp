@@ -0,0 +1,249 @@
+//
+// @brief API to control the scheduling of threads
+//
+
+// Project headers
+#include "utils/logger.hpp"
+#include "utils/sched.hpp"
+
+// C headers
+extern "C"
+{
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+sched_conf::sched_conf() : priority_(0), mlock_(false) {}
+
+//
+// @brief Apply the configuration to the calling thread
+//
+// @param name : Name to give to the thread, nullptr to keep it
+//
+bool sched_conf::apply(const char *name) const
+{
+    bool is_ok = true;
+
+    if (name != nullptr)
+    {
+        is_ok = sched_name(name) && is_ok;
+    }
+    if (cpu_.empty() == false)
+    {
+        is_ok = sched_affinity(cpu_) && is_ok;
+    }
+    if (priority_ != 0)
+    {
+        is_ok = sched_priority(priority_) && is_ok;
+    }
+    if (mlock_ == true)
+    {
+        is_ok = sched_mlock() && is_ok;
+    }
+
+    sched_log();
+
+    return is_ok;
+}
+
+//
+// @brief Parse a list of CPUs such as "0,2-4"
+//
+bool sched_cpu_parse(const char *list, std::vector<int> &cpu)
+{
+    const char *cur;
+
+    cpu.clear();
+
+    cur = list;
+    while (*cur != '\0')
+    {
+        char *end;
+        long first;
+        long last;
+
+        first = strtol(cur, &end, 10);
+        if ((end == cur) || (first < 0) || (first >= CPU_SETSIZE))
+        {
+            LOGGER_ERR("Failed to parse CPU list: wrong CPU [list=%s]", list);
+            return false;
+        }
+        last = first;
+
+        cur = end;
+        if (*cur == '-')
+        {
+            ++cur;
+            last = strtol(cur, &end, 10);
+            if ((end == cur) || (last < first) || (last >= CPU_SETSIZE))
+            {
+                LOGGER_ERR("Failed to parse CPU list: wrong range [list=%s]", list);
+                return false;
+            }
+            cur = end;
+        }
+
+        for (long i = first; i <= last; ++i)
+        {
+            cpu.push_back(static_cast<int>(i));
+        }
+
+        if (*cur == ',')
+        {
+            ++cur;
+        }
+        else if (*cur != '\0')
+        {
+            LOGGER_ERR("Failed to parse CPU list: unexpected character [list=%s ; char=%c]", list, *cur);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//
+// @brief Pin the calling thread on some CPUs
+//
+bool sched_affinity(const std::vector<int> &cpu)
+{
+    cpu_set_t set;
+    int rc;
+
+    CPU_ZERO(&set);
+    for (int i : cpu)
+    {
+        if ((i < 0) || (i >= CPU_SETSIZE))
+        {
+            LOGGER_ERR("Failed to set CPU affinity: wrong CPU [cpu=%d]", i);
+            return false;
+        }
+        CPU_SET(static_cast<size_t>(i), &set);
+    }
+
+    rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0)
+    {
+        LOGGER_ERR("Failed to set CPU affinity: %s [errno=%d]", strerror(rc), rc);
+        return false;
+    }
+
+    return true;
+}
+
+//
+// @brief Set a real-time SCHED_FIFO priority to the calling thread
+//
+bool sched_priority(int priority)
+{
+    struct sched_param param;
+    int rc;
+
+    param.sched_priority = priority;
+
+    rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (rc != 0)
+    {
+        LOGGER_ERR("Failed to set SCHED_FIFO priority: %s [errno=%d ; priority=%d]", strerror(rc), rc, priority);
+        return false;
+    }
+
+    return true;
+}
+
+//
+// @brief Lock current and future memory pages to avoid page faults
+//
+bool sched_mlock()
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1)
+    {
+        LOGGER_ERR("Failed to lock memory: %s [errno=%d]", strerror(errno), errno);
+        return false;
+    }
+
+    return true;
+}
+
+//
+// @brief Name the calling thread, truncated to the system limit
+//
+bool sched_name(const char *name)
+{
+    char truncated[16];
+    int rc;
+
+    snprintf(truncated, sizeof(truncated), "%s", name);
+
+    rc = pthread_setname_np(pthread_self(), truncated);
+    if (rc != 0)
+    {
+        LOGGER_ERR("Failed to set thread name: %s [errno=%d ; name=%s]", strerror(rc), rc, truncated);
+        return false;
+    }
+
+    return true;
+}
+
+//
+// @brief Read an integer from a sysfs file
+//
+static int sched_sysfs_read(int cpu, const char *file)
+{
+    char path[128];
+    FILE *stream;
+    int value;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, file);
+
+    stream = fopen(path, "r");
+    if (stream == nullptr)
+    {
+        return -1;
+    }
+    if (fscanf(stream, "%d", &value) != 1)
+    {
+        value = -1;
+    }
+    fclose(stream);
+
+    return value;
+}
+
+//
+// @brief Log the effective scheduling of the calling thread
+//
+void sched_log()
+{
+    struct sched_param param;
+    cpu_set_t set;
+    int policy;
+
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0)
+    {
+        LOGGER_INFO("Thread scheduling [cpu_online=%ld ; cpu_current=%d ; policy=%s ; priority=%d]",
+                    sysconf(_SC_NPROCESSORS_ONLN),
+                    sched_getcpu(),
+                    (policy == SCHED_FIFO) ? "SCHED_FIFO" : (policy == SCHED_RR) ? "SCHED_RR" : "SCHED_OTHER",
+                    param.sched_priority);
+    }
+
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        return;
+    }
+    for (int i = 0; i < CPU_SETSIZE; ++i)
+    {
+        if (CPU_ISSET(static_cast<size_t>(i), &set) == 0)
+        {
+            continue;
+        }
+
+        LOGGER_INFO("Thread affinity [cpu=%d ; package=%d ; core=%d]",
+                    i,
+                    sched_sysfs_read(i, "physical_package_id"),
+                    sched_sysfs_read(i, "core_id"));
+    }
+}